@@ -14,18 +14,22 @@ import re
 import json
 import shutil
 import math
+import hashlib
+import heapq
+import itertools
+import threading
+from collections import OrderedDict
 from distutils.dir_util import copy_tree
-from concurrent.futures import ProcessPoolExecutor
 
 env = Environment(loader=FileSystemLoader('templates'))
 
 PATH = os.path.abspath(os.path.dirname(__file__))
 
 
-def future_done_callback(fut):
+def job_done_callback(application_session_id):
     print("\n\n\nDONE\n\n\n\n")
     try:
-        with open(os.path.join(SETTINGS.TMP_FOLDER, fut.application_session_id, 'completed.txt'), 'w') as f:
+        with open(os.path.join(SETTINGS.TMP_FOLDER, application_session_id, 'completed.txt'), 'w') as f:
             f.write(str(time.time()))
     except:
         print("Could not create completed output file")
@@ -37,6 +41,7 @@ class Settings(object):
     OPT_IC_BINARY_DEFAULT_PATH = '/opt/OPT_IC/src/opt_ic'
     CONFIGURATION_DEFAULT_FOLDER = '/opt/OPT_DEADLINE_WS/configurations'
     OPT_DEADLINE_DEFAULT_PATH = '/opt/OPT_DEADLINE'
+    MAX_CONCURRENT_JOBS_DEFAULT = 2
 
     def __init__(self):
         D = {}
@@ -53,6 +58,9 @@ class Settings(object):
             D['CONFIGURATION_FOLDER'] = os.path.abspath(Settings.CONFIGURATION_DEFAULT_FOLDER)
             D['OPT_DEADLINE_PATH'] = os.path.abspath(Settings.OPT_DEADLINE_DEFAULT_PATH)
 
+        # Settings added after the settings file was written
+        D.setdefault('MAX_CONCURRENT_JOBS', Settings.MAX_CONCURRENT_JOBS_DEFAULT)
+
         super().__setattr__('D', D)
 
     def __getattr__(self, attr):
@@ -126,27 +134,155 @@ class ConfigurationHandler(object):
         return {'status' : status, 'message' : message}
 
 class ExecutorService(object):
+    """
+    One queue for all the submitted jobs: at most MAX_CONCURRENT_JOBS (see the
+    settings) run at the same time, the others wait in order of priority
+    (higher first) and then of submission.
+    Identical submissions (same applications and input files, deadline,
+    algorithms and settings) share the run of the first one, unless it has
+    failed or it is older than SHARED_SESSION_SECONDS.
+    """
+    SHARED_SESSION_SECONDS = 24 * 3600
+    MAX_SHARED_SESSIONS = 1000
+
     def __init__(self):
-        self.running_jobs = []
+        self.condition = threading.Condition()
+        self.queue = []  # heap of (-priority, sequence, job)
+        self.sequence = itertools.count()
+        self.num_running_jobs = 0
+        self.sessions_by_key = OrderedDict()  # key -> (session id, time), oldest first
 
+        dispatcher = threading.Thread(target=self._dispatch, daemon=True)
+        dispatcher.start()
 
-    def start_job(self, configuration, algorithms, deadline):
-        ppe = ProcessPoolExecutor(max_workers=1)
-        application_session_id = 'run_' + configuration.configuration_name.replace(' ', '_') + '_' + generate_id()
-        fut = ppe.submit(ExecutorService._start_job, configuration, algorithms, application_session_id, deadline)
-        fut.application_session_id = application_session_id
+    @staticmethod
+    def max_concurrent_jobs():
+        try:
+            return max(1, int(SETTINGS.MAX_CONCURRENT_JOBS))
+        except ValueError:
+            return Settings.MAX_CONCURRENT_JOBS_DEFAULT
 
-        fut.add_done_callback(future_done_callback)
-        ppe.shutdown(wait=False)
+    @staticmethod
+    def file_identity(path):
+        try:
+            stat = os.stat(path)
+            return [path, stat.st_size, stat.st_mtime_ns]
+        except OSError:
+            return [path, None, None]
 
     @staticmethod
-    def _start_job(configuration, algorithms, application_session_id, deadline):
+    def job_key(configuration, algorithms, deadline):
+        # The input files and the binaries are identified by size and
+        # modification time: an upload which replaces them (or a new build)
+        # makes the submission different
+        files = []
+        for app in configuration.applications:
+            for filename in app[:-1]:
+                files.append(ExecutorService.file_identity(os.path.join(SETTINGS.APP_FILES_FOLDER, filename)))
+
+        settings = [os.path.abspath(SETTINGS.APP_FILES_FOLDER), os.path.abspath(SETTINGS.DAGSIM_PATH),
+                    ExecutorService.file_identity(os.path.abspath(SETTINGS.OPT_IC_BINARY_PATH)),
+                    ExecutorService.file_identity(os.path.join(os.path.abspath(SETTINGS.OPT_DEADLINE_PATH), 'opt_deadline'))]
+
+        content = json.dumps([configuration.applications, files, settings, sorted(k for k, v in algorithms.items() if v), str(deadline)])
+        return hashlib.sha1(content.encode('utf-8')).hexdigest()
+
+    def _find_shared_session(self, key):
+        """ The run of an identical submission, if it can be shared (call with the lock) """
+        now = time.time()
+        while len(self.sessions_by_key) > 0:
+            oldest_key, (_, submission_time) = next(iter(self.sessions_by_key.items()))
+            if now - submission_time <= ExecutorService.SHARED_SESSION_SECONDS:
+                break
+            del self.sessions_by_key[oldest_key]
+
+        application_session_id, _ = self.sessions_by_key.get(key, (None, None))
+        if application_session_id is None or not os.path.exists(os.path.join(SETTINGS.TMP_FOLDER, application_session_id)):
+            return None
+        return application_session_id
+
+    def _forget_session(self, application_session_id):
+        """ A failed run is not shared (call with the lock) """
+        for key, (session_id, _) in list(self.sessions_by_key.items()):
+            if session_id == application_session_id:
+                del self.sessions_by_key[key]
+
+    def start_job(self, configuration, algorithms, deadline, priority=0):
+        """
+        Queue the job. Return its session id and if it is shared with an
+        identical submission.
+        """
+        key = ExecutorService.job_key(configuration, algorithms, deadline)
+
+        with self.condition:
+            application_session_id = self._find_shared_session(key)
+            if application_session_id is not None:
+                print("Identical submission: sharing {}".format(application_session_id))
+                return application_session_id, True
+
+            application_session_id = 'run_' + configuration.configuration_name.replace(' ', '_') + '_' + generate_id()
+            ExecutorService._prepare_job(configuration, application_session_id, deadline)
+            self.sessions_by_key.pop(key, None)
+            self.sessions_by_key[key] = (application_session_id, time.time())
+            while len(self.sessions_by_key) > ExecutorService.MAX_SHARED_SESSIONS:
+                self.sessions_by_key.popitem(last=False)
+
+            job = (configuration, algorithms, application_session_id, deadline)
+            heapq.heappush(self.queue, (-priority, next(self.sequence), job))
+            self.condition.notify_all()
+
+        return application_session_id, False
+
+    def wake_up(self):
+        """ The concurrency limit could have been changed """
+        with self.condition:
+            self.condition.notify_all()
+
+    def _dispatch(self):
+        while True:
+            with self.condition:
+                while len(self.queue) == 0 or self.num_running_jobs >= ExecutorService.max_concurrent_jobs():
+                    self.condition.wait()
+                _, _, job = heapq.heappop(self.queue)
+                self.num_running_jobs += 1
+
+            threading.Thread(target=self._run_job, args=job, daemon=True).start()
+
+    def _run_job(self, configuration, algorithms, application_session_id, deadline):
+        succeeded = False
+        try:
+            succeeded = ExecutorService._start_job(configuration, algorithms, application_session_id, deadline)
+        except Exception as e:
+            print("Exception found in job {}: {}".format(application_session_id, e))
+        finally:
+            job_done_callback(application_session_id)
+            with self.condition:
+                if not succeeded:
+                    self._forget_session(application_session_id)
+                self.num_running_jobs -= 1
+                self.condition.notify_all()
+
+    @staticmethod
+    def _prepare_job(configuration, application_session_id, deadline):
         path = os.path.join(SETTINGS.TMP_FOLDER, application_session_id)
         # create folder
         os.mkdir(path)
         os.mkdir(os.path.join(path, 'tmp'))
         os.mkdir(os.path.join(path, 'output'))
 
+        with open(os.path.join(path, 'queued.txt'), 'w') as f:
+            f.write(str(time.time()))
+
+        with open(os.path.join(path, 'deadline.txt'), 'w') as f:
+            f.write(str(deadline))
+
+        configuration.save(os.path.join(path, 'process.txt'))
+
+    @staticmethod
+    def _start_job(configuration, algorithms, application_session_id, deadline):
+        """ Return False if any run of opt_deadline has failed (or it has been killed) """
+        path = os.path.join(SETTINGS.TMP_FOLDER, application_session_id)
+
         process_path = os.path.join(path, 'process.txt')
         config_path = os.path.join(path, 'config.txt')
         output_path = os.path.join(path, 'output')
@@ -154,11 +290,6 @@ class ExecutorService(object):
         with open(os.path.join(path, 'started.txt'), 'w') as f:
             f.write(str(time.time()))
 
-        with open(os.path.join(path, 'deadline.txt'), 'w') as f:
-            f.write(str(deadline))
-
-        configuration.save(process_path)
-
         with open(config_path, 'w') as f:
             f.write(os.path.abspath(SETTINGS.APP_FILES_FOLDER) + '\n')
             f.write(os.path.abspath(SETTINGS.DAGSIM_PATH) + '\n')
@@ -174,15 +305,18 @@ class ExecutorService(object):
             stdout_file = open(os.path.join(output_path, 'algorithm' + algorithm_format + '_out.txt'), 'w')
             stderr_file = open(os.path.join(output_path, 'algorithm' + algorithm_format + '_err.txt'), 'w')
 
-            subprocess.run(args, stdout=stdout_file, stderr=stderr_file, cwd=output_path)
+            completed = subprocess.run(args, stdout=stdout_file, stderr=stderr_file, cwd=output_path)
 
             stdout_file.close()
             stderr_file.close()
+            return completed.returncode == 0
 
+        succeeded = True
         if algorithms['algorithm1'] == True:
-            run_application_algorithm('-1')
+            succeeded = run_application_algorithm('-1') and succeeded
         if algorithms['algorithm2'] == True:
-            run_application_algorithm('-2')
+            succeeded = run_application_algorithm('-2') and succeeded
+        return succeeded
 
 
 
@@ -262,7 +396,10 @@ class ApplicationStatus(object):
                     self.n_cores = ['0']*len(self.configuration.applications)
 
             else:
-                self.status = 'RUNNING'
+                if os.path.exists(os.path.join(SETTINGS.TMP_FOLDER, application_session_id, 'started.txt')):
+                    self.status = 'RUNNING'
+                else:
+                    self.status = 'QUEUED'
                 self.computed_deadline = '-'
                 self.completed_time = '-'
                 self.completed_time_format = '-'
@@ -371,6 +508,7 @@ class OPT_DEADLINE_WS(object):
             SETTINGS.__setattr__(k, v)
 
         SETTINGS.save()
+        executor_service.wake_up()
 
         return {'status':200, 'message': "settings updated"}
 
@@ -483,11 +621,17 @@ class OPT_DEADLINE_WS(object):
         configuration_name = configuration_json['configuration_name'].strip()
         algorithms = configuration_json['algorithms']
         deadline = configuration_json['deadline']
+        try:
+            priority = int(configuration_json.get('priority', 0))
+        except (TypeError, ValueError, OverflowError):
+            raise cherrypy.HTTPError(400, 'The priority must be an integer')
 
         configuration = Configuration.load(configuration_name)
-        executor_service.start_job(configuration, algorithms, deadline)
+        application_session_id, shared = executor_service.start_job(configuration, algorithms, deadline, priority)
 
-        return 'Job submitted'
+        if shared:
+            return 'Identical job already submitted: sharing the results of {}'.format(application_session_id)
+        return 'Job submitted ({})'.format(application_session_id)
 
 
 
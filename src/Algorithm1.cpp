@@ -18,19 +18,28 @@ limitations under the License.
 #include "Algorithm1.hpp"
 #include "FineGrain.hpp"
 #include "InitialSolution_SA.hpp"
+#include "InitialSolution_WarmStart.hpp"
+#include "Tracer.hpp"
 
-bool Algorithm1::process(const Configuration& configuration, Process* process,
+bool Algorithm1::process(const Configuration& configuration,
+                         const SolverOptions& options, Process* process,
                          std::ostream* log, std::ostream* result_log) {
+  Tracer::ScopedSpan trace_span("Algorithm1", "algorithm");
   try {
-    // Initialization deadlines (first algorithm initialization)
-    InitialSolution_SA initial_deadline_solution;
-    initial_deadline_solution.process(process, log);
+    // Initialization deadlines from a previous solution, if any
+    if (InitialSolution_WarmStart::initialize(options, process, log,
+                                              result_log) == false) {
+      // Initialization deadlines (first algorithm initialization)
+      InitialSolution_SA initial_deadline_solution;
+      initial_deadline_solution.process(process, log);
 
-    // Dump with initial solution
-    process->dump_process(result_log, "Input Solution SA");
+      // Dump with initial solution
+      process->dump_process(result_log, "Input Solution SA");
+    }
 
     // Fine Grain
-    FineGrain fine_grain_algorithm(configuration);
+    FineGrain fine_grain_algorithm(configuration,
+                                   options.for_algorithm("Algorithm1"));
     fine_grain_algorithm.process(process, log, result_log);
   } catch (const std::exception& err) {
     *log << err.what() << '\n';
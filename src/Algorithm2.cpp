@@ -18,24 +18,34 @@ limitations under the License.
 #include "CoarseGrain.hpp"
 #include "FineGrain.hpp"
 #include "InitialSolution_FA.hpp"
+#include "InitialSolution_WarmStart.hpp"
+#include "Tracer.hpp"
 
-bool Algorithm2::process(const Configuration& configuration, Process* process,
+bool Algorithm2::process(const Configuration& configuration,
+                         const SolverOptions& options, Process* process,
                          std::ostream* log, std::ostream* result_log) {
+  Tracer::ScopedSpan trace_span("Algorithm2", "algorithm");
   try {
-    // Initialization deadlines (second algorithm initialization)
-    InitialSolution_FA initial_deadline_solution;
-    initial_deadline_solution.process(process, log);
-
-    // Dump with initial solution
-    process->dump_process(result_log, "Input Solution FA");
+    // Initialization deadlines from a previous solution, if any
+    if (InitialSolution_WarmStart::initialize(options, process, log,
+                                              result_log) == false) {
+      // Initialization deadlines (second algorithm initialization)
+      InitialSolution_FA initial_deadline_solution(
+          options.m_critical_path_estimators);
+      initial_deadline_solution.process(process, log);
+
+      // Dump with initial solution
+      process->dump_process(result_log, "Input Solution FA");
+    }
 
     // Coarse Grain
-    CoarseGrain coarse_grain_algorithm;
+    CoarseGrain coarse_grain_algorithm(options);
     coarse_grain_algorithm.process(process, log, result_log);
     process->dump_process(result_log, "Coarse grain solution");
 
     // Fine Grain
-    FineGrain fine_grain_algorithm(configuration);
+    FineGrain fine_grain_algorithm(configuration,
+                                   options.for_algorithm("Algorithm2"));
     fine_grain_algorithm.process(process, log, result_log);
   } catch (const std::exception& err) {
     *log << err.what() << '\n';
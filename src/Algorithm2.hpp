@@ -19,13 +19,14 @@ limitations under the License.
 
 #include <ostream>
 #include "Process.hpp"
+#include "SolverOptions.hpp"
 
 class Algorithm2 {
  public:
   using Configuration = opt_common::Configuration;
 
-  bool process(const Configuration& configuration, Process* process,
-               std::ostream* log, std::ostream* result_log);
+  bool process(const Configuration& configuration, const SolverOptions& options,
+               Process* process, std::ostream* log, std::ostream* result_log);
 };
 
 #endif  // __OPT_DEADLINE__ALGORITHM_2__HPP
@@ -0,0 +1,56 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "Algorithm3.hpp"
+#include "FineGrain.hpp"
+#include "InitialSolution_FA.hpp"
+#include "InitialSolution_WarmStart.hpp"
+#include "MultiStartSearch.hpp"
+#include "Tracer.hpp"
+
+bool Algorithm3::process(const Configuration& configuration,
+                         const SolverOptions& options, Process* process,
+                         std::ostream* log, std::ostream* result_log) {
+  Tracer::ScopedSpan trace_span("Algorithm3", "algorithm");
+  try {
+    // Initialization deadlines from a previous solution, if any
+    if (InitialSolution_WarmStart::initialize(options, process, log,
+                                              result_log) == false) {
+      // Initialization deadlines (as the second algorithm)
+      InitialSolution_FA initial_deadline_solution(
+          options.m_critical_path_estimators);
+      initial_deadline_solution.process(process, log);
+
+      // Dump with initial solution
+      process->dump_process(result_log, "Input Solution FA");
+    }
+
+    // Multi-start local search
+    MultiStartSearch local_search_algorithm(options);
+    local_search_algorithm.process(process, log, result_log);
+    process->dump_process(result_log, "Local search solution");
+
+    // Fine Grain
+    FineGrain fine_grain_algorithm(configuration,
+                                   options.for_algorithm("Algorithm3"));
+    fine_grain_algorithm.process(process, log, result_log);
+  } catch (const std::exception& err) {
+    *log << err.what() << '\n';
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,38 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__ALLOCATION__HPP
+#define __OPT_DEADLINE__ALLOCATION__HPP
+
+#include <opt_common/helper.hpp>
+#include <vector>
+
+//! The state of an application decided by the solvers
+struct ApplicationAllocation {
+  opt_common::TimeInstant m_deadline = 0;
+  unsigned m_number_of_core = 0;
+  //! Execution time simulated by dagSim with m_number_of_core (zero if
+  //! unknown)
+  opt_common::TimeInstant m_execution_time = 0;
+};
+
+//! The allocation of a process: an element for each application, in the
+//! order of the process. It is small and it can be copied to explore some
+//! candidate allocations, while the profiles of the applications are shared.
+using Allocation = std::vector<ApplicationAllocation>;
+
+#endif  // __OPT_DEADLINE__ALLOCATION__HPP
@@ -0,0 +1,36 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "ApplicationProfile.hpp"
+
+ApplicationProfile::ApplicationProfile(Application application)
+    : m_application_id(application.get_application_id()),
+      m_files_resources(application.get_files_resources()),
+      m_lua_name(application.get_lua_name()),
+      m_machine_learning_model(application.get_machine_learning_model()),
+      m_infrastructure_config(application.get_infrastructure_config()),
+      m_max_number_of_tasks(application.compute_max_number_of_task()) {
+  const auto& stages = application.get_all_stages();
+  m_stage_avg_times.reserve(stages.size());
+  for (const auto& pair_stage : stages) {
+    m_stage_avg_times.push_back(pair_stage.second.get_avg_time());
+  }
+
+  // The execution time depends on the number of cores of the application
+  application.set_number_of_core(m_max_number_of_tasks);
+  m_min_execution_time = application.compute_avg_execution_time();
+}
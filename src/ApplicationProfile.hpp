@@ -0,0 +1,92 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__APPLICATION_PROFILE__HPP
+#define __OPT_DEADLINE__APPLICATION_PROFILE__HPP
+
+#include <opt_common/Application.hpp>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*! Compact profile of an application: only the data read by the solvers.
+  The records parsed from the logs (jobs, stages and tasks) are aggregated
+  when the profile is created and then dropped, so the memory of a process
+  grows with the number of applications and not with the size of the logs.
+  A profile is immutable: the processes share it, while the weight and the
+  allocation (deadline and cores) belong to each process.
+ */
+class ApplicationProfile {
+ public:
+  using Application = opt_common::Application;
+  using TimeInstant = opt_common::TimeInstant;
+  using FileResources = Application::FileResources;
+  using MachineLearningModel = std::decay_t<decltype(
+      std::declval<Application>().get_machine_learning_model())>;
+  using InfrastructureConfig = std::decay_t<decltype(
+      std::declval<Application>().get_infrastructure_config())>;
+
+  //! Aggregate the application (its records are not kept)
+  explicit ApplicationProfile(Application application);
+
+  const std::string& get_application_id() const noexcept {
+    return m_application_id;
+  }
+
+  const FileResources& get_files_resources() const noexcept {
+    return m_files_resources;
+  }
+
+  const std::string& get_lua_name() const noexcept { return m_lua_name; }
+
+  const MachineLearningModel& get_machine_learning_model() const noexcept {
+    return m_machine_learning_model;
+  }
+
+  const InfrastructureConfig& get_infrastructure_config() const noexcept {
+    return m_infrastructure_config;
+  }
+
+  //! \return the average execution time of each stage
+  const std::vector<TimeInstant>& get_stage_avg_times() const noexcept {
+    return m_stage_avg_times;
+  }
+
+  //! \return the maximum number of tasks of a stage
+  unsigned get_max_number_of_tasks() const noexcept {
+    return m_max_number_of_tasks;
+  }
+
+  //! \return the average execution time with a core for each task (i.e.
+  //! with 'get_max_number_of_tasks()' cores)
+  TimeInstant get_min_execution_time() const noexcept {
+    return m_min_execution_time;
+  }
+
+ private:
+  std::string m_application_id;
+  FileResources m_files_resources;
+  std::string m_lua_name;
+  MachineLearningModel m_machine_learning_model;
+  InfrastructureConfig m_infrastructure_config;
+  std::vector<TimeInstant> m_stage_avg_times;
+  unsigned m_max_number_of_tasks;
+  TimeInstant m_min_execution_time;
+};
+
+#endif  // __OPT_DEADLINE__APPLICATION_PROFILE__HPP
@@ -0,0 +1,200 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "ApplicationRegistry.hpp"
+#include <opt_common/helper.hpp>
+#include <sys/stat.h>
+#include "Statistics.hpp"
+
+namespace {
+
+//! An evaluation which shares the output of a running one
+class SharedEvaluation : public PendingCommand {
+ public:
+  SharedEvaluation(
+      ApplicationRegistry* registry, ApplicationRegistry::Request request,
+      std::shared_ptr<ApplicationRegistry::RunningEvaluation> evaluation)
+      : m_registry(registry),
+        m_request(std::move(request)),
+        m_evaluation(std::move(evaluation)) {}
+
+  std::string wait() override {
+    std::lock_guard<std::mutex> lock(m_evaluation->m_mutex);
+    if (m_evaluation->m_completed == false) {
+      if (!m_evaluation->m_command) {
+        THROW_RUNTIME_ERROR("The launch of a shared evaluation has failed");
+      }
+      m_evaluation->m_output = m_evaluation->m_command->wait();
+      m_evaluation->m_completed = true;
+      m_registry->add_evaluation(m_request, m_evaluation->m_output);
+    }
+    return m_evaluation->m_output;
+  }
+
+  //! The evaluation is stopped only if nobody else is waiting for it
+  void cancel() noexcept override {
+    if (m_evaluation.use_count() == 1 && m_evaluation->m_command) {
+      m_evaluation->m_command->cancel();
+    }
+  }
+
+ private:
+  ApplicationRegistry* m_registry;
+  ApplicationRegistry::Request m_request;
+  std::shared_ptr<ApplicationRegistry::RunningEvaluation> m_evaluation;
+};
+
+//! An evaluation already resolved
+class ResolvedEvaluation : public PendingCommand {
+ public:
+  explicit ResolvedEvaluation(std::string output)
+      : m_output(std::move(output)) {}
+
+  std::string wait() override { return m_output; }
+
+  void cancel() noexcept override {}
+
+ private:
+  std::string m_output;
+};
+
+//! \return the device, the inode, the size and the modification time of
+//! the file (its name if it does not exist)
+std::string file_identity(const std::string& filename) {
+  struct stat file_status;
+  if (stat(filename.c_str(), &file_status) != 0) {
+    return filename;
+  }
+  return std::to_string(file_status.st_dev) + ':' +
+         std::to_string(file_status.st_ino) + ':' +
+         std::to_string(file_status.st_size) + ':' +
+         std::to_string(file_status.st_mtime);
+}
+
+//! \return the name of the file with its identity (if the name can be
+//! opened as it is)
+std::string named_file_identity(const std::string& filename) {
+  const std::string identity = file_identity(filename);
+  return identity == filename ? filename : filename + '@' + identity;
+}
+
+}  // namespace
+
+std::shared_ptr<const ApplicationProfile> ApplicationRegistry::get_profile(
+    const FileResources& resources, const std::string& config_filename) {
+  const auto key = make_application_key(resources, config_filename);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_profiles.find(key);
+    if (it != m_profiles.cend()) {
+      Statistics::instance().increment(
+          Statistics::Counter::APPLICATION_REGISTRY_HITS);
+      return it->second;
+    }
+  }
+
+  // The parsing of the logs is not serialized
+  auto profile = create_profile(opt_common::Application::create_application(
+      resources, config_filename, "0"));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_profiles.emplace(key, std::move(profile)).first->second;
+}
+
+std::shared_ptr<const ApplicationProfile> ApplicationRegistry::create_profile(
+    opt_common::Application application) {
+  application.set_alpha_beta(15, 10);
+  return std::make_shared<const ApplicationProfile>(std::move(application));
+}
+
+std::string ApplicationRegistry::evaluate(
+    const Request& request, const std::function<std::string()>& run) {
+  return launch(request, [&run]() {
+           return std::unique_ptr<PendingCommand>(
+               new ResolvedEvaluation(run()));
+         })->wait();
+}
+
+std::unique_ptr<PendingCommand> ApplicationRegistry::launch(
+    const Request& request,
+    const std::function<std::unique_ptr<PendingCommand>()>& launch) {
+  const Key key = make_key(request);
+  std::shared_ptr<RunningEvaluation> evaluation;
+  std::unique_lock<std::mutex> evaluation_lock;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto resolved = m_evaluations.find(key);
+    if (resolved != m_evaluations.cend()) {
+      Statistics::instance().increment(
+          Statistics::Counter::SHARED_EVALUATION_HITS);
+      return std::unique_ptr<PendingCommand>(
+          new ResolvedEvaluation(resolved->second));
+    }
+
+    auto& running = m_running_evaluations[key];
+    evaluation = running.lock();
+    if (evaluation) {
+      Statistics::instance().increment(
+          Statistics::Counter::SHARED_EVALUATION_HITS);
+      return std::unique_ptr<PendingCommand>(
+          new SharedEvaluation(this, request, std::move(evaluation)));
+    }
+    evaluation = std::make_shared<RunningEvaluation>();
+    running = evaluation;
+
+    // Until the command is launched, the identical evaluations wait on the
+    // mutex of the evaluation
+    evaluation_lock = std::unique_lock<std::mutex>(evaluation->m_mutex);
+  }
+
+  evaluation->m_command = launch();
+  evaluation_lock.unlock();
+  return std::unique_ptr<PendingCommand>(
+      new SharedEvaluation(this, request, std::move(evaluation)));
+}
+
+bool ApplicationRegistry::find_evaluation(const Request& request,
+                                          std::string* output) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_evaluations.find(make_key(request));
+  if (it == m_evaluations.cend()) {
+    return false;
+  }
+  Statistics::instance().increment(
+      Statistics::Counter::SHARED_EVALUATION_HITS);
+  *output = it->second;
+  return true;
+}
+
+void ApplicationRegistry::add_evaluation(const Request& request,
+                                         const std::string& output) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const Key key = make_key(request);
+  m_evaluations.emplace(key, output);
+  m_running_evaluations.erase(key);
+}
+
+std::vector<std::string> ApplicationRegistry::make_application_key(
+    const FileResources& resources, const std::string& config_filename) {
+  return {named_file_identity(resources.m_Application_File),
+          named_file_identity(resources.m_Jobs_File),
+          named_file_identity(resources.m_Stages_File),
+          named_file_identity(resources.m_Tasks_File),
+          named_file_identity(resources.m_Lua_File),
+          named_file_identity(resources.m_Infrastructure_File),
+          file_identity(config_filename)};
+}
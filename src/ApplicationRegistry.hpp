@@ -0,0 +1,102 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__APPLICATION_REGISTRY__HPP
+#define __OPT_DEADLINE__APPLICATION_REGISTRY__HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ApplicationProfile.hpp"
+#include "EvaluationTrace.hpp"
+#include "PendingCommand.hpp"
+
+/*! The applications and the external evaluations of a run, shared by all
+  its processes.
+  Each application is parsed at its first request; the following requests
+  of the same files with the same configuration file (the same file on disk,
+  whatever the path used to name it) share its profile, unless the size or
+  the modification time of a file has changed in the meantime.
+  The evaluations are identified as in the evaluation trace (type and hash
+  of the rendered input): an evaluation identical to a resolved one (or to
+  one still running) is not launched again. The registry is thread safe.
+ */
+class ApplicationRegistry {
+ public:
+  using FileResources = ApplicationProfile::FileResources;
+  using Request = EvaluationTrace::Request;
+
+  //! \return the profile of the application described by the files
+  std::shared_ptr<const ApplicationProfile> get_profile(
+      const FileResources& resources, const std::string& config_filename);
+
+  //! \return the profile of a parsed application (its records are dropped)
+  static std::shared_ptr<const ApplicationProfile> create_profile(
+      opt_common::Application application);
+
+  //! Run the evaluation with 'run', unless an identical one has been already
+  //! resolved (or it is running)
+  //! \return its output
+  std::string evaluate(const Request& request,
+                       const std::function<std::string()>& run);
+
+  //! Launch the evaluation with 'launch', unless an identical one has been
+  //! already resolved (or it is running)
+  std::unique_ptr<PendingCommand> launch(
+      const Request& request,
+      const std::function<std::unique_ptr<PendingCommand>()>& launch);
+
+  //! \return 'true' (and its output) if the evaluation has been resolved
+  bool find_evaluation(const Request& request, std::string* output) const;
+
+  void add_evaluation(const Request& request, const std::string& output);
+
+  //! An evaluation launched and not yet waited
+  struct RunningEvaluation {
+    std::mutex m_mutex;
+    std::unique_ptr<PendingCommand> m_command;
+    bool m_completed = false;
+    std::string m_output;
+  };
+
+ private:
+  using Key = std::pair<int, std::uint64_t>;
+
+  mutable std::mutex m_mutex;
+  std::map<std::vector<std::string>,
+           std::shared_ptr<const ApplicationProfile>>
+      m_profiles;
+  std::map<Key, std::string> m_evaluations;
+  std::map<Key, std::weak_ptr<RunningEvaluation>> m_running_evaluations;
+
+  static Key make_key(const Request& request) {
+    return {static_cast<int>(request.m_type), request.m_input_hash};
+  }
+
+  //! \return the identity of the files of the application (the names of
+  //! the files are relative to the paths of the configuration file: they
+  //! are identified by their name, and by their size and modification time
+  //! if they can be found from the working directory)
+  static std::vector<std::string> make_application_key(
+      const FileResources& resources, const std::string& config_filename);
+};
+
+#endif  // __OPT_DEADLINE__APPLICATION_REGISTRY__HPP
@@ -0,0 +1,196 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Checkpoint.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+
+namespace {
+
+template <typename T>
+void write_vector(std::ostream* out, const char* key,
+                  const std::vector<T>& values) {
+  *out << key << ' ' << values.size();
+  for (const auto& value : values) {
+    *out << ' ' << value;
+  }
+  *out << '\n';
+}
+
+template <typename T>
+void read_vector(std::istream* in, const char* key, std::vector<T>* values) {
+  std::string read_key;
+  std::size_t size = 0;
+  *in >> read_key >> size;
+  if (read_key != key) {
+    THROW_RUNTIME_ERROR("Checkpoint: expected '" + std::string(key) +
+                        "' but found '" + read_key + "'");
+  }
+  values->resize(size);
+  for (auto& value : *values) {
+    *in >> value;
+  }
+}
+
+template <typename T>
+void read_value(std::istream* in, const char* key, T* value) {
+  std::string read_key;
+  *in >> read_key >> *value;
+  if (read_key != key) {
+    THROW_RUNTIME_ERROR("Checkpoint: expected '" + std::string(key) +
+                        "' but found '" + read_key + "'");
+  }
+}
+
+}  // anonymous namespace
+
+void FineGrainState::store_allocation(const Process& process) {
+  const auto number_of_applications = process.get_number_applications();
+  m_application_ids.resize(number_of_applications);
+  m_deadlines.resize(number_of_applications);
+  m_cores.resize(number_of_applications);
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    const auto& application = process.get_application_from_index(i);
+    m_application_ids[i] = application.get_application_id();
+    m_deadlines[i] = application.get_deadline();
+    m_cores[i] = application.get_number_of_core();
+  }
+}
+
+void FineGrainState::restore_allocation(Process* process) const {
+  const auto number_of_applications = process->get_number_applications();
+  if (m_application_ids.size() != number_of_applications) {
+    THROW_RUNTIME_ERROR(
+        "Checkpoint: the number of applications does not match the process");
+  }
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    auto& application = process->get_application_from_index_mod(i);
+    if (application.get_application_id() != m_application_ids[i]) {
+      THROW_RUNTIME_ERROR("Checkpoint: application '" + m_application_ids[i] +
+                          "' does not match the application '" +
+                          application.get_application_id() +
+                          "' of the process");
+    }
+    application.set_deadline(m_deadlines[i]);
+    application.set_number_of_core(m_cores[i]);
+  }
+}
+
+void Checkpoint::save(const std::string& filename,
+                      const FineGrainState& state) {
+  const std::string temp_filename = filename + ".tmp";
+
+  std::ofstream file(temp_filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open checkpoint file '" + temp_filename + "'");
+  }
+  file.precision(std::numeric_limits<double>::max_digits10);
+
+  file << HEADER << ' ' << VERSION << '\n';
+  file << "algorithm "
+       << (state.m_algorithm.empty() ? NO_ALGORITHM : state.m_algorithm)
+       << '\n';
+  file << "total_deadline " << state.m_total_deadline << '\n';
+  write_vector(&file, "application_ids", state.m_application_ids);
+  write_vector(&file, "deadlines", state.m_deadlines);
+  write_vector(&file, "cores", state.m_cores);
+  write_vector(&file, "coresFromOptIC_perApp", state.m_coresFromOptIC_perApp);
+  write_vector(&file, "residualTime_perApp", state.m_residualTime_perApp);
+  file << "total_residual_time " << state.m_total_residual_time << '\n';
+  write_vector(&file, "apps_to_remove",
+               std::vector<FineGrainState::IndexApplication>(
+                   state.m_apps_to_remove.cbegin(),
+                   state.m_apps_to_remove.cend()));
+  file << "iteration_index " << state.m_iteration_index << '\n';
+  file << "initialization_completed " << state.m_initialization_completed
+       << '\n';
+  file << "next_app_index " << state.m_next_app_index << '\n';
+  file << "pending_num_cores " << state.m_pending_num_cores << '\n';
+  file << "best " << state.m_best << '\n';
+  file << "best_new_n_cores " << state.m_best_new_n_cores << '\n';
+  file << "best_index " << state.m_best_index << '\n';
+  write_vector(&file, "candidate_indexes", state.m_candidate_indexes);
+  write_vector(&file, "candidate_new_n_cores", state.m_candidate_new_n_cores);
+  file.close();
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot write checkpoint file '" + temp_filename +
+                        "'");
+  }
+
+  // Flush the content on the disk before the rename
+  const int fd = open(temp_filename.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+
+  if (std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    THROW_RUNTIME_ERROR("Cannot rename checkpoint file '" + temp_filename +
+                        "' into '" + filename + "'");
+  }
+}
+
+FineGrainState Checkpoint::load(const std::string& filename) {
+  std::ifstream file(filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open checkpoint file '" + filename + "'");
+  }
+
+  std::string header;
+  unsigned version = 0;
+  file >> header >> version;
+  if (header != HEADER || version != VERSION) {
+    THROW_RUNTIME_ERROR("The file '" + filename +
+                        "' is not a valid FineGrain checkpoint");
+  }
+
+  FineGrainState state;
+  std::vector<FineGrainState::IndexApplication> apps_to_remove;
+  read_value(&file, "algorithm", &state.m_algorithm);
+  if (state.m_algorithm == NO_ALGORITHM) {
+    state.m_algorithm.clear();
+  }
+  read_value(&file, "total_deadline", &state.m_total_deadline);
+  read_vector(&file, "application_ids", &state.m_application_ids);
+  read_vector(&file, "deadlines", &state.m_deadlines);
+  read_vector(&file, "cores", &state.m_cores);
+  read_vector(&file, "coresFromOptIC_perApp", &state.m_coresFromOptIC_perApp);
+  read_vector(&file, "residualTime_perApp", &state.m_residualTime_perApp);
+  read_value(&file, "total_residual_time", &state.m_total_residual_time);
+  read_vector(&file, "apps_to_remove", &apps_to_remove);
+  read_value(&file, "iteration_index", &state.m_iteration_index);
+  read_value(&file, "initialization_completed",
+             &state.m_initialization_completed);
+  read_value(&file, "next_app_index", &state.m_next_app_index);
+  read_value(&file, "pending_num_cores", &state.m_pending_num_cores);
+  read_value(&file, "best", &state.m_best);
+  read_value(&file, "best_new_n_cores", &state.m_best_new_n_cores);
+  read_value(&file, "best_index", &state.m_best_index);
+  read_vector(&file, "candidate_indexes", &state.m_candidate_indexes);
+  read_vector(&file, "candidate_new_n_cores", &state.m_candidate_new_n_cores);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("The checkpoint file '" + filename +
+                        "' is bad-formed");
+  }
+  state.m_apps_to_remove.insert(apps_to_remove.cbegin(),
+                                apps_to_remove.cend());
+
+  return state;
+}
@@ -0,0 +1,88 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__CHECKPOINT__HPP
+#define __OPT_DEADLINE__CHECKPOINT__HPP
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+#include "Process.hpp"
+
+//! The complete state of a FineGrain run. It is enough to continue the
+//! algorithm without repeating any OPT_IC or dagSim invocation.
+struct FineGrainState {
+  using TimeInstant = opt_common::TimeInstant;
+  using IndexApplication = std::size_t;
+
+  // The algorithm which runs FineGrain and the total deadline of the
+  // process: the state is resumed only by the same ones
+  std::string m_algorithm;
+  TimeInstant m_total_deadline = 0;
+
+  // Allocation of each application of the process
+  std::vector<std::string> m_application_ids;
+  std::vector<TimeInstant> m_deadlines;
+  std::vector<unsigned> m_cores;
+
+  std::vector<int> m_coresFromOptIC_perApp;
+  std::vector<int> m_residualTime_perApp;
+  TimeInstant m_total_residual_time = 0;
+  std::set<IndexApplication> m_apps_to_remove;
+  unsigned m_iteration_index = 0;
+
+  // Progress of the current loop over the applications (during the
+  // iterations it is the position in the scan order of FineGrain)
+  bool m_initialization_completed = false;
+  IndexApplication m_next_app_index = 0;
+  int m_pending_num_cores = -1;  // OPT_IC result waiting for dagSim (init)
+
+  // Best candidate of the current iteration
+  double m_best = 0;
+  int m_best_new_n_cores = 0;
+  IndexApplication m_best_index = 0;
+
+  // All the candidates (improving applications) of the current iteration
+  std::vector<IndexApplication> m_candidate_indexes;
+  std::vector<int> m_candidate_new_n_cores;
+
+  //! Copy the allocation (deadlines and cores) from the process
+  void store_allocation(const Process& process);
+
+  //! Apply the allocation (deadlines and cores) on the process
+  void restore_allocation(Process* process) const;
+};
+
+class Checkpoint {
+ public:
+  /*! Write the state into the file atomically: the state is written in a
+    temporary file which is then renamed over 'filename'.
+   */
+  static void save(const std::string& filename, const FineGrainState& state);
+
+  //! Read the state from the file. It throws if the file is bad-formed
+  static FineGrainState load(const std::string& filename);
+
+ private:
+  static constexpr const char* HEADER = "OPT_DEADLINE_FINEGRAIN_CHECKPOINT";
+  static constexpr unsigned VERSION = 3;
+
+  //! Written in place of an empty algorithm
+  static constexpr const char* NO_ALGORITHM = "-";
+};
+
+#endif  // __OPT_DEADLINE__CHECKPOINT__HPP
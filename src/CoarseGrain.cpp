@@ -15,23 +15,24 @@ limitations under the License.
 */
 
 #include "CoarseGrain.hpp"
+#include <algorithm>
+#include <numeric>
 #include <utility>
 #include <vector>
+#include "Statistics.hpp"
+#include "Tracer.hpp"
 
-double CoarseGrain::compute_number_of_cores_from_deadline(
+template <typename PerformanceModel>
+double
+BasicCoarseGrain<PerformanceModel>::compute_number_of_cores_from_deadline(
     const Application& app, const TimeInstant& deadline) {
-  // Get ML model parameters
-  const auto& mlm = app.get_machine_learning_model();
-  const double chi_0 = mlm.get_chi_0();
-  const double chi_c = mlm.get_chi_c();
-
-  // Compute number of cores with formula:
-  //   n_cores = (deadline - chi_0) / chi_c
-  return chi_c / (static_cast<double>(deadline) - chi_0);
+  return PerformanceModel::number_of_cores(app.get_machine_learning_model(),
+                                           static_cast<double>(deadline));
 }
 
-double CoarseGrain::objective_function(const AppNCore& app1,
-                                       const AppNCore& app2) {
+template <typename PerformanceModel>
+double BasicCoarseGrain<PerformanceModel>::objective_function(
+    const AppNCore& app1, const AppNCore& app2) {
   const Application& app1_ref = *app1.first;
   const Application& app2_ref = *app2.first;
   const unsigned& num_cores_app1 = app1.second;
@@ -43,15 +44,37 @@ double CoarseGrain::objective_function(const AppNCore& app1,
   return cost_app1 + cost_app2;
 }
 
-double CoarseGrain::initialize_delta_deadline(const Process& process) {
+template <typename PerformanceModel>
+double BasicCoarseGrain<PerformanceModel>::initialize_delta_deadline(
+    const Process& process) {
   // TOT_Deadline / number_app_in_process
   return process.get_total_deadline() / process.get_number_applications();
 }
 
-bool CoarseGrain::shift_deadline(Application* app_reduce,
-                                 Application* app_increment,
-                                 const double delta_deadline,
-                                 PossibleDeadlineShift* out_solution) {
+template <typename PerformanceModel>
+void BasicCoarseGrain<PerformanceModel>::compute_number_of_cores(
+    const Application& app, double deadline, double new_deadline,
+    unsigned* num_cores, unsigned* new_num_cores) const {
+  double cores = 0.0;
+  double new_cores = 0.0;
+  if (m_options.m_response_tables &&
+      m_options.m_response_tables->lookup_cores(app.get_profile(), deadline,
+                                                &cores) &&
+      m_options.m_response_tables->lookup_cores(app.get_profile(),
+                                                new_deadline, &new_cores)) {
+    *num_cores = cores;
+    *new_num_cores = new_cores;
+    return;
+  }
+
+  *num_cores = compute_number_of_cores_from_deadline(app, deadline);
+  *new_num_cores = compute_number_of_cores_from_deadline(app, new_deadline);
+}
+
+template <typename PerformanceModel>
+bool BasicCoarseGrain<PerformanceModel>::shift_deadline(
+    Application* app_reduce, Application* app_increment,
+    const double delta_deadline, PossibleDeadlineShift* out_solution) const {
   // Set some preliminary information in the output
   out_solution->m_delta_deadline = delta_deadline;
   out_solution->m_app_reduce = app_reduce;
@@ -61,27 +84,23 @@ bool CoarseGrain::shift_deadline(Application* app_reduce,
   const auto deadline_appI = app_reduce->get_deadline();
   const auto deadline_appJ = app_increment->get_deadline();
 
-  // Get the number of cores in accordance with those deadlines
-  const unsigned ncoresI =
-      compute_number_of_cores_from_deadline(*app_reduce, deadline_appI);
-  const unsigned ncoresJ =
-      compute_number_of_cores_from_deadline(*app_increment, deadline_appJ);
+  // Compute the new deadine: subtract from appI and increment appJ
+  const double deadline_appI_new = deadline_appI - delta_deadline;
+  const double deadline_appJ_new = deadline_appJ + delta_deadline;
+
+  // Get the number of cores in accordance with those deadlines (current and
+  // new ones)
+  unsigned ncoresI, ncoresI_new, ncoresJ, ncoresJ_new;
+  compute_number_of_cores(*app_reduce, deadline_appI, deadline_appI_new,
+                          &ncoresI, &ncoresI_new);
+  compute_number_of_cores(*app_increment, deadline_appJ, deadline_appJ_new,
+                          &ncoresJ, &ncoresJ_new);
 
   // Check feasible solution
   if (ncoresI == 0 || ncoresJ == 0) {
     return false;
   }
 
-  // Compute the new deadine: subtract from appI and increment appJ
-  const double deadline_appI_new = deadline_appI - delta_deadline;
-  const double deadline_appJ_new = deadline_appJ + delta_deadline;
-
-  // Compute the new number of cores with new deadlines
-  const unsigned ncoresI_new =
-      compute_number_of_cores_from_deadline(*app_reduce, deadline_appI_new);
-  const unsigned ncoresJ_new =
-      compute_number_of_cores_from_deadline(*app_increment, deadline_appJ_new);
-
   // Compute difference in number of cores
   const int ncores_delta_I = ncoresI_new - ncoresI;
   const int ncores_delta_J = ncoresJ_new - ncoresJ;
@@ -103,20 +122,123 @@ bool CoarseGrain::shift_deadline(Application* app_reduce,
   return true;
 }
 
-void CoarseGrain::process(Process* process, std::ostream* log,
-                          std::ostream* result_log) {
-  *log << "CourseGrain::process > Starting process\n";
+template <typename PerformanceModel>
+std::vector<unsigned> BasicCoarseGrain<PerformanceModel>::compute_visit_order(
+    const Process& process) const {
+  std::vector<unsigned> visit_order(process.get_number_applications());
+  std::iota(visit_order.begin(), visit_order.end(), 0);
+
+  if (m_options.m_stop_condition->has_time_budget()) {
+    std::stable_sort(visit_order.begin(), visit_order.end(),
+                     [&process](unsigned i, unsigned j) {
+                       const auto& appI = process.get_application_from_index(i);
+                       const auto& appJ = process.get_application_from_index(j);
+                       return appI.get_weight() * appI.get_number_of_core() >
+                              appJ.get_weight() * appJ.get_number_of_core();
+                     });
+  }
 
-  // Get number of applications
-  const auto num_of_apps = process->get_number_applications();
+  return visit_order;
+}
+
+template <typename PerformanceModel>
+void BasicCoarseGrain<PerformanceModel>::process(Process* process,
+                                                std::ostream* log,
+                                                std::ostream* result_log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::COARSE_GRAIN);
+  Tracer::ScopedSpan trace_span("CoarseGrain", "phase");
+  *log << "CourseGrain::process > Starting process\n";
 
-  if (num_of_apps == 0) {
+  if (process->get_number_applications() == 0) {
     THROW_RUNTIME_ERROR("CoarseGrain: no applications to process");
   }
 
+  shift_deadlines(process, nullptr, 0.0, log, result_log);
+
+  *log << "CourseGrain::process > End process\n";
+}
+
+template <typename PerformanceModel>
+void BasicCoarseGrain<PerformanceModel>::rebalance(
+    Process* process, double slack, std::vector<bool> involved,
+    std::ostream* log, std::ostream* result_log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::STREAM_REBALANCE);
+  Tracer::ScopedSpan trace_span("CoarseGrainRebalance", "phase");
+  *log << "CourseGrain::rebalance > Starting rebalance (slack: " << slack
+       << ")\n";
+
+  if (process->get_number_applications() == 0) {
+    *log << "CourseGrain::rebalance > No applications\n";
+    return;
+  }
+
+  distribute_slack(process, slack, &involved, log);
+  shift_deadlines(process, &involved, MIN_DELTA_DEADLINE, log, result_log);
+
+  *log << "CourseGrain::rebalance > End rebalance\n";
+}
+
+template <typename PerformanceModel>
+void BasicCoarseGrain<PerformanceModel>::distribute_slack(
+    Process* process, double slack, std::vector<bool>* involved,
+    std::ostream* log) const {
+  const double quantum = slack / SLACK_QUANTA;
+  if (quantum == 0.0) {
+    return;
+  }
+
+  for (unsigned k = 0; k < SLACK_QUANTA; ++k) {
+    // The application whose cost changes the least with the quantum
+    Application* best_app = nullptr;
+    unsigned best_index = 0;
+    unsigned best_new_num_cores = 0;
+    double best_delta_cost = 0.0;
+    for (unsigned i = 0; i < process->get_number_applications(); ++i) {
+      Application& app = process->get_application_from_index_mod(i);
+      const double new_deadline = app.get_deadline() + quantum;
+      if (compute_number_of_cores_from_deadline(app, new_deadline) <= 0.0) {
+        continue;  // Deadline not reachable
+      }
+
+      unsigned num_cores, new_num_cores;
+      compute_number_of_cores(app, app.get_deadline(), new_deadline,
+                              &num_cores, &new_num_cores);
+      const double delta_cost =
+          app.get_weight() * (static_cast<double>(new_num_cores) - num_cores);
+      if (best_app == nullptr || delta_cost < best_delta_cost) {
+        best_app = &app;
+        best_index = i;
+        best_new_num_cores = new_num_cores;
+        best_delta_cost = delta_cost;
+      }
+    }
+
+    if (best_app == nullptr) {
+      *log << "\t> No application can give the remaining slack: "
+           << quantum * (SLACK_QUANTA - k) << '\n';
+      return;
+    }
+
+    best_app->set_deadline(best_app->get_deadline() + quantum);
+    best_app->set_number_of_core(best_new_num_cores);
+    (*involved)[best_index] = true;
+  }
+}
+
+template <typename PerformanceModel>
+void BasicCoarseGrain<PerformanceModel>::shift_deadlines(
+    Process* process, const std::vector<bool>* involved,
+    double min_delta_deadline, std::ostream* log, std::ostream* result_log) {
+  // Get number of applications
+  const auto num_of_apps = process->get_number_applications();
+
   // Initialize deadline
   double delta_deadline = initialize_delta_deadline(*process);
 
+  // Lower bound of the objective function (continuous relaxation)
+  const double lower_bound = process->compute_objective_lower_bound();
+  *log << "\t> Lower Bound: " << lower_bound << "\n";
+
   // Local vector of possible solution
   std::vector<PossibleDeadlineShift> possible_solutions;
 
@@ -130,18 +252,33 @@ void CoarseGrain::process(Process* process, std::ostream* log,
   // magari deltamin     ???? 10 secondi
 
   unsigned iteration_index = 0;
-  while (stop_criteria(iteration_index) == false) {
+  while (stop_criteria(iteration_index) == false &&
+         delta_deadline >= min_delta_deadline) {
+    Tracer::ScopedSpan iteration_span("CoarseGrainIteration", "iteration");
+    iteration_span.add_argument("iteration", iteration_index);
+    iteration_span.add_argument("delta_deadline", delta_deadline);
+
     *log << "\t> Iteration number: " << iteration_index << "\n";
     *log << "\t> DeltaDeadline: " << delta_deadline << "\n";
 
     // Clean the possible solutions
     possible_solutions.clear();
 
+    // Number of pairs evaluated in this iteration (statistics)
+    std::uint64_t num_pair_evaluations = 0;
+
     // For each pair of Apps   ---  O(N^2)
-    for (unsigned i = 0; i < num_of_apps; ++i) {
+    // (stop in the middle of the iteration only if requested)
+    const auto visit_order = compute_visit_order(*process);
+    for (unsigned index_visit = 0;
+         index_visit < num_of_apps &&
+         m_options.m_stop_condition->stop_requested() == false;
+         ++index_visit) {
+      const unsigned i = visit_order[index_visit];
       for (unsigned j = 0; j < num_of_apps; ++j) {
-        // Not reflexive!
-        if (i != j) {
+        // Not reflexive! (and at least an involved application)
+        if (i != j &&
+            (involved == nullptr || (*involved)[i] || (*involved)[j])) {
           *log << "\t\t> Considering Application Pair (" << i << ", " << j
                << ")\n";
 
@@ -160,6 +297,8 @@ void CoarseGrain::process(Process* process, std::ostream* log,
           *log << "\t\t\t> Evaluation before deadline movements: "
                << evaluation_before << "\n";
 
+          ++num_pair_evaluations;
+
           // Shift deadline (reduce appI and increment appJ)
           // The function return true if solution is feasible (no negative
           // delta)
@@ -182,6 +321,12 @@ void CoarseGrain::process(Process* process, std::ostream* log,
       }    // for all app j
     }      // for all app i
 
+    Statistics::instance().increment(
+        Statistics::Counter::COARSE_GRAIN_PAIR_EVALUATIONS,
+        num_pair_evaluations);
+    Statistics::instance().increment(
+        Statistics::Counter::COARSE_GRAIN_ITERATIONS);
+
     // If no better solution found then split deadline
     if (possible_solutions.empty()) {
       *log << "\t\t> No better solution. Decreasing DeltaDeadline\n";
@@ -219,12 +364,27 @@ void CoarseGrain::process(Process* process, std::ostream* log,
       *log << "\t> [Current Result] Iteration Index: " << iteration_index
            << "; Global Objective Function: "
            << process->compute_global_objective_function() << "; CoarseGrain\n";
+      const double gap = process->compute_relative_gap(lower_bound);
+      *log << "\t> Lower Bound: " << lower_bound << "; Gap: " << 100.0 * gap
+           << "%\n";
+      if (gap < 0.0) {
+        *log << "\t> The objective function is below the lower bound: the "
+                "bound does not hold\n";
+      }
 
       process->dump_process(result_log, "CoarseGrain");
+      m_options.report_progress(*process, "CoarseGrain");
+
+      if (m_options.gap_closed(gap)) {
+        *log << "\t> Gap within the threshold. Stopping\n";
+        break;
+      }
     }
 
     ++iteration_index;
   }
-
-  *log << "CourseGrain::process > End process\n";
 }
+
+// The models available to the solvers
+template class BasicCoarseGrain<HyperbolicModel>;
+template class BasicCoarseGrain<LogOverheadModel<>>;
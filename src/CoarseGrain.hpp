@@ -18,18 +18,44 @@ limitations under the License.
 #define __OPT_DEADLINE__COARSE_GRAIN__HPP
 
 #include <ostream>
+#include <vector>
+#include "PerformanceModel.hpp"
 #include "Process.hpp"
+#include "SolverOptions.hpp"
 
-class CoarseGrain {
+//! Shifts the deadlines among the pairs of applications, estimating their
+//! cores with 'PerformanceModel' (the models of PerformanceModel.hpp are
+//! instantiated in CoarseGrain.cpp)
+template <typename PerformanceModel>
+class BasicCoarseGrain {
  public:
   using TimeInstant = opt_common::TimeInstant;
-  using Application = opt_common::Application;
+  using Application = Process::Application;
   using AppNCore = std::pair<const Application*, unsigned>;
 
+  explicit BasicCoarseGrain(const SolverOptions& options)
+      : m_options(options) {}
+
   void process(Process* process, std::ostream* log, std::ostream* result_log);
 
+  /*! Incremental version for a process which has been changed.
+    The 'slack' of deadline (positive or negative) is given to (taken from)
+    the applications whose cost changes the least, one quantum at a time;
+    then only the pairs of applications with at least an involved one (those
+    in 'involved' and those whose deadline has been changed) are rebalanced.
+    \param [in] involved  A flag for each application of the process
+   */
+  void rebalance(Process* process, double slack, std::vector<bool> involved,
+                 std::ostream* log, std::ostream* result_log);
+
  private:
   static constexpr unsigned MAX_NUMBER_OF_ITERATION = 1000;
+  static constexpr unsigned SLACK_QUANTA = 16;
+
+  //! The incremental rebalance stops when the delta deadline is smaller
+  static constexpr double MIN_DELTA_DEADLINE = 1.0;
+
+  SolverOptions m_options;
 
   //! A possible solution in shifting the deadline among a couple of application
   struct PossibleDeadlineShift {
@@ -50,30 +76,59 @@ class CoarseGrain {
   //! they
   static double objective_function(const AppNCore& app1, const AppNCore& app2);
 
-  //! Applying formula, return the number of cores (in double) for an
-  //! application,
-  //! given the deadline
+  //! Applying the performance model, return the number of cores (in double)
+  //! for an application, given the deadline
   static double compute_number_of_cores_from_deadline(
       const Application& app, const TimeInstant& deadline);
 
+  //! Number of cores of the application for the current and the new
+  //! deadline: from the response table if it answers both (within its error
+  //! tolerance), otherwise from the ML model
+  void compute_number_of_cores(const Application& app, double deadline,
+                               double new_deadline, unsigned* num_cores,
+                               unsigned* new_num_cores) const;
+
   //! \return 'true' if the iterative algorithm should be stopped
   inline bool stop_criteria(unsigned num_tot_iteration) const;
 
+  /*! Shift the deadlines among the pairs of applications until the stop
+    criteria (or until the delta deadline is below 'min_delta_deadline').
+    \param [in] involved  If not null, only the pairs with at least an
+                          involved application are considered
+   */
+  void shift_deadlines(Process* process, const std::vector<bool>* involved,
+                       double min_delta_deadline, std::ostream* log,
+                       std::ostream* result_log);
+
+  //! Give (take) the slack of deadline to (from) the applications, marking
+  //! the ones which have been changed as involved
+  void distribute_slack(Process* process, double slack,
+                        std::vector<bool>* involved, std::ostream* log) const;
+
+  //! \return the order in which the applications are considered for reducing
+  //! their deadline. With a time budget the most expensive applications come
+  //! first, otherwise the order of the process is kept.
+  std::vector<unsigned> compute_visit_order(const Process& process) const;
+
   //! Reduce deadline for app_reduce and increment deadline for app_increment
   //! The amount of deadline reduces is in delta_deadline
   //! \param [in] app_reduce     The app to reduce deadline
   //! \param [in] app_increment  The app to increase deadline
   //! \param [in] delta_deadline The amount of increment/reduction
   //! \param [out] out_solution  The output of solution in shifting
-  static bool shift_deadline(Application* app_reduce,
-                             Application* app_increment,
-                             const double delta_deadline,
-                             PossibleDeadlineShift* out_solution);
+  bool shift_deadline(Application* app_reduce, Application* app_increment,
+                      const double delta_deadline,
+                      PossibleDeadlineShift* out_solution) const;
 };
 
-inline bool CoarseGrain::stop_criteria(unsigned num_tot_iteration) const {
+template <typename PerformanceModel>
+inline bool BasicCoarseGrain<PerformanceModel>::stop_criteria(
+    unsigned num_tot_iteration) const {
   // TODO(biagio): maybe you want to specify a better stop criteria
-  return num_tot_iteration > MAX_NUMBER_OF_ITERATION;
+  return num_tot_iteration > MAX_NUMBER_OF_ITERATION ||
+         m_options.m_stop_condition->stop_requested();
 }
 
+using CoarseGrain = BasicCoarseGrain<DefaultPerformanceModel>;
+
 #endif  // __OPT_DEADLINE__COARSE_GRAIN__HPP
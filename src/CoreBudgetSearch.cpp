@@ -0,0 +1,171 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "CoreBudgetSearch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+bool CoreBudgetSearch::process(const SolveFunction& solve, Process* process,
+                               std::ostream* log,
+                               std::ostream* result_log) const {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::CORE_BUDGET_SEARCH);
+  Tracer::ScopedSpan trace_span("CoreBudgetSearch", "phase");
+  *log << "CoreBudgetSearch::process > Starting process\n";
+
+  if (process->get_number_applications() == 0) {
+    THROW_RUNTIME_ERROR("CoreBudgetSearch: no applications to process");
+  }
+
+  // No allocation meets a deadline shorter than a core for each task
+  Process shortest_process = *process;
+  const TimeInstant shortest_deadline = shortest_process.compute_min_deadline();
+
+  // The lower bound of the ML models gives only the first probe
+  const TimeInstant estimated_deadline =
+      std::max(compute_estimated_deadline(*process), shortest_deadline + 1);
+  *log << "\t> Core budget: " << m_core_budget
+       << "; Estimated deadline: " << estimated_deadline
+       << "; Shortest deadline (a core for each task): " << shortest_deadline
+       << '\n';
+
+  // Every deadline up to 'infeasible_deadline' exceeds the budget (or
+  // cannot be met), while 'feasible_deadline' is the shortest one found
+  // within the budget
+  TimeInstant infeasible_deadline = shortest_deadline;
+  TimeInstant feasible_deadline = estimated_deadline;
+  Process best_process = *process;
+  const Process* warm_start = nullptr;
+  unsigned probe_index = 0;
+  bool found = false;
+  if (m_options.m_stop_condition->stop_requested() == false &&
+      probe(solve, *process, estimated_deadline, warm_start, probe_index++,
+            &best_process, log, result_log)) {
+    found = true;
+  } else {
+    infeasible_deadline = estimated_deadline;
+    feasible_deadline =
+        std::max(process->get_total_deadline(), 2 * estimated_deadline);
+  }
+
+  // Expansion: double the deadline until it is within the budget
+  for (unsigned expansion = 0; found == false && expansion <= MAX_EXPANSIONS;
+       ++expansion) {
+    if (m_options.m_stop_condition->stop_requested()) {
+      break;
+    }
+    if (probe(solve, *process, feasible_deadline, warm_start, probe_index++,
+              &best_process, log, result_log)) {
+      found = true;
+    } else {
+      infeasible_deadline = feasible_deadline;
+      feasible_deadline *= 2;
+    }
+  }
+  if (found == false) {
+    *log << "\t> No deadline within the core budget has been found\n";
+    return false;
+  }
+  warm_start = &best_process;
+
+  // Bisection between the two deadlines
+  Process solved_process = *process;
+  for (unsigned bisection = 0; bisection < MAX_BISECTION_PROBES;
+       ++bisection) {
+    const double tolerance =
+        std::max(1.0, DEADLINE_TOLERANCE * feasible_deadline);
+    if (feasible_deadline - infeasible_deadline <= tolerance ||
+        m_options.m_stop_condition->stop_requested()) {
+      break;
+    }
+    const TimeInstant deadline =
+        infeasible_deadline + (feasible_deadline - infeasible_deadline) / 2;
+    if (probe(solve, *process, deadline, warm_start, probe_index++,
+              &solved_process, log, result_log)) {
+      feasible_deadline = deadline;
+      best_process = solved_process;
+    } else {
+      infeasible_deadline = deadline;
+    }
+  }
+
+  *process = best_process;
+  *log << "\t> Shortest deadline: " << feasible_deadline
+       << "; Objective Function: "
+       << process->compute_global_objective_function() << "; Probes: "
+       << probe_index << '\n';
+  process->dump_process(result_log,
+                        "Shortest deadline for the core budget " +
+                            std::to_string(m_core_budget));
+  *log << "CoreBudgetSearch::process > Process completed\n";
+  return true;
+}
+
+auto CoreBudgetSearch::compute_estimated_deadline(
+    const Process& process) const -> TimeInstant {
+  // The lower bound S^2 / (D - sum(chi_0)) - sum(w) of the objective
+  // function is within the budget only from sum(chi_0) + S^2 / (B + sum(w))
+  double sum_chi_0 = 0.0;
+  double sum_sqrt = 0.0;
+  double sum_weights = 0.0;
+  for (unsigned index_app = 0; index_app < process.get_number_applications();
+       ++index_app) {
+    const auto& application = process.get_application_from_index(index_app);
+    const auto& mlm = application.get_machine_learning_model();
+    sum_chi_0 += mlm.get_chi_0();
+    sum_sqrt += std::sqrt(application.get_weight() * mlm.get_chi_c());
+    sum_weights += application.get_weight();
+  }
+  return static_cast<TimeInstant>(
+      sum_chi_0 + sum_sqrt * sum_sqrt / (m_core_budget + sum_weights));
+}
+
+bool CoreBudgetSearch::probe(const SolveFunction& solve,
+                             const Process& process,
+                             TimeInstant total_deadline,
+                             const Process* warm_start,
+                             unsigned probe_index, Process* solved_process,
+                             std::ostream* log,
+                             std::ostream* result_log) const {
+  Tracer::ScopedSpan probe_span("CoreBudgetProbe", "probe");
+  Statistics::instance().increment(Statistics::Counter::CORE_BUDGET_PROBES);
+
+  *solved_process = process;
+  solved_process->set_total_deadline(total_deadline);
+  SolverOptions options = m_options;
+  if (warm_start != nullptr) {
+    options.m_warm_start_allocation = warm_start->get_allocation();
+    options.m_warm_start_total_deadline = warm_start->get_total_deadline();
+  }
+
+  if (solve(options, solved_process, log, result_log) == false) {
+    THROW_RUNTIME_ERROR("CoreBudgetSearch: the algorithms have failed on "
+                        "probe " +
+                        std::to_string(probe_index) + " (deadline " +
+                        std::to_string(total_deadline) + ")");
+  }
+  const double objective_function =
+      solved_process->compute_global_objective_function();
+  const bool feasible = objective_function <= m_core_budget;
+  *log << "[Core Budget] Probe " << probe_index
+       << ": deadline: " << total_deadline
+       << "; objective: " << objective_function
+       << "; feasible: " << (feasible ? "yes" : "no") << '\n';
+  return feasible;
+}
@@ -0,0 +1,89 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__CORE_BUDGET_SEARCH__HPP
+#define __OPT_DEADLINE__CORE_BUDGET_SEARCH__HPP
+
+#include <functional>
+#include <ostream>
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+
+/*! Dual mode: the shortest total deadline of the process whose allocation
+  does not cost more than a weighted core budget.
+  Each probe solves the process with a total deadline (with the selected
+  algorithms) and it is feasible if its objective function is within the
+  budget. The first probe is the deadline from which the lower bound of the
+  ML models is within the budget. It is only an estimate (the evaluated
+  cost can be below the bound): if it is feasible, the shorter deadlines are
+  searched down to the one of a core for each task; otherwise the total
+  deadline of the process is probed, and doubled until it is feasible.
+  Then the deadline is bisected, assuming that the cost does not increase
+  with the deadline. Each probe starts from the allocation of the shortest
+  feasible deadline found so far (scaled to its deadline), and the probes
+  share the evaluations through the application registry. A failure of the
+  algorithms is an error (it is not taken as an infeasible deadline).
+ */
+class CoreBudgetSearch {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+
+  //! Solver of a process with the given options; 'false' on failure
+  using SolveFunction =
+      std::function<bool(const SolverOptions& options, Process* process,
+                         std::ostream* log, std::ostream* result_log)>;
+
+  CoreBudgetSearch(const SolverOptions& options, double core_budget)
+      : m_options(options), m_core_budget(core_budget) {}
+
+  /*! Search the shortest total deadline. On success the process has that
+    total deadline and its allocation.
+    \return 'false' if no feasible deadline has been found
+   */
+  bool process(const SolveFunction& solve, Process* process,
+               std::ostream* log, std::ostream* result_log) const;
+
+ private:
+  //! The bisection stops when the interval is smaller (relative to the
+  //! shortest feasible deadline)
+  static constexpr double DEADLINE_TOLERANCE = 0.005;
+
+  //! Maximum number of times the first deadline is doubled
+  static constexpr unsigned MAX_EXPANSIONS = 16;
+
+  //! Maximum number of probes of the bisection
+  static constexpr unsigned MAX_BISECTION_PROBES = 24;
+
+  SolverOptions m_options;
+  double m_core_budget;
+
+  //! \return the total deadline from which the lower bound of the
+  //! objective function (with the ML models) is within the budget
+  TimeInstant compute_estimated_deadline(const Process& process) const;
+
+  /*! Solve a copy of the process with 'total_deadline' (warm started from
+    the allocation of 'warm_start', if not null). It throws if the
+    algorithms fail.
+    \return 'true' if it is solved within the budget
+   */
+  bool probe(const SolveFunction& solve, const Process& process,
+             TimeInstant total_deadline, const Process* warm_start,
+             unsigned probe_index, Process* solved_process,
+             std::ostream* log, std::ostream* result_log) const;
+};
+
+#endif  // __OPT_DEADLINE__CORE_BUDGET_SEARCH__HPP
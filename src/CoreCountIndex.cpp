@@ -0,0 +1,59 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "CoreCountIndex.hpp"
+#include <iterator>
+
+void CoreCountIndex::add(const std::string& application_id,
+                         TimeInstant deadline, int num_cores) {
+  m_answers[application_id][deadline] = num_cores;
+}
+
+auto CoreCountIndex::get_bounds(const std::string& application_id,
+                                TimeInstant deadline) const -> Bounds {
+  Bounds bounds{0, -1};
+  const auto answers = m_answers.find(application_id);
+  if (answers == m_answers.cend()) {
+    return bounds;
+  }
+
+  // The nearest known deadline not smaller gives the lower bound
+  const auto next = answers->second.lower_bound(deadline);
+  if (next != answers->second.cend()) {
+    bounds.m_lower = next->second;
+    if (next->first == deadline) {
+      bounds.m_upper = next->second;
+      return bounds;
+    }
+  }
+
+  // The nearest known smaller deadline gives the upper bound
+  if (next != answers->second.cbegin()) {
+    bounds.m_upper = std::prev(next)->second;
+  }
+  return bounds;
+}
+
+bool CoreCountIndex::lookup(const std::string& application_id,
+                            TimeInstant deadline, int* num_cores) const {
+  const auto bounds = get_bounds(application_id, deadline);
+  if (bounds.m_upper < 0 || bounds.m_lower != bounds.m_upper) {
+    return false;
+  }
+  *num_cores = bounds.m_lower;
+  return true;
+}
@@ -0,0 +1,57 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__CORE_COUNT_INDEX__HPP
+#define __OPT_DEADLINE__CORE_COUNT_INDEX__HPP
+
+#include <opt_common/Application.hpp>
+#include <map>
+#include <string>
+
+/*! Ordered index of the OPT_IC answers (deadline -> number of cores) of each
+  application. The number of cores never increases with the deadline, so:
+    - a deadline between two known deadlines with the same answer has that
+      answer too (bracketed query);
+    - otherwise the answers of the nearest known deadlines bound it.
+ */
+class CoreCountIndex {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+
+  //! Bounds of the number of cores for a deadline (m_upper is negative if
+  //! there is no known smaller deadline)
+  struct Bounds {
+    int m_lower;
+    int m_upper;
+  };
+
+  //! Record the answer of OPT_IC for the application with 'deadline'
+  void add(const std::string& application_id, TimeInstant deadline,
+           int num_cores);
+
+  Bounds get_bounds(const std::string& application_id,
+                    TimeInstant deadline) const;
+
+  //! \return 'true' if the number of cores is implied by the known answers
+  bool lookup(const std::string& application_id, TimeInstant deadline,
+              int* num_cores) const;
+
+ private:
+  std::map<std::string, std::map<TimeInstant, int>> m_answers;
+};
+
+#endif  // __OPT_DEADLINE__CORE_COUNT_INDEX__HPP
@@ -0,0 +1,307 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "CriticalPathEstimator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <regex>
+#include "Process.hpp"
+
+CriticalPathEstimator CriticalPathEstimator::from_lua_file(
+    const std::string& lua_filename) {
+  std::ifstream lua_file(lua_filename);
+  if (lua_file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open the LUA file '" + lua_filename + "'");
+  }
+  const std::string lua_content((std::istreambuf_iterator<char>(lua_file)),
+                                std::istreambuf_iterator<char>());
+
+  // Expected: 'Stages = {{ name="S1", tasks="2", distr={...}, pre={...},
+  // post={...}}, ...};'
+  const auto stages_begin = lua_content.find('{', lua_content.find("Stages"));
+  if (lua_content.find("Stages") == std::string::npos ||
+      stages_begin == std::string::npos) {
+    THROW_RUNTIME_ERROR("Cannot find the array 'Stages' into the LUA file '" +
+                        lua_filename + "'");
+  }
+
+  // The stages are the blocks at depth 2
+  std::vector<Stage> stages;
+  std::vector<std::vector<std::string>> predecessor_names;
+  unsigned depth = 0;
+  std::size_t stage_begin = 0;
+  for (std::size_t i = stages_begin; i < lua_content.size(); ++i) {
+    if (lua_content[i] == '{') {
+      if (++depth == 2) {
+        stage_begin = i;
+      }
+    } else if (lua_content[i] == '}') {
+      if (depth == 2) {
+        predecessor_names.emplace_back();
+        stages.push_back(parse_stage(
+            lua_content.substr(stage_begin, i + 1 - stage_begin),
+            lua_filename, &predecessor_names.back()));
+      }
+      if (--depth == 0) {
+        break;
+      }
+    }
+  }
+  if (stages.empty() || depth != 0) {
+    THROW_RUNTIME_ERROR("Bad-formed array 'Stages' into the LUA file '" +
+                        lua_filename + "'");
+  }
+
+  // Sort the stages topologically (a stage after all its predecessors)
+  std::map<std::string, std::size_t> index_by_name;
+  for (std::size_t s = 0; s < stages.size(); ++s) {
+    index_by_name[stages[s].m_name] = s;
+  }
+  std::vector<std::size_t> new_index(stages.size(), stages.size());
+  CriticalPathEstimator estimator;
+  while (estimator.m_stages.size() < stages.size()) {
+    const auto sorted_before = estimator.m_stages.size();
+    for (std::size_t s = 0; s < stages.size(); ++s) {
+      if (new_index[s] != stages.size()) {
+        continue;  // Already sorted
+      }
+      std::vector<std::size_t> predecessors;
+      for (const auto& name : predecessor_names[s]) {
+        const auto it = index_by_name.find(name);
+        if (it == index_by_name.cend()) {
+          THROW_RUNTIME_ERROR("Unknown stage '" + name + "' into the LUA "
+                              "file '" + lua_filename + "'");
+        }
+        if (new_index[it->second] == stages.size()) {
+          break;  // A predecessor is not sorted yet
+        }
+        predecessors.push_back(new_index[it->second]);
+      }
+      if (predecessors.size() == predecessor_names[s].size()) {
+        new_index[s] = estimator.m_stages.size();
+        stages[s].m_predecessors = std::move(predecessors);
+        estimator.m_stages.push_back(stages[s]);
+      }
+    }
+    if (estimator.m_stages.size() == sorted_before) {
+      THROW_RUNTIME_ERROR("The stages of the LUA file '" + lua_filename +
+                          "' have cyclic dependencies");
+    }
+  }
+
+  for (const auto& stage : estimator.m_stages) {
+    estimator.m_total_work += stage.m_tasks * stage.m_mean;
+    estimator.m_max_number_of_tasks =
+        std::max(estimator.m_max_number_of_tasks, stage.m_tasks);
+  }
+  return estimator;
+}
+
+double CriticalPathEstimator::estimate_time(double num_cores) const {
+  const double cores = std::max(1.0, std::floor(num_cores));
+
+  // Completion time of each stage (in topological order)
+  std::vector<double> completion_times(m_stages.size(), 0.0);
+  double critical_path = 0.0;
+  for (std::size_t s = 0; s < m_stages.size(); ++s) {
+    const auto& stage = m_stages[s];
+    double start_time = 0.0;
+    for (const auto predecessor : stage.m_predecessors) {
+      start_time = std::max(start_time, completion_times[predecessor]);
+    }
+
+    // Full waves, then the last one (as long as its slowest task)
+    const double waves = std::ceil(stage.m_tasks / cores);
+    const auto tasks_last_wave =
+        static_cast<unsigned>(stage.m_tasks - (waves - 1.0) * cores);
+    completion_times[s] = start_time + (waves - 1.0) * stage.m_mean +
+                          expected_max(stage, tasks_last_wave);
+    critical_path = std::max(critical_path, completion_times[s]);
+  }
+
+  return std::max(critical_path, m_total_work / cores);
+}
+
+double CriticalPathEstimator::expected_max(const Stage& stage,
+                                           unsigned num_tasks) {
+  if (num_tasks <= 1) {
+    return stage.m_mean;
+  }
+  // Approximation of the maximum of 'num_tasks' normal samples
+  return std::min(stage.m_max,
+                  stage.m_mean + stage.m_stddev *
+                                     std::sqrt(2.0 * std::log(num_tasks)));
+}
+
+auto CriticalPathEstimator::parse_stage(const std::string& stage_str,
+                                        const std::string& lua_filename,
+                                        std::vector<std::string>* predecessors)
+    -> Stage {
+  static const std::regex NAME_REGEX(R"re(name\s*=\s*"([^"]*)")re");
+  static const std::regex TASKS_REGEX(R"re(tasks\s*=\s*"?\s*(\d+))re");
+  static const std::regex PRE_REGEX(R"re(pre\s*=\s*\{([^}]*)\})re");
+  static const std::regex QUOTED_REGEX(R"re("([^"]*)")re");
+
+  Stage stage;
+  std::smatch match;
+  if (std::regex_search(stage_str, match, NAME_REGEX) == false) {
+    THROW_RUNTIME_ERROR("A stage without name into the LUA file '" +
+                        lua_filename + "'");
+  }
+  stage.m_name = match[1];
+  if (std::regex_search(stage_str, match, TASKS_REGEX) == false) {
+    THROW_RUNTIME_ERROR("The stage '" + stage.m_name + "' of the LUA file '" +
+                        lua_filename + "' has no number of tasks");
+  }
+  stage.m_tasks = std::max(1ul, std::stoul(match[1]));
+
+  if (std::regex_search(stage_str, match, PRE_REGEX)) {
+    const std::string pre_list = match[1];
+    for (auto it = std::sregex_iterator(pre_list.cbegin(), pre_list.cend(),
+                                        QUOTED_REGEX);
+         it != std::sregex_iterator(); ++it) {
+      predecessors->push_back((*it)[1]);
+    }
+  }
+
+  parse_distribution(stage_str, lua_filename, &stage);
+  return stage;
+}
+
+void CriticalPathEstimator::parse_distribution(const std::string& stage_str,
+                                               const std::string& lua_filename,
+                                               Stage* stage) {
+  static const std::regex TYPE_REGEX(R"re(type\s*=\s*"(\w+)")re");
+  static const std::regex SAMPLES_REGEX(
+      R"re(fileToArray\(\s*"([^"]*)"\s*\))re");
+
+  const auto parameter = [&stage_str, stage,
+                          &lua_filename](const std::string& name) {
+    const std::regex parameter_regex("\\b" + name +
+                                     "\\s*=\\s*([-+0-9.eE]+)");
+    std::smatch match;
+    if (std::regex_search(stage_str, match, parameter_regex) == false) {
+      THROW_RUNTIME_ERROR("The stage '" + stage->m_name +
+                          "' of the LUA file '" + lua_filename +
+                          "' has no parameter '" + name + "'");
+    }
+    return std::stod(match[1]);
+  };
+
+  std::smatch match;
+  const std::string type = std::regex_search(stage_str, match, TYPE_REGEX)
+                               ? std::string(match[1])
+                               : std::string();
+  stage->m_max = std::numeric_limits<double>::infinity();
+  if (type == "empirical") {
+    if (std::regex_search(stage_str, match, SAMPLES_REGEX) == false) {
+      THROW_RUNTIME_ERROR("The stage '" + stage->m_name +
+                          "' of the LUA file '" + lua_filename +
+                          "' has no samples");
+    }
+    const auto samples_filename =
+        resolve_samples_filename(match[1], lua_filename);
+    std::ifstream samples_file(samples_filename);
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    double max = 0.0;
+    unsigned num_samples = 0;
+    for (double sample; samples_file >> sample; ++num_samples) {
+      sum += sample;
+      sum_squares += sample * sample;
+      max = std::max(max, sample);
+    }
+    if (num_samples == 0) {
+      THROW_RUNTIME_ERROR("No samples into the file '" + samples_filename +
+                          "' (stage '" + stage->m_name + "' of the LUA file '" +
+                          lua_filename + "')");
+    }
+    stage->m_mean = sum / num_samples;
+    stage->m_stddev = std::sqrt(std::max(
+        0.0, sum_squares / num_samples - stage->m_mean * stage->m_mean));
+    stage->m_max = max;
+  } else if (type == "exp") {
+    stage->m_mean = 1.0 / parameter("rate");
+    stage->m_stddev = stage->m_mean;
+  } else if (type == "normal") {
+    stage->m_mean = parameter("mu");
+    stage->m_stddev = parameter("sigma");
+  } else if (type == "uniform") {
+    const double min = parameter("min");
+    stage->m_max = parameter("max");
+    stage->m_mean = (min + stage->m_max) / 2.0;
+    stage->m_stddev = (stage->m_max - min) / std::sqrt(12.0);
+  } else {
+    THROW_RUNTIME_ERROR("The distribution '" + type + "' of the stage '" +
+                        stage->m_name + "' of the LUA file '" + lua_filename +
+                        "' is not supported");
+  }
+}
+
+std::string CriticalPathEstimator::resolve_samples_filename(
+    const std::string& filename, const std::string& lua_filename) {
+  if (std::ifstream(filename).good()) {
+    return filename;
+  }
+
+  // Templates moved from another machine: the longest suffix of the path
+  // which exists beside the template
+  const auto lua_directory_end = lua_filename.find_last_of('/');
+  const std::string lua_directory =
+      lua_directory_end == std::string::npos
+          ? std::string(".")
+          : lua_filename.substr(0, lua_directory_end);
+  for (auto separator = filename.find('/'); separator != std::string::npos;
+       separator = filename.find('/', separator + 1)) {
+    const std::string candidate =
+        lua_directory + '/' + filename.substr(separator + 1);
+    if (std::ifstream(candidate).good()) {
+      return candidate;
+    }
+  }
+  THROW_RUNTIME_ERROR("Cannot find the samples file '" + filename +
+                      "' of the LUA file '" + lua_filename + "'");
+}
+
+CriticalPathEstimators CriticalPathEstimators::build(const Process& process,
+                                                     std::ostream* log) {
+  CriticalPathEstimators estimators;
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    const auto& lua_filename =
+        process.get_application_from_index(i).get_lua_name();
+    if (estimators.m_estimators.count(lua_filename) > 0) {
+      continue;
+    }
+    try {
+      estimators.m_estimators.emplace(
+          lua_filename, CriticalPathEstimator::from_lua_file(lua_filename));
+    } catch (const std::exception& err) {
+      *log << "Critical path estimator not available: " << err.what()
+           << '\n';
+    }
+  }
+  return estimators;
+}
+
+const CriticalPathEstimator* CriticalPathEstimators::find(
+    const Application& application) const {
+  const auto it = m_estimators.find(application.get_lua_name());
+  return it == m_estimators.cend() ? nullptr : &it->second;
+}
@@ -0,0 +1,104 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__CRITICAL_PATH_ESTIMATOR__HPP
+#define __OPT_DEADLINE__CRITICAL_PATH_ESTIMATOR__HPP
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ApplicationProfile.hpp"
+
+class Process;
+
+/*! Analytic estimate of the execution time of an application from the DAG
+  of its LUA template (the 'Stages' array: task counts, distribution of the
+  task durations and 'pre' lists).
+  With n cores the tasks of a stage run in waves of n tasks: the full waves
+  take the mean duration of a task each (the cores take a new task as soon
+  as they are free) and the last wave lasts as its slowest task. A stage
+  starts when all its predecessors are completed; the estimate is the
+  longest (critical) path, but not less than the total work divided by n
+  (the stages which run concurrently share the cores).
+ */
+class CriticalPathEstimator {
+ public:
+  //! Parse the DAG of a LUA template. The files of the empirical
+  //! distributions which do not exist are searched also beside the
+  //! template. It throws if the DAG cannot be parsed.
+  static CriticalPathEstimator from_lua_file(const std::string& lua_filename);
+
+  //! \return the expected execution time with 'num_cores' cores
+  double estimate_time(double num_cores) const;
+
+  //! \return the critical path with a core for each task
+  double get_critical_path_time() const {
+    return estimate_time(m_max_number_of_tasks);
+  }
+
+ private:
+  struct Stage {
+    std::string m_name;
+    unsigned m_tasks;
+    double m_mean;    // Mean duration of a task
+    double m_stddev;  // Standard deviation of the duration of a task
+    double m_max;     // Maximum duration of a task (infinity if unbounded)
+    std::vector<std::size_t> m_predecessors;  // Indexes in m_stages
+  };
+
+  std::vector<Stage> m_stages;  // In topological order
+  double m_total_work = 0.0;    // Sum of the durations of all the tasks
+  unsigned m_max_number_of_tasks = 1;
+
+  //! \return the expected duration of the slowest of 'num_tasks' tasks
+  static double expected_max(const Stage& stage, unsigned num_tasks);
+
+  //! Parse a stage of the 'Stages' array (predecessors by name)
+  static Stage parse_stage(const std::string& stage_str,
+                           const std::string& lua_filename,
+                           std::vector<std::string>* predecessors);
+
+  //! Set the mean, standard deviation and maximum of the task durations
+  static void parse_distribution(const std::string& stage_str,
+                                 const std::string& lua_filename,
+                                 Stage* stage);
+
+  //! \return the path of a file of samples referenced by the template
+  static std::string resolve_samples_filename(const std::string& filename,
+                                              const std::string& lua_filename);
+};
+
+//! The estimators of all the applications (by LUA template)
+class CriticalPathEstimators {
+ public:
+  using Application = ApplicationProfile;
+
+  //! Parse the LUA templates of the applications of the process. The
+  //! templates which cannot be parsed are reported into 'log' and skipped.
+  static CriticalPathEstimators build(const Process& process,
+                                      std::ostream* log);
+
+  //! \return the estimator of the application or null if there is not
+  const CriticalPathEstimator* find(const Application& application) const;
+
+ private:
+  std::map<std::string, CriticalPathEstimator> m_estimators;
+};
+
+#endif  // __OPT_DEADLINE__CRITICAL_PATH_ESTIMATOR__HPP
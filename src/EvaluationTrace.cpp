@@ -0,0 +1,261 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "EvaluationTrace.hpp"
+#include <opt_common/helper.hpp>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+//! An evaluation which is recorded when it ends
+class RecordedCommand : public PendingCommand {
+ public:
+  RecordedCommand(EvaluationTrace* trace, EvaluationTrace::Request request,
+                  std::unique_ptr<PendingCommand> command)
+      : m_trace(trace),
+        m_request(std::move(request)),
+        m_command(std::move(command)),
+        m_start(std::chrono::steady_clock::now()) {}
+
+  std::string wait() override {
+    const std::string output = m_command->wait();
+    m_trace->record(m_request, output,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - m_start)
+                        .count());
+    return output;
+  }
+
+  void cancel() noexcept override { m_command->cancel(); }
+
+ private:
+  EvaluationTrace* m_trace;
+  EvaluationTrace::Request m_request;
+  std::unique_ptr<PendingCommand> m_command;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+//! An evaluation answered by the trace (a cancelled one is never looked up)
+class ReplayedCommand : public PendingCommand {
+ public:
+  ReplayedCommand(EvaluationTrace* trace, EvaluationTrace::Request request)
+      : m_trace(trace),
+        m_request(std::move(request)),
+        m_start(std::chrono::steady_clock::now()) {}
+
+  std::string wait() override {
+    const auto answer = m_trace->replay(m_request);
+    m_trace->wait_latency(m_start, answer.second);
+    return answer.first;
+  }
+
+  void cancel() noexcept override {}
+
+ private:
+  EvaluationTrace* m_trace;
+  EvaluationTrace::Request m_request;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+template <typename T>
+void write_value(std::ostream* out, T value) {
+  out->write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_string(std::ostream* out, const std::string& value) {
+  write_value<std::uint64_t>(out, value.size());
+  out->write(value.data(), value.size());
+}
+
+template <typename T>
+bool read_value(std::istream* in, T* value) {
+  return static_cast<bool>(
+      in->read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+//! A string longer than the rest of the file is read as the end of file
+bool read_string(std::istream* in, std::string* value) {
+  std::uint64_t size;
+  if (read_value(in, &size) == false) {
+    return false;
+  }
+  const auto position = in->tellg();
+  in->seekg(0, std::ios::end);
+  const auto remaining = static_cast<std::uint64_t>(in->tellg() - position);
+  in->seekg(position);
+  if (size > remaining) {
+    in->setstate(std::ios::eofbit | std::ios::failbit);
+    return false;
+  }
+  value->resize(size);
+  return size == 0 || static_cast<bool>(in->read(&(*value)[0], size));
+}
+
+std::string request2string(const EvaluationTrace::Request& request) {
+  std::ostringstream oss;
+  oss << WorkerProtocol::JobType2String(request.m_type) << " of application '"
+      << request.m_application_id << "' with "
+      << (request.m_type == WorkerProtocol::JobType::OPT_IC ? "deadline "
+                                                            : "cores ")
+      << request.m_parameter << " (input hash " << std::hex
+      << request.m_input_hash << ")";
+  return oss.str();
+}
+
+}  // namespace
+
+EvaluationTrace::EvaluationTrace(const std::string& filename, Mode mode,
+                                 bool replay_latency, std::ostream* log)
+    : m_mode(mode), m_replay_latency(replay_latency) {
+  if (m_mode == Mode::REPLAY) {
+    std::ostream discarded_log(nullptr);
+    load(filename, log != nullptr ? log : &discarded_log);
+    return;
+  }
+
+  m_output.open(filename, std::ios::binary | std::ios::trunc);
+  if (m_output.fail()) {
+    THROW_RUNTIME_ERROR("Impossible open the file '" + filename + "'");
+  }
+  m_output.write(MAGIC, std::strlen(MAGIC));
+  m_output.flush();
+}
+
+std::uint64_t EvaluationTrace::hash_input(const std::string& input) noexcept {
+  static constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+  static constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+  std::uint64_t hash = FNV_OFFSET_BASIS;
+  for (const char c : input) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+  }
+  return hash;
+}
+
+std::string EvaluationTrace::evaluate(const Request& request,
+                                      const std::function<std::string()>& run) {
+  const auto start = std::chrono::steady_clock::now();
+  if (m_mode == Mode::REPLAY) {
+    const auto answer = replay(request);
+    wait_latency(start, answer.second);
+    return answer.first;
+  }
+
+  const std::string output = run();
+  record(request, output,
+         std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+             .count());
+  return output;
+}
+
+std::unique_ptr<PendingCommand> EvaluationTrace::launch(
+    const Request& request,
+    const std::function<std::unique_ptr<PendingCommand>()>& launch) {
+  if (m_mode == Mode::REPLAY) {
+    return std::unique_ptr<PendingCommand>(
+        new ReplayedCommand(this, request));
+  }
+  return std::unique_ptr<PendingCommand>(
+      new RecordedCommand(this, request, launch()));
+}
+
+void EvaluationTrace::record(const Request& request, const std::string& output,
+                             std::uint64_t latency_ns) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  write_value<std::uint8_t>(&m_output,
+                            static_cast<std::uint8_t>(request.m_type));
+  write_string(&m_output, request.m_application_id);
+  write_value(&m_output, request.m_parameter);
+  write_value(&m_output, request.m_input_hash);
+  write_value(&m_output, latency_ns);
+  write_string(&m_output, output);
+  m_output.flush();
+}
+
+std::pair<std::string, std::uint64_t> EvaluationTrace::replay(
+    const Request& request) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_answers.find(make_key(request));
+  if (it == m_answers.end()) {
+    THROW_RUNTIME_ERROR("Replay: request not in the trace: " +
+                        request2string(request));
+  }
+  Answers& answers = it->second;
+  const auto& answer = answers.m_answers[answers.m_next];
+  if (answers.m_next + 1 < answers.m_answers.size()) {
+    ++answers.m_next;
+  }
+  return answer;
+}
+
+void EvaluationTrace::wait_latency(std::chrono::steady_clock::time_point start,
+                                   std::uint64_t latency_ns) const {
+  if (m_replay_latency) {
+    std::this_thread::sleep_until(start + std::chrono::nanoseconds(latency_ns));
+  }
+}
+
+void EvaluationTrace::load(const std::string& filename, std::ostream* log) {
+  std::ifstream input(filename, std::ios::binary);
+  if (input.fail()) {
+    THROW_RUNTIME_ERROR("Impossible open the file '" + filename + "'");
+  }
+
+  std::string magic(std::strlen(MAGIC), '\0');
+  if (!input.read(&magic[0], magic.size()) || magic != MAGIC) {
+    THROW_RUNTIME_ERROR("The file '" + filename +
+                        "' is not an evaluation trace");
+  }
+
+  std::uint8_t type;
+  for (auto record_begin = input.tellg(); read_value(&input, &type);
+       record_begin = input.tellg()) {
+    if (type != static_cast<std::uint8_t>(JobType::OPT_IC) &&
+        type != static_cast<std::uint8_t>(JobType::DAGSIM)) {
+      THROW_RUNTIME_ERROR("The evaluation trace '" + filename +
+                          "' is corrupted at byte " +
+                          std::to_string(
+                              static_cast<std::streamoff>(record_begin)));
+    }
+    Request request;
+    std::string output;
+    std::uint64_t latency_ns;
+    request.m_type = static_cast<JobType>(type);
+    if (read_string(&input, &request.m_application_id) == false ||
+        read_value(&input, &request.m_parameter) == false ||
+        read_value(&input, &request.m_input_hash) == false ||
+        read_value(&input, &latency_ns) == false ||
+        read_string(&input, &output) == false) {
+      // Only the last record can be partial (the run has been killed while
+      // writing it)
+      if (input.eof() == false) {
+        THROW_RUNTIME_ERROR("The evaluation trace '" + filename +
+                            "' cannot be read at byte " +
+                            std::to_string(
+                                static_cast<std::streamoff>(record_begin)));
+      }
+      *log << "Warning: the evaluation trace '" << filename
+           << "' ends with a partial record (from byte " << record_begin
+           << "): it is ignored\n";
+      break;
+    }
+    m_answers[make_key(request)].m_answers.emplace_back(std::move(output),
+                                                        latency_ns);
+  }
+}
@@ -0,0 +1,127 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__EVALUATION_TRACE__HPP
+#define __OPT_DEADLINE__EVALUATION_TRACE__HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PendingCommand.hpp"
+#include "WorkerProtocol.hpp"
+
+/*! Record (or replay) of the external evaluations of a run: each OPT_IC and
+  dagSim request with its output and its latency.
+  A request is identified by its type and by the hash of its rendered input
+  (the OPT_IC input line with the configuration file, the LUA file given to
+  dagSim), so a replayed run gets the same answers whatever the way the
+  evaluations are launched (locally, on the workers, in batches or
+  speculatively). The same request recorded more than once is answered in
+  the order of the record; the last answer is repeated if it is requested
+  more times. In replay mode a request not in the trace throws.
+
+  The file is binary: the magic string, then a record for each evaluation
+  (type, application ID, deadline or cores, input hash, latency in
+  nanoseconds, output, in the byte order of the host). Records are appended
+  as soon as the evaluation ends, so the trace of an interrupted run keeps
+  the completed evaluations: a partial record at the end of the file (the
+  one being written when the run was killed) is ignored with a warning.
+ */
+class EvaluationTrace {
+ public:
+  using JobType = WorkerProtocol::JobType;
+
+  enum class Mode { RECORD, REPLAY };
+
+  struct Request {
+    JobType m_type;
+    std::string m_application_id;
+    double m_parameter;  // Deadline (OPT_IC) or number of cores (dagSim)
+    std::uint64_t m_input_hash;
+  };
+
+  /*! \param replay_latency  If 'true' each replayed answer is delayed by its
+                             recorded latency
+      \param log             Where the warnings of the load are written
+                             (discarded if null)
+   */
+  EvaluationTrace(const std::string& filename, Mode mode,
+                  bool replay_latency = false, std::ostream* log = nullptr);
+
+  bool is_replaying() const noexcept { return m_mode == Mode::REPLAY; }
+
+  //! \return the (FNV-1a) hash of a rendered input, stable among runs
+  static std::uint64_t hash_input(const std::string& input) noexcept;
+
+  //! Run the evaluation with 'run' (recording it), or replay it
+  //! \return its output
+  std::string evaluate(const Request& request,
+                       const std::function<std::string()>& run);
+
+  //! Launch the evaluation with 'launch' (it is recorded when it ends), or
+  //! replay it (the answer is looked up when it is waited)
+  std::unique_ptr<PendingCommand> launch(
+      const Request& request,
+      const std::function<std::unique_ptr<PendingCommand>()>& launch);
+
+  //! Add an evaluation to the trace (record mode)
+  void record(const Request& request, const std::string& output,
+              std::uint64_t latency_ns);
+
+  //! \return the answer of the request (replay mode). It throws if the
+  //! request is not in the trace
+  std::pair<std::string, std::uint64_t> replay(const Request& request);
+
+  //! Wait the recorded latency (if enabled) since 'start'
+  void wait_latency(std::chrono::steady_clock::time_point start,
+                    std::uint64_t latency_ns) const;
+
+ private:
+  static constexpr const char* MAGIC = "OPTDTRC1";
+
+  using Key = std::pair<int, std::uint64_t>;
+
+  //! The recorded answers of a request (and the next one to replay)
+  struct Answers {
+    std::vector<std::pair<std::string, std::uint64_t>> m_answers;
+    std::size_t m_next = 0;
+  };
+
+  Mode m_mode;
+  bool m_replay_latency;
+  std::mutex m_mutex;
+  std::ofstream m_output;            // Record mode
+  std::map<Key, Answers> m_answers;  // Replay mode
+
+  static Key make_key(const Request& request) {
+    return {static_cast<int>(request.m_type), request.m_input_hash};
+  }
+
+  //! Load the records of the file (replay mode). It throws if the file is
+  //! corrupted before its last record
+  void load(const std::string& filename, std::ostream* log);
+};
+
+#endif  // __OPT_DEADLINE__EVALUATION_TRACE__HPP
@@ -15,38 +15,393 @@ limitations under the License.
 */
 
 #include "FineGrain.hpp"
+#include "Checkpoint.hpp"
 #include <stdio.h>
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cctype>
+#include <cmath>
 #include <cstring>
+#include <fstream>
+#include <iterator>
 #include <list>
+#include <numeric>
 #include <memory>
 #include <queue>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include "PerformanceModel.hpp"
+#include "Statistics.hpp"
+#include "Subprocess.hpp"
+#include "Tracer.hpp"
 
-FineGrain::FineGrain(const Configuration& configuration)
+FineGrain::FineGrain(const Configuration& configuration,
+                     const SolverOptions& options)
     : m_optIC_command(configuration.get_opt_command()),
       m_dagSim_command(configuration.get_dagsim_path() + "/" + DAGSIM_SH),
       m_tmp_directory((configuration.get_tmp_directory().empty()
                            ? DEFAULT_TMP
-                           : configuration.get_tmp_directory())) {}
+                           : configuration.get_tmp_directory())),
+      m_options(options) {}
+
+std::string FineGrain::make_optIC_command(const std::string& optIC_command,
+                                          const std::string& input_filename,
+                                          const std::string& config_filename) {
+  return optIC_command + " " + Subprocess::quote(input_filename) + " -f -c " +
+         Subprocess::quote(config_filename) + " 2>&1";
+}
+
+std::string FineGrain::make_dagSim_command(const std::string& dagSim_script,
+                                           const std::string& lua_filename) {
+  // The execution time is the third field of the first row, followed by the
+  // bounds of its confidence interval
+  return Subprocess::quote(dagSim_script) + " " +
+         Subprocess::quote(lua_filename) +
+         " 2>&1 | sed -n 1,1p | awk '{print $3, $4, $5}'";
+}
+
+void FineGrain::batch_optIC(const Process& process,
+                            const std::vector<IndexApplication>& indexes,
+                            TimeInstant extra_deadline,
+                            std::vector<PrefetchedOptIC>* prefetched,
+                            std::ostream* log) const {
+  // The replayed queries are answered one at a time by the trace
+  const auto& trace = m_options.m_evaluation_trace;
+  if (trace && trace->is_replaying()) {
+    return;
+  }
+
+  // One line of the input file for each query. With the application
+  // registry, the resolved queries are answered at once and the identical
+  // ones share a line
+  const auto& registry = m_options.m_application_registry;
+  std::string input;
+  std::vector<IndexApplication> batched_indexes;
+  std::vector<std::string> application_ids;
+  std::vector<EvaluationTrace::Request> requests;
+  std::vector<std::pair<IndexApplication, std::size_t>> identical_queries;
+  for (const auto i : indexes) {
+    const Application& application = process.get_application_from_index(i);
+    const auto deadline = application.get_deadline() + extra_deadline;
+    const auto request = make_optIC_request(application, deadline,
+                                            process.get_config_filename());
+    const auto line = gen_optIC_input(application, deadline);
+
+    if (registry) {
+      if (registry->find_evaluation(request, &(*prefetched)[i].m_output)) {
+        (*prefetched)[i].m_has_output = true;
+        continue;
+      }
+      const auto identical = std::find_if(
+          requests.cbegin(), requests.cend(),
+          [&request](const EvaluationTrace::Request& batched) {
+            return batched.m_input_hash == request.m_input_hash;
+          });
+      if (identical != requests.cend()) {
+        identical_queries.emplace_back(i, identical - requests.cbegin());
+        continue;
+      }
+    }
+    input += line + '\n';
+    batched_indexes.push_back(i);
+    application_ids.push_back(
+        application.get_files_resources().m_Application_File);
+    requests.push_back(request);
+  }
+  if (batched_indexes.size() < 2) {
+    // The remaining query (if any) is evaluated alone
+    return;
+  }
+  const std::string cmd = make_optIC_command(
+      m_optIC_command, gen_temporary_input_file("batch", input),
+      process.get_config_filename());
+
+  *log << "\t> OptIC batch of " << batched_indexes.size()
+       << " queries, cmd: " << cmd << '\n';
+
+  std::string batch_output;
+  const auto start = std::chrono::steady_clock::now();
+  {
+    Statistics::ScopedExternalCall call_timer(
+        Statistics::ExternalCall::OPT_IC);
+    Tracer::ScopedSpan trace_span("invoke_optIC_batch", "external_call");
+    trace_span.add_argument("queries", batched_indexes.size());
+    batch_output = run_command(cmd);
+  }
+  const auto latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  Statistics::instance().increment(Statistics::Counter::OPT_IC_BATCHED_QUERIES,
+                                   batched_indexes.size());
+
+  const auto outputs = split_optIC_batch_output(batch_output, application_ids);
+  if (outputs.empty()) {
+    *log << "\t> OptIC batch output not recognized: one invocation for each "
+            "query\n";
+    Statistics::instance().increment(
+        Statistics::Counter::OPT_IC_BATCH_FALLBACKS);
+    return;
+  }
+  for (std::size_t k = 0; k < batched_indexes.size(); ++k) {
+    auto& prefetched_query = (*prefetched)[batched_indexes[k]];
+    prefetched_query.m_output = outputs[k];
+    prefetched_query.m_has_output = true;
+
+    // Each query is recorded with its share of the latency of the batch
+    if (trace) {
+      trace->record(requests[k], outputs[k],
+                    latency_ns / batched_indexes.size());
+    }
+    if (registry) {
+      registry->add_evaluation(requests[k], outputs[k]);
+    }
+  }
+  for (const auto& identical_query : identical_queries) {
+    auto& prefetched_query = (*prefetched)[identical_query.first];
+    prefetched_query.m_output = outputs[identical_query.second];
+    prefetched_query.m_has_output = true;
+  }
+}
+
+std::vector<std::string> FineGrain::split_optIC_batch_output(
+    const std::string& batch_output,
+    const std::vector<std::string>& application_ids) {
+  // The answers, in the order of the output
+  std::vector<std::string> answers;
+  std::size_t begin = 0;
+  std::size_t index = batch_output.find(OPT_IC_RELEVANT_ROW);
+  while (index != std::string::npos) {
+    // The answer of a query ends with the line of its number of VMs
+    const std::size_t number = index + std::strlen(OPT_IC_RELEVANT_ROW);
+    if (number >= batch_output.size() ||
+        std::isdigit(static_cast<unsigned char>(batch_output[number])) == 0) {
+      return {};
+    }
+    std::size_t end = batch_output.find('\n', number);
+    end = (end == std::string::npos) ? batch_output.size() : end + 1;
+    answers.push_back(batch_output.substr(begin, end - begin));
+    begin = end;
+    index = batch_output.find(OPT_IC_RELEVANT_ROW, begin);
+  }
+  if (answers.size() != application_ids.size()) {
+    return {};
+  }
+
+  // The application of each answer (the first word of its row)
+  std::vector<std::string> answer_ids;
+  for (const auto& answer : answers) {
+    std::istringstream answer_stream(answer);
+    std::string line;
+    std::string id;
+    while (id.empty() && std::getline(answer_stream, line)) {
+      if (line.compare(0, std::strlen(OPT_IC_APPLICATION_ROW),
+                       OPT_IC_APPLICATION_ROW) == 0) {
+        std::istringstream(line.substr(std::strlen(OPT_IC_APPLICATION_ROW))) >>
+            id;
+      }
+    }
+    if (id.empty()) {
+      return {};
+    }
+    answer_ids.push_back(id);
+  }
+
+  // Each application must have exactly one answer
+  std::vector<std::string> outputs;
+  for (const auto& application_id : application_ids) {
+    const auto answer =
+        std::find(answer_ids.cbegin(), answer_ids.cend(), application_id);
+    if (answer == answer_ids.cend() ||
+        std::count(answer_ids.cbegin(), answer_ids.cend(), application_id) !=
+            1 ||
+        std::count(application_ids.cbegin(), application_ids.cend(),
+                   application_id) != 1) {
+      return {};
+    }
+    outputs.push_back(answers[answer - answer_ids.cbegin()]);
+  }
+  return outputs;
+}
+
+auto FineGrain::prefetch_optIC(const Process& process,
+                               const std::vector<IndexApplication>& indexes,
+                               TimeInstant extra_deadline,
+                               std::ostream* log) const
+    -> std::vector<PrefetchedOptIC> {
+  std::vector<PrefetchedOptIC> prefetched(process.get_number_applications());
+  if (m_options.m_native_core_search) {
+    return prefetched;  // OPT_IC is not used
+  }
+  if (!m_options.m_worker_pool) {
+    if (m_options.m_batch_optIC && indexes.size() > 1) {
+      batch_optIC(process, indexes, extra_deadline, &prefetched, log);
+    }
+    return prefetched;
+  }
+
+  *log << "\t> Launching " << indexes.size()
+       << " OPT_IC evaluations on the workers\n";
+  for (const auto i : indexes) {
+    const Application& application = process.get_application_from_index(i);
+    const auto deadline = application.get_deadline() + extra_deadline;
+    prefetched[i].m_start = std::chrono::steady_clock::now();
+    prefetched[i].m_command = launch_evaluation(
+        [&] {
+          return make_optIC_request(application, deadline,
+                                    process.get_config_filename());
+        },
+        [&] {
+          return m_options.m_worker_pool->submit(
+              {WorkerProtocol::JobType::OPT_IC, "",
+               gen_optIC_input(application, deadline)});
+        });
+  }
+
+  return prefetched;
+}
 
 std::string FineGrain::invoke_optIC(const Application& application,
+                                    TimeInstant deadline,
                                     const std::string& config_filename,
-                                    std::ostream* log) const {
-  static constexpr std::size_t SIZE_BUFFER = 1024;
+                                    std::ostream* log,
+                                    PrefetchedOptIC* prefetched) const {
+  // Evaluation already answered by a batch
+  if (prefetched != nullptr && prefetched->m_has_output) {
+    *log << "\tOptIC evaluated in the batch\n";
+    return prefetched->m_output;
+  }
+
+  // Evaluation already launched on the workers
+  if (prefetched != nullptr && prefetched->m_command) {
+    *log << "\tOptIC evaluated on the workers\n";
+    Tracer::ScopedSpan trace_span("wait_optIC", "external_call");
+    trace_span.add_argument("app_id", application.get_application_id());
+    const std::string result_invoke = prefetched->m_command->wait();
+    Statistics::instance().add_external_call(
+        Statistics::ExternalCall::OPT_IC,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - prefetched->m_start)
+            .count());
+    return result_invoke;
+  }
+
+  // Run OPT_IC on a worker
+  if (m_options.m_worker_pool) {
+    *log << "\tOptIC invoke on the workers\n";
+    Statistics::ScopedExternalCall call_timer(
+        Statistics::ExternalCall::OPT_IC);
+    Tracer::ScopedSpan trace_span("invoke_optIC", "external_call");
+    trace_span.add_argument("app_id", application.get_application_id());
+    trace_span.add_argument("deadline", deadline);
+    return run_evaluation(
+        [&] {
+          return make_optIC_request(application, deadline, config_filename);
+        },
+        [&] {
+          return m_options.m_worker_pool
+              ->submit({WorkerProtocol::JobType::OPT_IC, "",
+                        gen_optIC_input(application, deadline)})
+              ->wait();
+        },
+        log);
+  }
 
-  // Generate the input file for OPT_IC for this application
-  const auto input_file_application = gen_temporary_input_file(application);
+  Statistics::ScopedExternalCall call_timer(
+      Statistics::ExternalCall::OPT_IC);
+  Tracer::ScopedSpan trace_span("invoke_optIC", "external_call");
+  trace_span.add_argument("app_id", application.get_application_id());
+  trace_span.add_argument("deadline", deadline);
+
+  return run_evaluation(
+      [&] {
+        return make_optIC_request(application, deadline, config_filename);
+      },
+      [&] {
+        // Generate the input file for OPT_IC for this application
+        const auto input_file_application =
+            gen_temporary_input_file(application.get_application_id(),
+                                     gen_optIC_input(application, deadline));
+
+        // Create the complete command to invoke
+        const std::string cmd = make_optIC_command(
+            m_optIC_command, input_file_application, config_filename);
+
+        *log << "\tOptIC Invoke cmd: " << cmd << '\n';
+        return run_command(cmd);
+      },
+      log);
+}
 
-  // Create the complete command to invoke
-  const std::string cmd = m_optIC_command + " " + input_file_application +
-                          " -f -c " + config_filename + " 2>&1";
+auto FineGrain::make_optIC_request(const Application& application,
+                                   TimeInstant deadline,
+                                   const std::string& config_filename)
+    -> EvaluationTrace::Request {
+  return {WorkerProtocol::JobType::OPT_IC, application.get_application_id(),
+          static_cast<double>(deadline),
+          EvaluationTrace::hash_input(config_filename + '\n' +
+                                      gen_optIC_input(application, deadline))};
+}
 
-  *log << "\tOptIC Invoke cmd: " << cmd << '\n';
+auto FineGrain::make_dagSim_request(const Application& application,
+                                    int num_cores_to_evaluate,
+                                    unsigned max_jobs)
+    -> EvaluationTrace::Request {
+  return {WorkerProtocol::JobType::DAGSIM, application.get_application_id(),
+          static_cast<double>(num_cores_to_evaluate),
+          EvaluationTrace::hash_input(create_lua_content(
+              application.get_lua_name(), num_cores_to_evaluate, max_jobs))};
+}
+
+std::string FineGrain::run_evaluation(
+    const std::function<EvaluationTrace::Request()>& make_request,
+    const std::function<std::string()>& run, std::ostream* log) const {
+  const auto& trace = m_options.m_evaluation_trace;
+  const auto& registry = m_options.m_application_registry;
+  if (!trace && !registry) {
+    return run();
+  }
+  const auto request = make_request();
+  const auto traced_run = [&]() {
+    if (!trace) {
+      return run();
+    }
+    if (trace->is_replaying()) {
+      *log << "\tAnswer replayed from the evaluation trace\n";
+    }
+    return trace->evaluate(request, run);
+  };
+  if (!registry) {
+    return traced_run();
+  }
+  std::string output;
+  if (registry->find_evaluation(request, &output)) {
+    *log << "\tAnswer of an identical evaluation\n";
+    return output;
+  }
+  return registry->evaluate(request, traced_run);
+}
+
+std::unique_ptr<PendingCommand> FineGrain::launch_evaluation(
+    const std::function<EvaluationTrace::Request()>& make_request,
+    const std::function<std::unique_ptr<PendingCommand>()>& launch) const {
+  const auto& trace = m_options.m_evaluation_trace;
+  const auto& registry = m_options.m_application_registry;
+  if (!trace && !registry) {
+    return launch();
+  }
+  const auto request = make_request();
+  const auto traced_launch = [&]() {
+    return trace ? trace->launch(request, launch) : launch();
+  };
+  return registry ? registry->launch(request, traced_launch) : traced_launch();
+}
+
+std::string FineGrain::run_command(const std::string& cmd) {
+  static constexpr std::size_t SIZE_BUFFER = 1024;
 
   // Launch the process (wrapped in shared ptr for safe)
   std::shared_ptr<FILE> process_pipe(popen(cmd.c_str(), "r"), pclose);
@@ -68,11 +423,20 @@ std::string FineGrain::invoke_optIC(const Application& application,
   return result_invoke;
 }
 
+std::string FineGrain::gen_optIC_input(const Application& application,
+                                       TimeInstant deadline) {
+  const auto& files_app = application.get_files_resources();
+
+  return files_app.m_Application_File + ' ' + files_app.m_Jobs_File + ' ' +
+         files_app.m_Stages_File + ' ' + files_app.m_Tasks_File + ' ' +
+         files_app.m_Lua_File + ' ' + files_app.m_Infrastructure_File + ' ' +
+         std::to_string(deadline);
+}
+
 std::string FineGrain::gen_temporary_input_file(
-    const Application& application) const {
-  std::string temp_filename = m_tmp_directory + "/app_" +
-                              application.get_application_id() + "_" +
-                              generate_random_string();
+    const std::string& name, const std::string& content) const {
+  std::string temp_filename =
+      m_tmp_directory + "/app_" + name + "_" + generate_random_string();
 
   std::ofstream file;
   file.open(temp_filename.c_str());
@@ -80,12 +444,7 @@ std::string FineGrain::gen_temporary_input_file(
     THROW_RUNTIME_ERROR("Cannot open temporary file '" + temp_filename + "'");
   }
 
-  const auto& files_app = application.get_files_resources();
-
-  file << files_app.m_Application_File << ' ' << files_app.m_Jobs_File << ' '
-       << files_app.m_Stages_File << ' ' << files_app.m_Tasks_File << ' '
-       << files_app.m_Lua_File << ' ' << files_app.m_Infrastructure_File << ' '
-       << std::to_string(application.get_deadline());
+  file << content;
 
   file.close();
 
@@ -94,62 +453,138 @@ std::string FineGrain::gen_temporary_input_file(
 
 void FineGrain::process(Process* process, std::ostream* log,
                         std::ostream* result_log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::FINE_GRAIN);
+  Tracer::ScopedSpan trace_span("FineGrain", "phase");
   *log << "FineGrain::process > Starting process\n";
 
   // Get number of application in the process
   const auto number_of_applications = process->get_number_applications();
 
-  // Useful data structure
-  using IndexApplication = std::size_t;
-  using CloseList = std::set<IndexApplication>;
+  // Lower bound of the objective function (continuous relaxation)
+  const double lower_bound = process->compute_objective_lower_bound();
+  *log << "\t> Lower Bound: " << lower_bound << '\n';
 
-  std::string opt_IC_result;
-  std::string dagSim_result;
+  // Useful data structure
+  using IndexApplication = FineGrainState::IndexApplication;
+
+  // The previous answers of OPT_IC (deadline -> number of cores)
+  CoreCountIndex core_count_index;
+
+  // The whole state of the algorithm (it can be restored from a checkpoint)
+  FineGrainState state;
+  state.m_algorithm = m_options.m_algorithm;
+  state.m_total_deadline = process->get_total_deadline();
+  if (m_options.m_resume &&
+      std::ifstream(m_options.m_checkpoint_filename).fail()) {
+    // The run has been interrupted before this algorithm (e.g. the second
+    // of -12) has saved its state
+    *log << "\t> No checkpoint '" << m_options.m_checkpoint_filename
+         << "': starting from the beginning\n";
+  } else if (m_options.m_resume) {
+    *log << "\t> Resuming from checkpoint '" << m_options.m_checkpoint_filename
+         << "'\n";
+    FineGrainState saved_state =
+        Checkpoint::load(m_options.m_checkpoint_filename);
+    if (saved_state.m_algorithm != state.m_algorithm ||
+        saved_state.m_total_deadline != state.m_total_deadline) {
+      THROW_RUNTIME_ERROR(
+          "Checkpoint: the state of '" + saved_state.m_algorithm +
+          "' with total deadline " +
+          std::to_string(saved_state.m_total_deadline) +
+          " cannot be resumed by '" + state.m_algorithm +
+          "' with total deadline " + std::to_string(state.m_total_deadline));
+    }
+    state = std::move(saved_state);
+    state.restore_allocation(process);
+  }
 
-  std::vector<int> coresFromOptIC_perApp;
-  std::vector<int> residualTime_perApp;
-  TimeInstant total_residual_time = 0;
+  auto& coresFromOptIC_perApp = state.m_coresFromOptIC_perApp;
+  auto& residualTime_perApp = state.m_residualTime_perApp;
+  auto& total_residual_time = state.m_total_residual_time;
+
+  // A warm start keeps the execution time simulated with the cores of each
+  // application (unless its deadline has been scaled): the application is
+  // not evaluated again
+  const auto is_seeded = [&](const Application& application) {
+    return m_options.has_warm_start() &&
+           application.get_execution_time() > 0 &&
+           application.get_execution_time() <= application.get_deadline();
+  };
+
+  // With remote workers, the OPT_IC evaluations of all the applications are
+  // launched at once
+  std::vector<IndexApplication> to_prefetch;
+  for (IndexApplication i = state.m_next_app_index;
+       state.m_initialization_completed == false && i < number_of_applications;
+       ++i) {
+    const auto& application = process->get_application_from_index(i);
+    if ((i != state.m_next_app_index || state.m_pending_num_cores < 0) &&
+        is_seeded(application) == false &&
+        is_number_of_cores_known(application, application.get_deadline(),
+                                 core_count_index) == false) {
+      to_prefetch.push_back(i);
+    }
+  }
+  auto prefetched_optIC = prefetch_optIC(*process, to_prefetch, 0, log);
+
+  // For all applications in the process (not yet evaluated)
+  for (IndexApplication i = state.m_next_app_index;
+       state.m_initialization_completed == false && i < number_of_applications;
+       ++i) {
+    if (stop_requested(log)) {
+      return;
+    }
 
-  // For all applications in the process
-  for (IndexApplication i = 0; i < number_of_applications; ++i) {
     *log << "\t> Analysis application n. " << i << '\n';
     // Get i-th application
-    Application& application = process->get_application_from_index_mod(i);
-
-    // Invoke OPT_IC with the deadline in application object and same
-    // configuration file of OPT_Deadline
-    opt_IC_result =
-        invoke_optIC(application, process->get_config_filename(), log);
-
-#ifndef NDEBUG
-    // Print output of execution OPT_IC
-    *log << "########### OUTPUT_OPT_IC ##############\n"
-         << opt_IC_result << "########################################\n";
-#endif
-
-    // Get the number of cores stimed by OPT_IC
-    const int num_cores =
-        get_number_of_cores_from_optIC_output(opt_IC_result, application);
+    const Application& application = process->get_application_from_index(i);
+
+    // The evaluated allocation of the application, applied to the process
+    // once the evaluation is completed
+    ApplicationAllocation evaluated_allocation = application.get_allocation();
+
+    // OPT_IC could have been already invoked before the checkpoint
+    const bool seeded = is_seeded(application);
+    if (seeded) {
+      *log << "\t> Number of cores from the warm start\n";
+      state.m_pending_num_cores = application.get_number_of_core();
+    } else if (state.m_pending_num_cores < 0) {
+      // Number of cores with the deadline in application object and same
+      // configuration file of OPT_Deadline
+      state.m_pending_num_cores = get_number_of_cores(
+          application, application.get_deadline(),
+          process->get_config_filename(), &core_count_index,
+          &prefetched_optIC[i], log);
+      save_checkpoint(*process, &state);
+    }
+    const int num_cores = state.m_pending_num_cores;
     *log << "\t> Number of cores: " << num_cores << '\n';
 
     // Store the number of cores in the vector (i-th position)
     coresFromOptIC_perApp.push_back(num_cores);
-    application.set_number_of_core(num_cores);
+    evaluated_allocation.m_number_of_core = num_cores;
 
     // now you have to call dagsim with 'num_cores' information
     // and get the execution time
-    dagSim_result = invoke_dagSim(application, num_cores, log);
-
-#ifndef NDEBUG
-    // Print output of execution dagSim
-    *log << "########### OUTPUT_DAGSIM ##############\n"
-         << dagSim_result << "########################################\n";
-#endif
+    DagSimResult dagSim_evaluation;
+    if (seeded) {
+      *log << "\t> Execution time from the warm start\n";
+      dagSim_evaluation.m_execution_time = application.get_execution_time();
+      dagSim_evaluation.m_ci_low = dagSim_evaluation.m_ci_high =
+          dagSim_evaluation.m_execution_time;
+    } else if (lookup_time_in_table(application, num_cores,
+                                    &dagSim_evaluation)) {
+      *log << "\t> Execution time from the response table\n";
+    } else {
+      dagSim_evaluation = evaluate_dagSim(application, num_cores, log);
+    }
 
     // Get execution time parsing output dagsim
-    const TimeInstant execution_time =
-        get_execution_time_from_dagSim_output(dagSim_result);
-    *log << "\t> Execution time: " << execution_time << '\n';
+    const TimeInstant execution_time = dagSim_evaluation.m_execution_time;
+    evaluated_allocation.m_execution_time = execution_time;
+    *log << "\t> Execution time: " << execution_time
+         << " (confidence interval [" << dagSim_evaluation.m_ci_low << ", "
+         << dagSim_evaluation.m_ci_high << "])\n";
 
     // Get residual time
     const auto residual_time = application.get_deadline() - execution_time;
@@ -161,92 +596,220 @@ void FineGrain::process(Process* process, std::ostream* log,
     // Add to the total residual time
     total_residual_time += residual_time;
     *log << "\t> Updated Total residual Time: " << total_residual_time << '\n';
+
+    // The evaluation of the i-th app is completed
+    process->get_application_from_index_mod(i).set_allocation(
+        evaluated_allocation);
+    state.m_pending_num_cores = -1;
+    state.m_next_app_index = i + 1;
+    save_checkpoint(*process, &state);
   }  // for all applications
-  process->dump_process(result_log, "Initial Solution SA");
+
+  if (state.m_initialization_completed == false) {
+    process->dump_process(result_log, "Initial Solution SA");
+    m_options.report_progress(*process, "Initial Solution SA");
+    state.m_initialization_completed = true;
+    state.m_next_app_index = 0;
+    save_checkpoint(*process, &state);
+  }
 
   // Apps to not cosider any more
-  CloseList apps_to_remove;
+  auto& apps_to_remove = state.m_apps_to_remove;
 
   // Iteration in the while loop
-  unsigned iteration_index = 0;
+  auto& iteration_index = state.m_iteration_index;
+
+  // The order in which the applications are considered in each iteration
+  const auto scan_order = compute_scan_order(*process, coresFromOptIC_perApp);
+
+  // Set once the estimated gap is within the threshold
+  bool gap_closed = false;
+
+  // Prepare the state for the next iteration (and save it)
+  const auto complete_iteration = [&]() {
+    ++iteration_index;
+    state.m_next_app_index = 0;
+    state.m_candidate_indexes.clear();
+    state.m_candidate_new_n_cores.clear();
+    state.m_best = 0;
+    save_checkpoint(*process, &state);
+  };
 
   // Until no all applications have been removed
   while (apps_to_remove.size() < number_of_applications) {
     *log << "\t> Iteration Index: " << iteration_index << '\n';
+    Statistics::instance().increment(
+        Statistics::Counter::FINE_GRAIN_ITERATIONS);
+    Tracer::ScopedSpan iteration_span("FineGrainIteration", "iteration");
+    iteration_span.add_argument("iteration", iteration_index);
+
+    double& best = state.m_best;
+    int& best_new_n_cores = state.m_best_new_n_cores;
+    IndexApplication& best_index = state.m_best_index;
+
+    // The dagSim simulations of the leading candidates (running in
+    // background while OPT_IC evaluates the other applications)
+    std::vector<SpeculativeDagSim> speculative_dagSims;
+
+    // Set once the state of the next iteration has been saved
+    bool iteration_completed = false;
+
+    // With remote workers, the OPT_IC evaluations of the iteration are
+    // launched at once (the total residual time does not change during the
+    // scan of the applications)
+    to_prefetch.clear();
+    for (IndexApplication index_scan = state.m_next_app_index;
+         index_scan < number_of_applications; ++index_scan) {
+      const IndexApplication i = scan_order[index_scan];
+      const auto& application = process->get_application_from_index(i);
+      const TimeInstant new_deadline =
+          application.get_deadline() + total_residual_time;
+      if (apps_to_remove.find(i) == apps_to_remove.cend() &&
+          core_count_index
+                  .get_bounds(application.get_application_id(), new_deadline)
+                  .m_lower < coresFromOptIC_perApp.at(i) &&
+          is_number_of_cores_known(application, new_deadline,
+                                   core_count_index) == false) {
+        to_prefetch.push_back(i);
+      }
+    }
+    prefetched_optIC =
+        prefetch_optIC(*process, to_prefetch, total_residual_time, log);
 
-    double best = 0;
-    int best_new_n_cores;
-    IndexApplication best_index;
+    // For all applications (not yet evaluated in this iteration)
+    for (IndexApplication index_scan = state.m_next_app_index;
+         index_scan < number_of_applications; ++index_scan) {
+      const IndexApplication i = scan_order[index_scan];
 
-    // For all applications
-    for (IndexApplication i = 0; i < number_of_applications; ++i) {
       // Check if the application has not been removed
       if (apps_to_remove.find(i) == apps_to_remove.cend()) {
+        if (stop_requested(log)) {
+          return;
+        }
+
         *log << "\t> Considering Application Index: " << i << '\n';
 
         // Get application reference
-        Application& application = process->get_application_from_index_mod(i);
-
-        // Invoke OPT_IC with the deadline in application object and same
-        // configuration file of OPT_Deadline
-        // We need to temporary update deadline because invoke_opt method will
-        // evaluate the internal deadline of application
-        const auto saved_deadline = application.get_deadline();
+        const Application& application =
+            process->get_application_from_index(i);
+
+        // The previous answers of OPT_IC bound the number of cores: OPT_IC
+        // is skipped if the application cannot improve or cannot beat the
+        // best of the iteration
+        const auto new_deadline =
+            application.get_deadline() + total_residual_time;
         *log << "\t> Deadline input for OPT_IC (deadline + total_residual): "
-             << saved_deadline + total_residual_time << '\n';
-        application.set_deadline(saved_deadline + total_residual_time);
-        opt_IC_result =
-            invoke_optIC(application, process->get_config_filename(), log);
-
-#ifndef NDEBUG
-        // Print output of execution OPT_IC
-        *log << "########### OUTPUT_OPT_IC ##############\n"
-             << opt_IC_result << "########################################\n";
-#endif
-
-        // Restore previous deadline
-        application.set_deadline(saved_deadline);
-
-        // Get the number of cores stimed by OPT_IC
-        const int new_num_cores =
-            get_number_of_cores_from_optIC_output(opt_IC_result, application);
+             << new_deadline << '\n';
+        const auto bounds = core_count_index.get_bounds(
+            application.get_application_id(), new_deadline);
+        const double best_possible_evaluation =
+            application.get_weight() *
+            (bounds.m_lower - coresFromOptIC_perApp.at(i));
+        int new_num_cores = 0;
+        if (bounds.m_lower >= coresFromOptIC_perApp.at(i)) {
+          *log << "\t> Number of cores bounded by the previous OPT_IC "
+                  "answers: at least "
+               << bounds.m_lower << '\n';
+          Statistics::instance().increment(
+              Statistics::Counter::CORE_COUNT_INDEX_PRUNED);
+          prefetched_optIC[i].m_command.reset();  // Cancel it, if launched
+          new_num_cores = bounds.m_lower;
+        } else if (best_possible_evaluation > best) {
+          *log << "\t\t> Skipped: bounded by the previous OPT_IC answers, it "
+                  "cannot improve on the best\n";
+          Statistics::instance().increment(
+              Statistics::Counter::CORE_COUNT_INDEX_PRUNED);
+          prefetched_optIC[i].m_command.reset();
+          state.m_next_app_index = index_scan + 1;
+          save_checkpoint(*process, &state);
+          continue;
+        } else {
+          new_num_cores = get_number_of_cores(
+              application, new_deadline, process->get_config_filename(),
+              &core_count_index, &prefetched_optIC[i], log);
+        }
 
         if (new_num_cores < coresFromOptIC_perApp.at(i)) {
           const double evaluation =
               application.get_weight() *
               (new_num_cores - coresFromOptIC_perApp.at(i));
 
+          state.m_candidate_indexes.push_back(i);
+          state.m_candidate_new_n_cores.push_back(new_num_cores);
+
           if (evaluation < best) {
             *log << "\t\t> Found new best " << evaluation << '\n';
             best = evaluation;
             best_index = i;
             best_new_n_cores = new_num_cores;
+
+            DagSimResult table_result;
+            if (m_options.m_max_speculative_dagSims > 0 &&
+                lookup_time_in_table(application, new_num_cores,
+                                     &table_result, true) == false) {
+              launch_speculative_dagSim(application, i, new_num_cores,
+                                        &speculative_dagSims, log);
+            }
           }
         } else {
           *log << "\t\t> Application removed\n";
           // Insert i-th app in the close list
           apps_to_remove.insert(i);
         }
+
+        // The evaluation of the i-th app is completed
+        state.m_next_app_index = index_scan + 1;
+        save_checkpoint(*process, &state);
       }  // If app is not in the close list
     }    // For all apps
 
     // If there is a best
     if (best < 0) {
+      if (stop_requested(log)) {
+        return;
+      }
+
+      // Rank the candidates with the same evaluation (multi-fidelity)
+      DagSimResult best_result;
+      const bool best_already_simulated =
+          (m_options.m_screening_max_jobs > 0 ||
+           m_options.m_critical_path_estimators) &&
+          select_among_tied_candidates(*process, &state, &best_result, log);
+
       *log << "\t> New improvement found for application index: " << best_index
            << "\n";
-      // Get the candidate application
-      Application& application =
-          process->get_application_from_index_mod(best_index);
 
-      // Set the new best number of cores
-      application.set_number_of_core(best_new_n_cores);
+      // Get the candidate application
+      const Application& application =
+          process->get_application_from_index(best_index);
+
+      // The allocation of the candidate, with the new best number of cores:
+      // it is applied to the process once it has been evaluated
+      ApplicationAllocation best_allocation = application.get_allocation();
+      best_allocation.m_number_of_core = best_new_n_cores;
+
+      // The response table can answer without any simulation
+      const bool table_hit =
+          best_already_simulated == false &&
+          lookup_time_in_table(application, best_new_n_cores, &best_result);
+      if (table_hit) {
+        *log << "\t> Execution time from the response table\n";
+      }
 
-      // Call dagsim with new no. cores
-      dagSim_result = invoke_dagSim(application, best_new_n_cores, log);
+      // Call dagsim with new no. cores (full fidelity), unless the
+      // simulation has been already launched speculatively
+      const bool speculative_hit = collect_speculative_dagSim(
+          best_index, best_new_n_cores, &speculative_dagSims,
+          (best_already_simulated || table_hit) ? nullptr : &best_result, log);
+      if (best_already_simulated == false && table_hit == false &&
+          speculative_hit == false) {
+        best_result = evaluate_dagSim(application, best_new_n_cores, log);
+      }
 
       // Get execution time parsing output dagsim
-      const TimeInstant execution_time =
-          get_execution_time_from_dagSim_output(dagSim_result);
+      const TimeInstant execution_time = best_result.m_execution_time;
+      *log << "\t> Confidence interval DagSim: [" << best_result.m_ci_low
+           << ", " << best_result.m_ci_high << "]\n";
 
       // Update total residual time
       *log << "\t> Total Residual (Before): " << total_residual_time << "\n";
@@ -268,8 +831,11 @@ void FineGrain::process(Process* process, std::ostream* log,
       // total = total - (new deadline - prev deadline)
       // new deadline deve essere pià grande
 
-      // Update deadline application
-      application.set_deadline(execution_time);
+      // Update deadline application (and apply the allocation)
+      best_allocation.m_deadline = execution_time;
+      best_allocation.m_execution_time = execution_time;
+      process->get_application_from_index_mod(best_index).set_allocation(
+          best_allocation);
 
       *log << "\t> New deadline for application: " << execution_time << '\n';
       *log << "\t> New total residual time: " << total_residual_time << '\n';
@@ -277,26 +843,221 @@ void FineGrain::process(Process* process, std::ostream* log,
       // Add application to the close set
       apps_to_remove.insert(best_index);
 
-      *log << "\t> [Current Result] Iteration Index: " << iteration_index
+      // Saved at once, so that a resume does not repeat the simulation
+      const unsigned improved_iteration = iteration_index;
+      complete_iteration();
+      iteration_completed = true;
+
+      *log << "\t> [Current Result] Iteration Index: " << improved_iteration
            << "; Global Objective Function: "
            << process->compute_global_objective_function() << "; FineGrain\n";
+      // The bound is computed with the ML models: the gap of the objective
+      // evaluated by OPT_IC and dagSim is only an estimate
+      const double gap = process->compute_relative_gap(lower_bound);
+      *log << "\t> Lower Bound (ML): " << lower_bound
+           << "; Estimated Gap: " << 100.0 * gap << "%\n";
+      if (gap < 0.0) {
+        *log << "\t> The objective function is below the lower bound of the "
+                "ML models\n";
+      }
 
       process->dump_process(result_log, "FineGrain");
+      m_options.report_progress(*process, "FineGrain");
+
+      if (m_options.gap_closed(gap)) {
+        *log << "FineGrain::process > Estimated gap " << 100.0 * gap
+             << "% within the threshold. Keeping the current solution\n";
+        gap_closed = true;
+      }
     }
 
-    ++iteration_index;
+    if (iteration_completed == false) {
+      complete_iteration();
+    }
+    if (gap_closed) {
+      break;
+    }
   }  // while all applications removed
 }
 
+auto FineGrain::compute_scan_order(
+    const Process& process, const std::vector<int>& coresFromOptIC_perApp) const
+    -> std::vector<IndexApplication> {
+  std::vector<IndexApplication> scan_order(process.get_number_applications());
+  std::iota(scan_order.begin(), scan_order.end(), 0);
+
+  // With a time budget the applications with the highest cost come first:
+  // they are the ones which can give the largest improvements
+  if (m_options.m_stop_condition->has_time_budget()) {
+    const auto cost = [&](IndexApplication i) {
+      return process.get_application_from_index(i).get_weight() *
+             coresFromOptIC_perApp.at(i);
+    };
+    std::stable_sort(scan_order.begin(), scan_order.end(),
+                     [&cost](IndexApplication i, IndexApplication j) {
+                       return cost(i) > cost(j);
+                     });
+  }
+
+  return scan_order;
+}
+
+bool FineGrain::stop_requested(std::ostream* log) const {
+  if (m_options.m_stop_condition->stop_requested()) {
+    *log << "FineGrain::process > Stop requested. Keeping the best solution "
+            "found so far\n";
+    return true;
+  }
+  return false;
+}
+
+void FineGrain::save_checkpoint(const Process& process,
+                                FineGrainState* state) const {
+  if (m_options.m_checkpoint_filename.empty() == false) {
+    state->store_allocation(process);
+    Checkpoint::save(m_options.m_checkpoint_filename, *state);
+  }
+}
+
+bool FineGrain::is_number_of_cores_known(
+    const Application& application, TimeInstant deadline,
+    const CoreCountIndex& core_count_index) const {
+  int num_cores = 0;
+  return core_count_index.lookup(application.get_application_id(), deadline,
+                                 &num_cores) ||
+         lookup_cores_in_table(application, deadline, &num_cores, true);
+}
+
+int FineGrain::get_number_of_cores(const Application& application,
+                                   TimeInstant deadline,
+                                   const std::string& config_filename,
+                                   CoreCountIndex* core_count_index,
+                                   PrefetchedOptIC* prefetched,
+                                   std::ostream* log) const {
+  int num_cores = 0;
+  if (core_count_index->lookup(application.get_application_id(), deadline,
+                               &num_cores)) {
+    *log << "\t> Number of cores from the previous OPT_IC answers: "
+         << num_cores << '\n';
+    Statistics::instance().increment(
+        Statistics::Counter::CORE_COUNT_INDEX_HITS);
+    return num_cores;
+  }
+
+  if (lookup_cores_in_table(application, deadline, &num_cores)) {
+    *log << "\t> Number of cores from the response table: " << num_cores
+         << '\n';
+    return num_cores;
+  }
+
+  if (m_options.m_native_core_search) {
+    num_cores = search_number_of_cores(application, deadline, log);
+    core_count_index->add(application.get_application_id(), deadline,
+                          num_cores);
+    return num_cores;
+  }
+
+  const std::string opt_IC_result =
+      invoke_optIC(application, deadline, config_filename, log, prefetched);
+
+#ifndef NDEBUG
+  // Print output of execution OPT_IC
+  *log << "########### OUTPUT_OPT_IC ##############\n"
+       << opt_IC_result << "########################################\n";
+#endif
+
+  // Get the number of cores stimed by OPT_IC
+  num_cores =
+      get_number_of_cores_from_optIC_output(opt_IC_result, application);
+  core_count_index->add(application.get_application_id(), deadline,
+                        num_cores);
+  return num_cores;
+}
+
+int FineGrain::search_number_of_cores(const Application& application,
+                                      TimeInstant deadline,
+                                      std::ostream* log) const {
+  Tracer::ScopedSpan trace_span("native_core_search", "external_call");
+  trace_span.add_argument("app_id", application.get_application_id());
+  trace_span.add_argument("deadline", deadline);
+
+  // Whole VMs, as OPT_IC
+  const int num_cores_per_vm =
+      application.get_infrastructure_config().getContainter_cores();
+  unsigned num_simulations = 0;
+  unsigned num_reused = 0;
+  const auto meets_deadline = [&](int num_vms) {
+    const int num_cores = num_vms * num_cores_per_vm;
+    if (m_simulated_times.count({application.get_application_id(),
+                                 num_cores}) > 0) {
+      ++num_reused;
+    } else {
+      ++num_simulations;
+    }
+    return evaluate_dagSim(application, num_cores, log).m_execution_time <=
+           deadline;
+  };
+
+  // Bracket the answer, starting from the estimate of the ML model: the
+  // number of VMs is halved while the deadline is met, or doubled while it
+  // is missed
+  const double estimated_cores = DefaultPerformanceModel::number_of_cores(
+      application.get_machine_learning_model(), static_cast<double>(deadline));
+  int feasible_vms = 1;
+  if (estimated_cores > num_cores_per_vm &&
+      estimated_cores < MAX_NATIVE_SEARCH_VMS * num_cores_per_vm) {
+    feasible_vms =
+        static_cast<int>(std::ceil(estimated_cores / num_cores_per_vm));
+  }
+  int infeasible_vms = 0;  // No VM never meets the deadline
+  if (meets_deadline(feasible_vms)) {
+    while (feasible_vms > 1 && meets_deadline(feasible_vms / 2)) {
+      feasible_vms /= 2;
+    }
+    infeasible_vms = feasible_vms / 2;
+  } else {
+    do {
+      if (feasible_vms >= MAX_NATIVE_SEARCH_VMS) {
+        THROW_RUNTIME_ERROR("Native core search: the deadline " +
+                            std::to_string(deadline) + " of application '" +
+                            application.get_application_id() +
+                            "' cannot be met");
+      }
+      infeasible_vms = feasible_vms;
+      feasible_vms = 2 * feasible_vms < MAX_NATIVE_SEARCH_VMS
+                         ? 2 * feasible_vms
+                         : MAX_NATIVE_SEARCH_VMS;
+    } while (meets_deadline(feasible_vms) == false);
+  }
+
+  // Bisection: the smallest number of VMs which meets the deadline
+  while (feasible_vms - infeasible_vms > 1) {
+    const int middle_vms = infeasible_vms + (feasible_vms - infeasible_vms) / 2;
+    if (meets_deadline(middle_vms)) {
+      feasible_vms = middle_vms;
+    } else {
+      infeasible_vms = middle_vms;
+    }
+  }
+
+  *log << "\t> Native core search: " << feasible_vms * num_cores_per_vm
+       << " cores with " << num_simulations << " simulations (" << num_reused
+       << " reused)\n";
+  Statistics::instance().increment(
+      Statistics::Counter::NATIVE_CORE_SEARCHES);
+  Statistics::instance().increment(
+      Statistics::Counter::NATIVE_CORE_SEARCH_SIMULATIONS, num_simulations);
+  return feasible_vms * num_cores_per_vm;
+}
+
 int FineGrain::get_number_of_cores_from_optIC_output(
     const std::string& optIC_output, const Application& application) const {
-  static constexpr const char* RELEVANT_ROW = "N YARN containers (VMs): ";
-  const auto index = optIC_output.find(RELEVANT_ROW);
+  const auto index = optIC_output.find(OPT_IC_RELEVANT_ROW);
   if (index == std::string::npos) {
     THROW_RUNTIME_ERROR("Parsing error of OPT_IC output");
   }
   std::string num_vm_str =
-      optIC_output.substr(index + std::strlen(RELEVANT_ROW));
+      optIC_output.substr(index + std::strlen(OPT_IC_RELEVANT_ROW));
 
   // trim space and \n
   num_vm_str = num_vm_str.substr(0, num_vm_str.find_first_of(" \n"));
@@ -312,52 +1073,134 @@ int FineGrain::get_number_of_cores_from_optIC_output(
   return num_vm * num_cores_per_vm;
 }
 
-std::string FineGrain::invoke_dagSim(const Application& application,
-                                     int num_cores_to_evaluate,
-                                     std::ostream* log) const {
-  static constexpr const std::size_t SIZE_BUFFER = 1024;
-
+std::string FineGrain::create_dagSim_command(const Application& application,
+                                             int num_cores_to_evaluate,
+                                             unsigned max_jobs) const {
   // Lua template filename absolute
   const std::string& lua_template_filename = application.get_lua_name();
 
   // Generate temporary LUA from template inserting num_cores
-  std::string lua_mod_filename =
-      create_temporary_lua_file(lua_template_filename, num_cores_to_evaluate);
-
-  // Create the complete command to invoke
-  const std::string cmd =
-      m_dagSim_command + " " + lua_mod_filename +
-      " 2>&1 | sed -n 1,1p | awk '{print $3}' | tee result.txt";
+  std::string lua_mod_filename = create_temporary_lua_file(
+      lua_template_filename, num_cores_to_evaluate, max_jobs);
 
-  *log << "\tDagSim invoke cmd: " << cmd << '\n';
+  return make_dagSim_command(m_dagSim_command, lua_mod_filename);
+}
 
-  // Launch the process (wrapped in shared ptr for safe)
-  std::shared_ptr<FILE> process_pipe(popen(cmd.c_str(), "r"), pclose);
-  if (!process_pipe) {
-    throw std::runtime_error(std::string("Error launch process '") + cmd + "'");
+std::unique_ptr<PendingCommand> FineGrain::launch_dagSim(
+    const Application& application, int num_cores_to_evaluate,
+    std::ostream* log) const {
+  const auto make_request = [&] {
+    return make_dagSim_request(application, num_cores_to_evaluate, 0);
+  };
+  if (m_options.m_worker_pool) {
+    *log << "\tDagSim launch on the workers\n";
+    return launch_evaluation(make_request, [&] {
+      return m_options.m_worker_pool->submit(
+          {WorkerProtocol::JobType::DAGSIM, "",
+           create_lua_content(application.get_lua_name(),
+                              num_cores_to_evaluate, 0)});
+    });
   }
 
-  // Prepare buffer to read
-  std::array<char, SIZE_BUFFER> buffer;
-  std::string result_invoke;
+  return launch_evaluation(make_request, [&] {
+    const std::string cmd =
+        create_dagSim_command(application, num_cores_to_evaluate, 0);
+    *log << "\tDagSim launch cmd: " << cmd << '\n';
+    return std::unique_ptr<PendingCommand>(new Subprocess(cmd));
+  });
+}
 
-  // Read the complete process
-  while (!feof(process_pipe.get())) {
-    if (fgets(buffer.data(), buffer.size(), process_pipe.get())) {
-      result_invoke += buffer.data();
-    }
+std::string FineGrain::invoke_dagSim(const Application& application,
+                                     int num_cores_to_evaluate,
+                                     std::ostream* log,
+                                     unsigned max_jobs) const {
+  const auto make_request = [&] {
+    return make_dagSim_request(application, num_cores_to_evaluate, max_jobs);
+  };
+
+  // Run dagSim on a worker (the LUA file is sent with the job)
+  if (m_options.m_worker_pool) {
+    *log << "\tDagSim invoke on the workers\n";
+    Statistics::ScopedExternalCall call_timer(
+        Statistics::ExternalCall::DAGSIM);
+    Tracer::ScopedSpan trace_span("invoke_dagSim", "external_call");
+    trace_span.add_argument("app_id", application.get_application_id());
+    trace_span.add_argument("cores", num_cores_to_evaluate);
+    trace_span.add_argument("max_jobs", max_jobs);
+    const std::string result_invoke = run_evaluation(
+        make_request,
+        [&] {
+          return m_options.m_worker_pool
+              ->submit({WorkerProtocol::JobType::DAGSIM, "",
+                        create_lua_content(application.get_lua_name(),
+                                           num_cores_to_evaluate, max_jobs)})
+              ->wait();
+        },
+        log);
+    write_dagSim_result_file(result_invoke);
+    return result_invoke;
   }
 
+  Statistics::ScopedExternalCall call_timer(
+      Statistics::ExternalCall::DAGSIM);
+  Tracer::ScopedSpan trace_span("invoke_dagSim", "external_call");
+  trace_span.add_argument("app_id", application.get_application_id());
+  trace_span.add_argument("deadline", application.get_deadline());
+  trace_span.add_argument("cores", num_cores_to_evaluate);
+  trace_span.add_argument("max_jobs", max_jobs);
+
+  const std::string result_invoke = run_evaluation(
+      make_request,
+      [&] {
+        const std::string cmd = create_dagSim_command(
+            application, num_cores_to_evaluate, max_jobs);
+        *log << "\tDagSim invoke cmd: " << cmd << '\n';
+        return run_command(cmd);
+      },
+      log);
+  write_dagSim_result_file(result_invoke);
   return result_invoke;
 }
 
+void FineGrain::write_dagSim_result_file(
+    const std::string& dagsim_result) const {
+  if (m_options.m_dagSim_result_filename.empty()) {
+    return;
+  }
+
+  // Only the execution time (as printed by dagSim)
+  std::ofstream result_file(m_options.m_dagSim_result_filename);
+  result_file << dagsim_result.substr(0, dagsim_result.find_first_of(" \n"))
+              << '\n';
+}
+
 std::string FineGrain::create_temporary_lua_file(
-    const std::string& abs_lua_filename, const int num_cores_to_write) const {
-  static constexpr const char* TO_FIND = "Nodes = @@nodes@@;";
+    const std::string& abs_lua_filename, const int num_cores_to_write,
+    unsigned max_jobs) const {
   // Get a unique temporary filename
   std::string temp_filename =
       m_tmp_directory + "/lua_" + generate_random_string() + ".lua";
 
+  // Open the output LUA file
+  std::ofstream output_file;
+  output_file.open(temp_filename);
+  if (output_file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open the input LUA file '" + temp_filename +
+                        "'");
+  }
+
+  output_file << create_lua_content(abs_lua_filename, num_cores_to_write,
+                                    max_jobs);
+
+  return temp_filename;
+}
+
+std::string FineGrain::create_lua_content(const std::string& abs_lua_filename,
+                                          const int num_cores_to_write,
+                                          unsigned max_jobs) {
+  static constexpr const char* TO_FIND = "Nodes = @@nodes@@;";
+  static constexpr const char* MAX_JOBS = "maxJobs";
+
   // Open the input LUA template file
   std::ifstream input_file;
   input_file.open(abs_lua_filename);
@@ -393,17 +1236,18 @@ std::string FineGrain::create_temporary_lua_file(
       finder, std::strlen(TO_FIND),
       "Nodes = " + std::to_string(num_cores_to_write) + ";");
 
-  // Open the output LUA file
-  std::ofstream output_file;
-  output_file.open(temp_filename);
-  if (output_file.fail()) {
-    THROW_RUNTIME_ERROR("Cannot open the input LUA file '" + temp_filename +
-                        "'");
+  // Low fidelity simulation: substitute the number of jobs to simulate
+  if (max_jobs > 0) {
+    // Check the template defines the number of jobs
+    read_max_jobs_from_lua(input_file_str, abs_lua_filename);
+    const auto begin = input_file_str.find(MAX_JOBS);
+    const auto end = input_file_str.find(';', begin);
+    input_file_str = input_file_str.replace(
+        begin, end - begin,
+        std::string(MAX_JOBS) + " = " + std::to_string(max_jobs));
   }
 
-  output_file << input_file_str;
-
-  return temp_filename;
+  return input_file_str;
 }
 
 auto FineGrain::get_execution_time_from_dagSim_output(
@@ -417,3 +1261,375 @@ auto FineGrain::get_execution_time_from_dagSim_output(
         "all data paths are correct.");
   }
 }
+
+unsigned FineGrain::read_max_jobs_from_lua(const std::string& lua_content,
+                                           const std::string& lua_filename) {
+  static constexpr const char* MAX_JOBS = "maxJobs";
+
+  // Expected row: 'maxJobs = 1000;'
+  const auto finder = lua_content.find(MAX_JOBS);
+  const auto assignment = lua_content.find('=', finder);
+  const auto end = lua_content.find(';', finder);
+  if (finder == std::string::npos || assignment == std::string::npos ||
+      end == std::string::npos || assignment > end) {
+    THROW_RUNTIME_ERROR("Cannot find the row '" + std::string(MAX_JOBS) +
+                        " = N;' into the LUA template file '" + lua_filename +
+                        "'");
+  }
+
+  return std::stoul(lua_content.substr(assignment + 1, end - assignment - 1));
+}
+
+auto FineGrain::evaluate_dagSim(const Application& application,
+                                int num_cores_to_evaluate, std::ostream* log,
+                                unsigned max_jobs) const -> DagSimResult {
+  // The full fidelity simulations are reused by the native core search
+  const auto key =
+      std::make_pair(application.get_application_id(), num_cores_to_evaluate);
+  const bool reuse = m_options.m_native_core_search && max_jobs == 0;
+  if (reuse) {
+    const auto it = m_simulated_times.find(key);
+    if (it != m_simulated_times.cend()) {
+      *log << "\t> Execution time of " << num_cores_to_evaluate
+           << " cores already simulated\n";
+      write_dagSim_result_file(std::to_string(it->second.m_execution_time));
+      return it->second;
+    }
+  }
+
+  const std::string dagSim_result =
+      invoke_dagSim(application, num_cores_to_evaluate, log, max_jobs);
+
+#ifndef NDEBUG
+  // Print output of execution dagSim
+  *log << "########### OUTPUT_DAGSIM ##############\n"
+       << dagSim_result << "########################################\n";
+#endif
+
+  const DagSimResult result = parse_dagSim_output(dagSim_result, max_jobs);
+  if (reuse) {
+    m_simulated_times.emplace(key, result);
+  }
+  return result;
+}
+
+auto FineGrain::parse_dagSim_output(const std::string& dagSim_result,
+                                    unsigned max_jobs) const -> DagSimResult {
+  DagSimResult result;
+  result.m_execution_time =
+      get_execution_time_from_dagSim_output(dagSim_result);
+  result.m_max_jobs = max_jobs;
+
+  // The bounds of the confidence interval follow the execution time. If
+  // they are missing (or not consistent) the interval has no width
+  std::istringstream iss(dagSim_result);
+  double execution_time = 0.0;
+  if (!(iss >> execution_time >> result.m_ci_low >> result.m_ci_high) ||
+      result.m_ci_low > execution_time || result.m_ci_high < execution_time) {
+    result.m_ci_low = result.m_ci_high = execution_time;
+  }
+
+  return result;
+}
+
+bool FineGrain::select_among_tied_candidates(const Process& process,
+                                             FineGrainState* state,
+                                             DagSimResult* winner_result,
+                                             std::ostream* log) const {
+  static constexpr double EPSILON = 1e-9;
+
+  // Candidates estimated to consume more than the best estimate plus this
+  // fraction of its execution time are discarded
+  static constexpr double CRITICAL_PATH_MARGIN = 0.05;
+
+  // A candidate with the same evaluation of the best
+  struct TiedCandidate {
+    IndexApplication m_index;
+    int m_new_n_cores;
+    unsigned m_full_max_jobs;
+    DagSimResult m_result;
+  };
+
+  // Collect the candidates tied with the best
+  std::vector<TiedCandidate> tied_candidates;
+  for (std::size_t c = 0; c < state->m_candidate_indexes.size(); ++c) {
+    const auto index = state->m_candidate_indexes[c];
+    const auto new_n_cores = state->m_candidate_new_n_cores[c];
+    const auto& application = process.get_application_from_index(index);
+    const double evaluation =
+        application.get_weight() *
+        (new_n_cores - state->m_coresFromOptIC_perApp.at(index));
+    if (std::abs(evaluation - state->m_best) < EPSILON) {
+      unsigned full_max_jobs = 0;
+      if (m_options.m_screening_max_jobs > 0) {
+        std::ifstream lua_file(application.get_lua_name());
+        const std::string lua_content(
+            (std::istreambuf_iterator<char>(lua_file)),
+            std::istreambuf_iterator<char>());
+        full_max_jobs =
+            read_max_jobs_from_lua(lua_content, application.get_lua_name());
+      }
+      tied_candidates.push_back(
+          {index, new_n_cores, full_max_jobs, DagSimResult()});
+    }
+  }
+
+  if (tied_candidates.size() < 2) {
+    return false;
+  }
+
+  if (m_options.m_critical_path_estimators) {
+    // The estimated consumptions (NaN without estimator)
+    std::vector<double> estimates(tied_candidates.size(), std::nan(""));
+    std::size_t estimated_leader = tied_candidates.size();
+    double leader_time = 0.0;
+    for (std::size_t c = 0; c < tied_candidates.size(); ++c) {
+      double time = 0.0;
+      if (estimate_residual_consumption(
+              process, *state, tied_candidates[c].m_index,
+              tied_candidates[c].m_new_n_cores, &estimates[c], &time) &&
+          (estimated_leader == tied_candidates.size() ||
+           estimates[c] < estimates[estimated_leader])) {
+        estimated_leader = c;
+        leader_time = time;
+      }
+    }
+
+    if (estimated_leader < tied_candidates.size()) {
+      const double threshold =
+          estimates[estimated_leader] + CRITICAL_PATH_MARGIN * leader_time;
+      const auto leader = tied_candidates[estimated_leader];
+      std::vector<TiedCandidate> contenders;
+      for (std::size_t c = 0; c < tied_candidates.size(); ++c) {
+        if (std::isnan(estimates[c]) || estimates[c] <= threshold) {
+          contenders.push_back(tied_candidates[c]);
+        }
+      }
+      const auto num_filtered = tied_candidates.size() - contenders.size();
+      Statistics::instance().increment(
+          Statistics::Counter::CRITICAL_PATH_FILTERED, num_filtered);
+      *log << "\t> Critical path estimates: " << num_filtered << " of "
+           << tied_candidates.size() << " tied candidates discarded\n";
+      tied_candidates = std::move(contenders);
+
+      if (tied_candidates.size() < 2 || m_options.m_screening_max_jobs == 0) {
+        state->m_best_index = leader.m_index;
+        state->m_best_new_n_cores = leader.m_new_n_cores;
+        *log << "\t> Selected candidate " << leader.m_index
+             << " (estimated residual consumption "
+             << estimates[estimated_leader] << ")\n";
+        return false;
+      }
+    }
+  }
+  if (m_options.m_screening_max_jobs == 0) {
+    return false;
+  }
+
+  *log << "\t> Ranking " << tied_candidates.size()
+       << " tied candidates with low fidelity simulations\n";
+
+  // The residual time consumed by a candidate (lower is better)
+  const auto consumption = [&process](const TiedCandidate& candidate,
+                                      double time) {
+    return time -
+           process.get_application_from_index(candidate.m_index).get_deadline();
+  };
+
+  unsigned max_jobs = m_options.m_screening_max_jobs;
+  while (true) {
+    // Simulate all the remaining candidates with the current fidelity
+    bool all_full_fidelity = true;
+    for (auto& candidate : tied_candidates) {
+      const auto& application =
+          process.get_application_from_index(candidate.m_index);
+      const unsigned jobs = std::min(max_jobs, candidate.m_full_max_jobs);
+      all_full_fidelity &= jobs == candidate.m_full_max_jobs;
+      candidate.m_result = evaluate_dagSim(
+          application, candidate.m_new_n_cores, log,
+          jobs == candidate.m_full_max_jobs ? 0 : jobs);
+      Statistics::instance().increment(
+          Statistics::Counter::DAGSIM_SCREENING_RUNS);
+      *log << "\t\t> Candidate " << candidate.m_index << " (maxJobs " << jobs
+           << "): residual consumption "
+           << consumption(candidate, candidate.m_result.m_execution_time)
+           << " [" << consumption(candidate, candidate.m_result.m_ci_low)
+           << ", " << consumption(candidate, candidate.m_result.m_ci_high)
+           << "]\n";
+    }
+
+    // The leader is the candidate which consumes less residual time
+    const auto leader = std::min_element(
+        tied_candidates.cbegin(), tied_candidates.cend(),
+        [&consumption](const TiedCandidate& c1, const TiedCandidate& c2) {
+          return consumption(c1, c1.m_result.m_execution_time) <
+                 consumption(c2, c2.m_result.m_execution_time);
+        });
+    const double leader_upper =
+        consumption(*leader, leader->m_result.m_ci_high);
+
+    // Keep only the candidates which cannot be told apart from the leader
+    std::vector<TiedCandidate> contenders;
+    for (const auto& candidate : tied_candidates) {
+      if (&candidate == &*leader ||
+          consumption(candidate, candidate.m_result.m_ci_low) <= leader_upper) {
+        contenders.push_back(candidate);
+      }
+    }
+
+    if (contenders.size() == 1 || all_full_fidelity) {
+      state->m_best_index = leader->m_index;
+      state->m_best_new_n_cores = leader->m_new_n_cores;
+      *log << "\t> Selected candidate " << leader->m_index << '\n';
+      if (leader->m_result.m_max_jobs == 0) {
+        *winner_result = leader->m_result;
+        return true;
+      }
+      return false;
+    }
+
+    // Escalate the fidelity
+    max_jobs *= 2;
+    tied_candidates = std::move(contenders);
+    Statistics::instance().increment(
+        Statistics::Counter::DAGSIM_FIDELITY_ESCALATIONS);
+    *log << "\t> Candidates cannot be told apart. Escalating fidelity to "
+         << max_jobs << " jobs\n";
+  }
+}
+
+bool FineGrain::estimate_residual_consumption(
+    const Process& process, const FineGrainState& state, IndexApplication index,
+    int new_n_cores, double* consumption, double* time) const {
+  const auto& application = process.get_application_from_index(index);
+  const auto* estimator =
+      m_options.m_critical_path_estimators->find(application.get_profile());
+  if (estimator == nullptr) {
+    return false;
+  }
+
+  // Simulated execution time with the current number of cores
+  const double current_time =
+      application.get_deadline() - state.m_residualTime_perApp.at(index);
+  *time = current_time * estimator->estimate_time(new_n_cores) /
+          estimator->estimate_time(state.m_coresFromOptIC_perApp.at(index));
+  *consumption = *time - application.get_deadline();
+  return true;
+}
+
+void FineGrain::launch_speculative_dagSim(
+    const Application& application, IndexApplication index,
+    int num_cores_to_evaluate,
+    std::vector<SpeculativeDagSim>* speculative_dagSims,
+    std::ostream* log) const {
+  // The oldest simulation belongs to the candidate overtaken first
+  if (speculative_dagSims->size() >= m_options.m_max_speculative_dagSims) {
+    speculative_dagSims->front().m_command->cancel();
+    speculative_dagSims->erase(speculative_dagSims->begin());
+    Statistics::instance().increment(
+        Statistics::Counter::SPECULATIVE_DAGSIM_CANCELLATIONS);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  *log << "\t\t> Speculative DagSim simulation\n";
+  speculative_dagSims->push_back(
+      {index, num_cores_to_evaluate,
+       launch_dagSim(application, num_cores_to_evaluate, log), start});
+  Statistics::instance().increment(
+      Statistics::Counter::SPECULATIVE_DAGSIM_LAUNCHES);
+}
+
+bool FineGrain::collect_speculative_dagSim(
+    IndexApplication index, int num_cores_to_evaluate,
+    std::vector<SpeculativeDagSim>* speculative_dagSims, DagSimResult* result,
+    std::ostream* log) const {
+  bool found = false;
+  for (auto& speculative_dagSim : *speculative_dagSims) {
+    if (found == false && result != nullptr &&
+        speculative_dagSim.m_index == index &&
+        speculative_dagSim.m_num_cores == num_cores_to_evaluate) {
+      Tracer::ScopedSpan trace_span("wait_speculative_dagSim",
+                                    "external_call");
+      trace_span.add_argument("cores", num_cores_to_evaluate);
+
+      const std::string dagSim_result = speculative_dagSim.m_command->wait();
+      Statistics::instance().add_external_call(
+          Statistics::ExternalCall::DAGSIM,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - speculative_dagSim.m_start)
+              .count());
+      Statistics::instance().increment(
+          Statistics::Counter::SPECULATIVE_DAGSIM_HITS);
+      *log << "\t> Using the speculative DagSim simulation\n";
+
+      write_dagSim_result_file(dagSim_result);
+      *result = parse_dagSim_output(dagSim_result, 0);
+      found = true;
+    } else {
+      speculative_dagSim.m_command->cancel();
+      Statistics::instance().increment(
+          Statistics::Counter::SPECULATIVE_DAGSIM_CANCELLATIONS);
+    }
+  }
+  speculative_dagSims->clear();
+
+  return found;
+}
+
+bool FineGrain::lookup_cores_in_table(const Application& application,
+                                      TimeInstant deadline, int* num_cores,
+                                      bool probe_only) const {
+  if (!m_options.m_response_tables) {
+    return false;
+  }
+
+  double cores = 0.0;
+  const bool hit =
+      m_options.m_response_tables->lookup_cores(application.get_profile(),
+                                                deadline, &cores);
+  if (probe_only == false) {
+    Statistics::instance().increment(
+        hit ? Statistics::Counter::RESPONSE_TABLE_HITS
+            : Statistics::Counter::RESPONSE_TABLE_MISSES);
+  }
+  if (hit == false) {
+    return false;
+  }
+
+  // Whole VMs, as OPT_IC
+  const int num_cores_per_vm =
+      application.get_infrastructure_config().getContainter_cores();
+  *num_cores =
+      static_cast<int>(std::ceil(cores / num_cores_per_vm - 1e-9)) *
+      num_cores_per_vm;
+  return true;
+}
+
+bool FineGrain::lookup_time_in_table(const Application& application,
+                                     int num_cores, DagSimResult* result,
+                                     bool probe_only) const {
+  if (!m_options.m_response_tables) {
+    return false;
+  }
+
+  double time = 0.0;
+  const bool hit =
+      m_options.m_response_tables->lookup_time(application.get_profile(),
+                                               num_cores, &time);
+  if (probe_only == false) {
+    Statistics::instance().increment(
+        hit ? Statistics::Counter::RESPONSE_TABLE_HITS
+            : Statistics::Counter::RESPONSE_TABLE_MISSES);
+  }
+  if (hit == false) {
+    return false;
+  }
+
+  result->m_execution_time = static_cast<TimeInstant>(time);
+  result->m_ci_low = result->m_ci_high = time;
+  result->m_max_jobs = 0;
+  if (probe_only == false) {
+    write_dagSim_result_file(std::to_string(time));
+  }
+  return true;
+}
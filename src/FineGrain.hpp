@@ -17,18 +17,30 @@ limitations under the License.
 #ifndef __OPT_DEADLINE__FINE_GRAIN__HPP
 #define __OPT_DEADLINE__FINE_GRAIN__HPP
 
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
 #include <ostream>
+#include <random>
 #include <string>
 #include <utility>
+#include <vector>
+#include "CoreCountIndex.hpp"
+#include "EvaluationTrace.hpp"
+#include "PendingCommand.hpp"
 #include "Process.hpp"
+#include "SolverOptions.hpp"
+
+struct FineGrainState;
 
 class FineGrain {
  public:
   using TimeInstant = opt_common::TimeInstant;
-  using Application = opt_common::Application;
+  using Application = Process::Application;
   using Configuration = opt_common::Configuration;
 
-  FineGrain(const Configuration& configuration);
+  FineGrain(const Configuration& configuration, const SolverOptions& options);
 
   /*! It launch FineGrain algorithm
     \param [in, out] process    The process to elaborate
@@ -37,43 +49,306 @@ class FineGrain {
    */
   void process(Process* process, std::ostream* log, std::ostream* result_log);
 
- private:
   static constexpr const char* DAGSIM_SH = "dagsim.sh";
+
+  //! \return the shell command which runs OPT_IC on an input file
+  static std::string make_optIC_command(const std::string& optIC_command,
+                                        const std::string& input_filename,
+                                        const std::string& config_filename);
+
+  //! \return the shell command which runs dagSim on a LUA file. It prints
+  //! the execution time followed by the bounds of its confidence interval
+  static std::string make_dagSim_command(const std::string& dagSim_script,
+                                         const std::string& lua_filename);
+
+  //! Launch dagSim (locally or on the workers) without waiting its output
+  std::unique_ptr<PendingCommand> launch_dagSim(
+      const Application& application, int num_cores_to_evaluate,
+      std::ostream* log) const;
+
+ private:
   static constexpr const char* DEFAULT_TMP = "/tmp";
 
+  //! The row of the OPT_IC output with the number of VMs
+  static constexpr const char* OPT_IC_RELEVANT_ROW =
+      "N YARN containers (VMs): ";
+
+  //! The row of the OPT_IC output with the application (the first field of
+  //! its input line)
+  static constexpr const char* OPT_IC_APPLICATION_ROW = "Application ";
+
   std::string m_optIC_command;
   std::string m_dagSim_command;
   std::string m_tmp_directory;
+  SolverOptions m_options;
+
+  using IndexApplication = std::size_t;
+
+  //! \return the order in which the applications are considered in each
+  //! iteration. With a time budget the most promising applications come first.
+  std::vector<IndexApplication> compute_scan_order(
+      const Process& process,
+      const std::vector<int>& coresFromOptIC_perApp) const;
+
+  //! \return 'true' (and log it) if the algorithm has to stop
+  bool stop_requested(std::ostream* log) const;
+
+  //! \return 'true' if the response table answers the number of cores needed
+  //! by the application to meet 'deadline' (rounded up to whole VMs). With
+  //! 'probe_only' the lookup is not recorded in the statistics
+  bool lookup_cores_in_table(const Application& application,
+                             TimeInstant deadline, int* num_cores,
+                             bool probe_only = false) const;
 
+  //! Write the state into the checkpoint file (if checkpoints are enabled)
+  void save_checkpoint(const Process& process, FineGrainState* state) const;
+
+  //! An OPT_IC evaluation launched in advance on the workers (or answered
+  //! by a batched invocation)
+  struct PrefetchedOptIC {
+    std::unique_ptr<PendingCommand> m_command;
+    std::chrono::steady_clock::time_point m_start;
+    std::string m_output;
+    bool m_has_output = false;
+  };
+
+  /*! Launch on the workers the OPT_IC evaluations of the applications
+    'indexes' (with their deadline increased by 'extra_deadline'). Without
+    workers, if batches are enabled, they are evaluated at once by a single
+    local OPT_IC invocation. The result has an element for each application
+    of the process: it is empty for the applications not evaluated.
+   */
+  std::vector<PrefetchedOptIC> prefetch_optIC(
+      const Process& process, const std::vector<IndexApplication>& indexes,
+      TimeInstant extra_deadline, std::ostream* log) const;
+
+  /*! Evaluate the queries with a single OPT_IC invocation (an input line
+    for each query) and store the answer of each one in 'prefetched'. If the
+    output cannot be split, nothing is stored and each query will be
+    evaluated by its own invocation.
+   */
+  void batch_optIC(const Process& process,
+                   const std::vector<IndexApplication>& indexes,
+                   TimeInstant extra_deadline,
+                   std::vector<PrefetchedOptIC>* prefetched,
+                   std::ostream* log) const;
+
+  //! \return the output of each query of a batch, in the order of
+  //! 'application_ids' (empty if the output does not contain exactly one
+  //! answer for each application, or if an application is repeated)
+  static std::vector<std::string> split_optIC_batch_output(
+      const std::string& batch_output,
+      const std::vector<std::string>& application_ids);
+
+  //! Run OPT_IC for the application with 'deadline' (or take its
+  //! prefetched evaluation, if any)
   std::string invoke_optIC(const Application& application,
+                           TimeInstant deadline,
                            const std::string& config_filename,
-                           std::ostream* log) const;
+                           std::ostream* log,
+                           PrefetchedOptIC* prefetched = nullptr) const;
+
+  //! \return the request of the OPT_IC evaluation of the application with
+  //! 'deadline'
+  static EvaluationTrace::Request make_optIC_request(
+      const Application& application, TimeInstant deadline,
+      const std::string& config_filename);
+
+  static EvaluationTrace::Request make_dagSim_request(
+      const Application& application, int num_cores_to_evaluate,
+      unsigned max_jobs);
+
+  //! Run an evaluation with 'run', recording it (or replaying it instead)
+  //! if there is an evaluation trace. With the application registry an
+  //! identical evaluation is resolved only once
+  std::string run_evaluation(
+      const std::function<EvaluationTrace::Request()>& make_request,
+      const std::function<std::string()>& run, std::ostream* log) const;
+
+  //! Launch an evaluation with 'launch', recording it (or replaying it
+  //! instead) if there is an evaluation trace. With the application registry
+  //! an identical evaluation is launched only once
+  std::unique_ptr<PendingCommand> launch_evaluation(
+      const std::function<EvaluationTrace::Request()>& make_request,
+      const std::function<std::unique_ptr<PendingCommand>()>& launch) const;
+
+  //! \return the content of the OPT_IC input file for the application with
+  //! 'deadline'
+  static std::string gen_optIC_input(const Application& application,
+                                     TimeInstant deadline);
 
-  std::string gen_temporary_input_file(const Application& application) const;
+  //! Write 'content' into a new temporary file
+  //! \return the name of the file
+  std::string gen_temporary_input_file(const std::string& name,
+                                       const std::string& content) const;
+
+  //! Run a shell command and wait its end
+  //! \return the standard output of the command
+  static std::string run_command(const std::string& cmd);
+
+  //! \return 'true' if the number of cores of the application with
+  //! 'deadline' is known without OPT_IC (previous answers or response table)
+  bool is_number_of_cores_known(const Application& application,
+                                TimeInstant deadline,
+                                const CoreCountIndex& core_count_index) const;
+
+  /*! \return the number of cores given by OPT_IC to the application with
+    'deadline'. The answer is inferred from the previous answers or read from
+    the response table when possible; otherwise OPT_IC is invoked and its
+    answer is added to 'core_count_index'.
+   */
+  int get_number_of_cores(const Application& application,
+                          TimeInstant deadline,
+                          const std::string& config_filename,
+                          CoreCountIndex* core_count_index,
+                          PrefetchedOptIC* prefetched, std::ostream* log) const;
 
   int get_number_of_cores_from_optIC_output(
       const std::string& optIC_output, const Application& application) const;
 
+  //! The result of a dagSim simulation
+  struct DagSimResult {
+    TimeInstant m_execution_time;
+    double m_ci_low;   // Confidence interval (lower bound)
+    double m_ci_high;  // Confidence interval (upper bound)
+    unsigned m_max_jobs;
+  };
+
+  //! The full fidelity simulations (application ID, cores) done with the
+  //! native core search, reused by the following searches and evaluations
+  mutable std::map<std::pair<std::string, int>, DagSimResult>
+      m_simulated_times;
+
+  //! The native core search gives up beyond this number of VMs
+  static constexpr int MAX_NATIVE_SEARCH_VMS = 1 << 20;
+
+  /*! \return the smallest number of cores (whole VMs, as OPT_IC) with which
+    the dagSim simulation of the application meets 'deadline'. The answer is
+    bracketed starting from the estimate of the ML model and then bisected.
+   */
+  int search_number_of_cores(const Application& application,
+                             TimeInstant deadline, std::ostream* log) const;
+
+  //! A dagSim simulation launched in background for a leading candidate
+  struct SpeculativeDagSim {
+    IndexApplication m_index;
+    int m_num_cores;
+    std::unique_ptr<PendingCommand> m_command;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  //! Create the temporary LUA file. If 'max_jobs' is not zero, it overrides
+  //! the number of jobs to simulate of the LUA template (low fidelity)
+  //! \return the command which launches dagSim
+  std::string create_dagSim_command(const Application& application,
+                                    int num_cores_to_evaluate,
+                                    unsigned max_jobs) const;
+
+  //! Launch dagSim (locally or on the workers) and wait its output
   std::string invoke_dagSim(const Application& application,
-                            int num_cores_to_evaluate, std::ostream* log) const;
+                            int num_cores_to_evaluate, std::ostream* log,
+                            unsigned max_jobs = 0) const;
+
+  //! Write the execution time of a dagSim output into the result file of
+  //! the options (if any)
+  void write_dagSim_result_file(const std::string& dagsim_result) const;
 
   TimeInstant get_execution_time_from_dagSim_output(
       const std::string& dagsim_result) const;
 
+  //! \return 'true' if the response table answers the execution time of the
+  //! application with 'num_cores' (the result has no confidence interval).
+  //! Unless 'probe_only', the lookup is recorded and the result file written
+  bool lookup_time_in_table(const Application& application, int num_cores,
+                            DagSimResult* result,
+                            bool probe_only = false) const;
+
+  //! Parse the execution time and the confidence interval
+  DagSimResult parse_dagSim_output(const std::string& dagsim_result,
+                                   unsigned max_jobs) const;
+
+  //! Invoke dagSim and parse also the confidence interval of its result
+  DagSimResult evaluate_dagSim(const Application& application,
+                               int num_cores_to_evaluate, std::ostream* log,
+                               unsigned max_jobs = 0) const;
+
+  /*! Launch in background the dagSim simulation of a candidate which is
+    leading the iteration. If too many simulations are running, the oldest
+    one (the candidate overtaken first) is cancelled.
+   */
+  void launch_speculative_dagSim(
+      const Application& application, IndexApplication index,
+      int num_cores_to_evaluate,
+      std::vector<SpeculativeDagSim>* speculative_dagSims,
+      std::ostream* log) const;
+
+  /*! Wait the speculative simulation of the winner (if it has been launched)
+    and cancel all the others.
+    \param [out] result  The result of the speculative simulation (if it is
+                         null all the simulations are cancelled)
+    \return 'true' if 'result' has been set
+   */
+  bool collect_speculative_dagSim(
+      IndexApplication index, int num_cores_to_evaluate,
+      std::vector<SpeculativeDagSim>* speculative_dagSims,
+      DagSimResult* result, std::ostream* log) const;
+
+  /*! Among the candidates of the iteration with the same evaluation of the
+    best, select the one which consumes the least residual time.
+    The critical path estimates discard first the candidates which consume
+    clearly more than the best estimate. The remaining candidates are ranked
+    with low fidelity simulations (if enabled, otherwise the best estimate
+    is selected); the fidelity is doubled while the leader cannot be told
+    apart from the others.
+    \param [out] winner_result  The full fidelity result of the winner (if
+                                it has been simulated at full fidelity)
+    \return 'true' if 'winner_result' has been set
+   */
+  bool select_among_tied_candidates(const Process& process,
+                                    FineGrainState* state,
+                                    DagSimResult* winner_result,
+                                    std::ostream* log) const;
+
+  /*! Estimate the residual time consumed by a candidate with the critical
+    path estimator, calibrated on the simulation with the current cores.
+    \param [out] time  The estimated execution time with 'new_n_cores'
+    \return 'false' if the application has no estimator
+   */
+  bool estimate_residual_consumption(const Process& process,
+                                     const FineGrainState& state,
+                                     IndexApplication index, int new_n_cores,
+                                     double* consumption, double* time) const;
+
+  //! \return the content of the LUA template with the number of cores (and
+  //! the number of jobs, if not zero) substituted
+  static std::string create_lua_content(const std::string& abs_lua_filename,
+                                        const int num_cores_to_write,
+                                        unsigned max_jobs);
+
   std::string create_temporary_lua_file(const std::string& abs_lua_filename,
-                                        const int num_cores_to_write) const;
+                                        const int num_cores_to_write,
+                                        unsigned max_jobs = 0) const;
+
+  //! \return the number of jobs simulated by the LUA template
+  static unsigned read_max_jobs_from_lua(const std::string& lua_content,
+                                         const std::string& lua_filename);
 
+  //! The random engine is private to the thread, so the solvers running in
+  //! other threads do not interfere (nor generate the same names)
   static std::string generate_random_string(const std::size_t len = 6) {
     static constexpr char alphanum_table[] =
         "0123456789"
         "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
         "abcdefghijklmnopqrstuvwxyz";
+    thread_local std::mt19937 rnd_engine{std::random_device{}()};
+    std::uniform_int_distribution<std::size_t> rnd_char_distr(
+        0, sizeof(alphanum_table) - 2);
 
     std::string rnd_string;
     rnd_string.reserve(len);
 
     for (std::size_t i = 0; i < len; ++i) {
-      char rnd_char = alphanum_table[rand() % (sizeof(alphanum_table) - 1)];
+      char rnd_char = alphanum_table[rnd_char_distr(rnd_engine)];
       rnd_string.push_back(rnd_char);
     }
 
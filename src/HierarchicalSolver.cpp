@@ -0,0 +1,304 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "HierarchicalSolver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+bool HierarchicalSolver::process(const SolveFunction& solve, Process* process,
+                                 std::ostream* log,
+                                 std::ostream* result_log) const {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::HIERARCHICAL);
+  Tracer::ScopedSpan trace_span("Hierarchical", "phase");
+  *log << "HierarchicalSolver::process > Starting process\n";
+
+  if (process->get_number_applications() == 0) {
+    THROW_RUNTIME_ERROR("HierarchicalSolver: no applications to process");
+  }
+
+  const auto groups = partition(*process);
+  *log << "\t> Number of groups: " << groups.size() << '\n';
+
+  // Aggregated models: S = sum of sqrt(weight * chi_c)
+  std::vector<double> scales(groups.size(), 0.0);
+  for (unsigned g = 0; g < groups.size(); ++g) {
+    for (const auto index_app : groups[g]) {
+      const auto& application = process->get_application_from_index(index_app);
+      const auto& mlm = application.get_machine_learning_model();
+      scales[g] += std::sqrt(application.get_weight() * mlm.get_chi_c());
+    }
+  }
+
+  const auto deadlines = split_deadline(*process, groups, scales);
+  std::vector<double> costs;
+  std::string dagSim_result;
+  if (solve_groups(solve, groups, deadlines, process, &costs, &dagSim_result,
+                   log, result_log) == false) {
+    return false;
+  }
+  process->dump_process(result_log, "Hierarchical solution");
+
+  // Coordination pass: calibrate the aggregated models on the costs found
+  // (cost = S^2 / (D - C0))
+  std::vector<double> calibrated_scales(groups.size());
+  for (unsigned g = 0; g < groups.size(); ++g) {
+    const double slack =
+        deadlines[g] - compute_group_chi_0(*process, groups[g]);
+    calibrated_scales[g] = std::sqrt(costs[g] * slack);
+    if (!(calibrated_scales[g] > 0.0)) {
+      *log << "\t> Coordination skipped: group " << g << " has no cost\n";
+      write_dagSim_result_file(dagSim_result);
+      return true;
+    }
+  }
+  if (m_options.m_stop_condition->stop_requested()) {
+    write_dagSim_result_file(dagSim_result);
+    return true;
+  }
+
+  const auto new_deadlines =
+      split_deadline(*process, groups, calibrated_scales);
+  double max_change = 0.0;
+  for (unsigned g = 0; g < groups.size(); ++g) {
+    max_change = std::max(
+        max_change, std::abs(static_cast<double>(new_deadlines[g]) -
+                             static_cast<double>(deadlines[g])) /
+                        deadlines[g]);
+  }
+  *log << "\t> Coordination: maximum relative change of the group deadlines: "
+       << max_change << '\n';
+  if (max_change <= COORDINATION_TOLERANCE) {
+    write_dagSim_result_file(dagSim_result);
+    *log << "HierarchicalSolver::process > End process\n";
+    return true;
+  }
+
+  // The coordination changes only the allocation of the process: the
+  // previous one is applied back if it is not improved
+  const Allocation previous_allocation = process->get_allocation();
+  const double previous_objective =
+      process->compute_global_objective_function();
+  std::vector<double> coordinated_costs;
+  std::string coordinated_dagSim_result;
+  if (solve_groups(solve, groups, new_deadlines, process, &coordinated_costs,
+                   &coordinated_dagSim_result, log, result_log) &&
+      m_options.m_stop_condition->stop_requested() == false &&
+      process->compute_global_objective_function() < previous_objective) {
+    process->dump_process(result_log,
+                          "Hierarchical solution after coordination");
+    dagSim_result = coordinated_dagSim_result;
+  } else {
+    process->set_allocation(previous_allocation);
+    *log << "\t> Coordination: no improvement, previous solution kept\n";
+  }
+  write_dagSim_result_file(dagSim_result);
+
+  *log << "HierarchicalSolver::process > End process\n";
+  return true;
+}
+
+auto HierarchicalSolver::partition(const Process& process) const
+    -> std::vector<Group> {
+  const unsigned number_of_applications = process.get_number_applications();
+  const unsigned number_of_groups =
+      std::max(1u, std::min(m_number_of_groups, number_of_applications));
+
+  // Sort by chi_c / chi_0 (compared without divisions, chi_0 may be zero)
+  std::vector<unsigned> order(number_of_applications);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&process](unsigned i, unsigned j) {
+                     const auto& mlm_i = process.get_application_from_index(i)
+                                             .get_machine_learning_model();
+                     const auto& mlm_j = process.get_application_from_index(j)
+                                             .get_machine_learning_model();
+                     return mlm_i.get_chi_c() * mlm_j.get_chi_0() <
+                            mlm_j.get_chi_c() * mlm_i.get_chi_0();
+                   });
+
+  std::vector<Group> groups(number_of_groups);
+  for (unsigned g = 0; g < number_of_groups; ++g) {
+    const unsigned begin = g * number_of_applications / number_of_groups;
+    const unsigned end = (g + 1) * number_of_applications / number_of_groups;
+    groups[g].assign(order.begin() + begin, order.begin() + end);
+  }
+  return groups;
+}
+
+auto HierarchicalSolver::split_deadline(const Process& process,
+                                        const std::vector<Group>& groups,
+                                        const std::vector<double>& scales)
+    -> std::vector<TimeInstant> {
+  std::vector<double> chi_0_groups(groups.size());
+  double sum_chi_0 = 0.0;
+  double sum_scales = 0.0;
+  for (unsigned g = 0; g < groups.size(); ++g) {
+    chi_0_groups[g] = compute_group_chi_0(process, groups[g]);
+    sum_chi_0 += chi_0_groups[g];
+    sum_scales += scales[g];
+  }
+
+  const TimeInstant total_deadline = process.get_total_deadline();
+  const double slack = total_deadline - sum_chi_0;
+  if (slack <= 0.0) {
+    THROW_RUNTIME_ERROR("HierarchicalSolver: the total deadline " +
+                        std::to_string(total_deadline) +
+                        " is not greater than the sum of chi_0 of the "
+                        "applications. The problem is, thus, unfeasible.");
+  }
+
+  std::vector<TimeInstant> deadlines(groups.size());
+  TimeInstant assigned_deadline = 0;
+  for (unsigned g = 0; g < groups.size(); ++g) {
+    const double share = sum_scales > 0.0 ? scales[g] / sum_scales
+                                          : 1.0 / groups.size();
+    deadlines[g] =
+        static_cast<TimeInstant>(chi_0_groups[g] + slack * share);
+    assigned_deadline += deadlines[g];
+  }
+
+  // The rounding remainder goes to the group with the largest share
+  const auto largest_group =
+      std::max_element(scales.cbegin(), scales.cend()) - scales.cbegin();
+  deadlines[largest_group] += total_deadline - assigned_deadline;
+  return deadlines;
+}
+
+bool HierarchicalSolver::solve_groups(const SolveFunction& solve,
+                                      const std::vector<Group>& groups,
+                                      const std::vector<TimeInstant>& deadlines,
+                                      Process* process,
+                                      std::vector<double>* costs,
+                                      std::string* dagSim_result,
+                                      std::ostream* log,
+                                      std::ostream* result_log) const {
+  const unsigned number_of_groups = groups.size();
+  std::vector<Process> subprocesses;
+  subprocesses.reserve(number_of_groups);
+  for (unsigned g = 0; g < number_of_groups; ++g) {
+    subprocesses.push_back(process->create_subprocess(groups[g], deadlines[g]));
+  }
+
+  // The groups run at the same time: each one writes the dagSim result
+  // file to a file of its own
+  std::vector<SolverOptions> group_options(number_of_groups, m_options);
+  if (m_options.m_dagSim_result_filename.empty() == false) {
+    for (unsigned g = 0; g < number_of_groups; ++g) {
+      group_options[g].m_dagSim_result_filename =
+          m_options.m_dagSim_result_filename + ".group" + std::to_string(g);
+      std::remove(group_options[g].m_dagSim_result_filename.c_str());
+    }
+  }
+
+  // The groups are taken by a thread at a time
+  std::vector<std::ostringstream> group_logs(number_of_groups);
+  std::vector<std::ostringstream> group_result_logs(number_of_groups);
+  std::vector<char> statuses(number_of_groups, 0);
+  std::atomic<unsigned> next_group{0};
+  const auto solve_next_groups = [&]() {
+    for (unsigned g = next_group++; g < number_of_groups; g = next_group++) {
+      Tracer::ScopedSpan group_span("HierarchicalGroup", "group");
+      group_span.add_argument("group", g);
+      try {
+        statuses[g] = solve(group_options[g], &subprocesses[g], &group_logs[g],
+                            &group_result_logs[g]);
+      } catch (const std::exception& err) {
+        group_logs[g] << err.what() << '\n';
+      }
+      Statistics::instance().increment(
+          Statistics::Counter::HIERARCHICAL_GROUP_SOLVES);
+    }
+  };
+
+  const unsigned number_of_threads = std::max(
+      1u, std::min(number_of_groups, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < number_of_threads; ++t) {
+    threads.emplace_back(solve_next_groups);
+  }
+  solve_next_groups();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Logs (in order of group) and solutions
+  bool status = true;
+  costs->assign(number_of_groups, 0.0);
+  dagSim_result->clear();
+  for (unsigned g = 0; g < number_of_groups; ++g) {
+    const auto& group_result_filename =
+        group_options[g].m_dagSim_result_filename;
+    if (group_result_filename.empty() == false) {
+      std::ifstream group_result_file(group_result_filename);
+      if (group_result_file) {
+        std::ostringstream content;
+        content << group_result_file.rdbuf();
+        *dagSim_result = content.str();
+        group_result_file.close();
+        std::remove(group_result_filename.c_str());
+      }
+    }
+
+    *log << "\t> Group " << g << " (" << groups[g].size()
+         << " applications; deadline " << deadlines[g] << ")\n"
+         << group_logs[g].str();
+    *result_log << group_result_logs[g].str();
+    if (statuses[g] == 0) {
+      *log << "\t> Group " << g << " failed\n";
+      status = false;
+      continue;
+    }
+
+    (*costs)[g] = subprocesses[g].compute_global_objective_function();
+    for (unsigned k = 0; k < groups[g].size(); ++k) {
+      const auto& solved = subprocesses[g].get_application_from_index(k);
+      auto& application = process->get_application_from_index_mod(groups[g][k]);
+      application.set_deadline(solved.get_deadline());
+      application.set_number_of_core(solved.get_number_of_core());
+    }
+  }
+  return status;
+}
+
+void HierarchicalSolver::write_dagSim_result_file(
+    const std::string& dagSim_result) const {
+  if (m_options.m_dagSim_result_filename.empty() || dagSim_result.empty()) {
+    return;
+  }
+  std::ofstream result_file(m_options.m_dagSim_result_filename);
+  result_file << dagSim_result;
+}
+
+double HierarchicalSolver::compute_group_chi_0(const Process& process,
+                                               const Group& group) {
+  double chi_0 = 0.0;
+  for (const auto index_app : group) {
+    chi_0 += process.get_application_from_index(index_app)
+                 .get_machine_learning_model()
+                 .get_chi_0();
+  }
+  return chi_0;
+}
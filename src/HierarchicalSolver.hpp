@@ -0,0 +1,98 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__HIERARCHICAL_SOLVER__HPP
+#define __OPT_DEADLINE__HIERARCHICAL_SOLVER__HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+
+/*! Hierarchical decomposition of a large process.
+  The applications are partitioned into groups of similar ML models (sorted
+  by chi_c / chi_0, i.e. by scalability). Each group is aggregated into a
+  single hyperbolic model: with the optimal split inside the group its cost
+  is S^2 / (D - C0), where C0 is the sum of chi_0 and S the sum of
+  sqrt(weight * chi_c) of its applications. The total deadline is split
+  among the groups with these aggregated models, then every group is solved
+  as an independent process (in parallel) with the selected algorithms.
+  A coordination pass calibrates the aggregated models on the costs found,
+  splits the total deadline again and solves the groups once more; the new
+  solution is kept only if it is better.
+ */
+class HierarchicalSolver {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+  using Group = std::vector<unsigned>;
+
+  //! Solver of a process (the selected algorithms with the given options);
+  //! 'false' on failure
+  using SolveFunction =
+      std::function<bool(const SolverOptions& options, Process* process,
+                         std::ostream* log, std::ostream* result_log)>;
+
+  HierarchicalSolver(const SolverOptions& options, unsigned number_of_groups)
+      : m_options(options), m_number_of_groups(number_of_groups) {}
+
+  //! Solve the process group by group. The logs of the groups are written
+  //! one after the other once all the groups have been solved. Every group
+  //! writes the dagSim result file to a file of its own: the one of the
+  //! last group of the solution kept is copied to the result file at the
+  //! end.
+  bool process(const SolveFunction& solve, Process* process, std::ostream* log,
+               std::ostream* result_log) const;
+
+ private:
+  //! Below this relative change of every group deadline the coordination
+  //! pass is skipped
+  static constexpr double COORDINATION_TOLERANCE = 0.01;
+
+  SolverOptions m_options;
+  unsigned m_number_of_groups;
+
+  //! Groups of applications with similar ML models (of similar size)
+  std::vector<Group> partition(const Process& process) const;
+
+  //! Split the total deadline: each group gets the sum of its chi_0 plus a
+  //! share of the remaining deadline proportional to its 'scales'
+  static std::vector<TimeInstant> split_deadline(
+      const Process& process, const std::vector<Group>& groups,
+      const std::vector<double>& scales);
+
+  //! Solve the groups in parallel and copy the solutions into 'process'.
+  //! 'dagSim_result' is the dagSim result file written by the last group
+  //! (empty if none).
+  //! \return 'false' if the solver of a group failed
+  bool solve_groups(const SolveFunction& solve,
+                    const std::vector<Group>& groups,
+                    const std::vector<TimeInstant>& deadlines,
+                    Process* process, std::vector<double>* costs,
+                    std::string* dagSim_result, std::ostream* log,
+                    std::ostream* result_log) const;
+
+  //! Write the dagSim result file of the solution kept (if not empty)
+  void write_dagSim_result_file(const std::string& dagSim_result) const;
+
+  //! \return the sum of chi_0 of the applications of the group
+  static double compute_group_chi_0(const Process& process,
+                                    const Group& group);
+};
+
+#endif  // __OPT_DEADLINE__HIERARCHICAL_SOLVER__HPP
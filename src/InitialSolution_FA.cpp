@@ -17,8 +17,14 @@ limitations under the License.
 
 #include "InitialSolution_FA.hpp"
 #include <vector>
-
-void InitialSolution_FA::process(Process* process_to_init, std::ostream* log) {
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+template <typename PerformanceModel>
+void BasicInitialSolution_FA<PerformanceModel>::process(
+    Process* process_to_init, std::ostream* log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::INITIAL_SOLUTION_FA);
+  Tracer::ScopedSpan trace_span("InitialSolution_FA", "phase");
   *log << "InitialSolution_FA::process > Starting initialization\n";
 
   // Get the number of application in the process
@@ -31,6 +37,20 @@ void InitialSolution_FA::process(Process* process_to_init, std::ostream* log) {
   std::vector<TimeInstant> total_avg_per_app;
   total_avg_per_app.resize(number_of_applications, 0);
 
+  // The critical paths are comparable only if all the applications have one
+  bool use_critical_paths = m_estimators != nullptr;
+  for (unsigned index_app = 0;
+       use_critical_paths && index_app < number_of_applications; ++index_app) {
+    const auto& application =
+        process_to_init->get_application_from_index(index_app);
+    use_critical_paths =
+        m_estimators->find(application.get_profile()) != nullptr;
+  }
+  if (m_estimators != nullptr && use_critical_paths == false) {
+    *log << "\tCritical path not available for all the applications: using "
+            "the sum of the stage times\n";
+  }
+
   // For all applications in the process
   for (unsigned index_app = 0; index_app < number_of_applications;
        ++index_app) {
@@ -38,17 +58,21 @@ void InitialSolution_FA::process(Process* process_to_init, std::ostream* log) {
     const auto& application =
         process_to_init->get_application_from_index(index_app);
 
-    // Get all stages in the application
-    const auto& stages = application.get_all_stages();
-
     TimeInstant local_total_avg_this_app = 0;
-    // For all stages
-    for (const auto& pair_stage : stages) {
-      const auto& stage = pair_stage.second;
-      local_total_avg_this_app += stage.get_avg_time();
-      total_avg_all_apps += stage.get_avg_time();
-    }  // for all stages
-
+    if (use_critical_paths) {
+      local_total_avg_this_app = static_cast<TimeInstant>(
+          m_estimators->find(application.get_profile())
+              ->get_critical_path_time());
+      *log << "\tApp index (" << index_app
+           << ") critical path: " << local_total_avg_this_app << "\n";
+    } else {
+      // For all stages
+      for (const auto stage_avg_time : application.get_stage_avg_times()) {
+        local_total_avg_this_app += stage_avg_time;
+      }  // for all stages
+    }
+
+    total_avg_all_apps += local_total_avg_this_app;
     total_avg_per_app[index_app] = local_total_avg_this_app;
   }  // for all apps
 
@@ -74,19 +98,22 @@ void InitialSolution_FA::process(Process* process_to_init, std::ostream* log) {
 
     application.set_deadline(new_deadline);
   }  // for all apps
-  // Estimate n using D, chi_0 and chi_c
+  // Estimate n using D and the performance model
   for (unsigned index_app = 0; index_app < number_of_applications;
        ++index_app) {
     // Get index-app-th application
     auto& application =
         process_to_init->get_application_from_index_mod(index_app);
     TimeInstant deadline = application.get_deadline();
-    const auto mlm = application.get_machine_learning_model();
-    const auto chi_0 = mlm.get_chi_0();
-    const auto chi_c = mlm.get_chi_c();
-    const auto estimated_n = static_cast<unsigned int>(chi_c / (deadline - chi_0));
+    const auto estimated_n =
+        static_cast<unsigned int>(PerformanceModel::number_of_cores(
+            application.get_machine_learning_model(), deadline));
     application.set_number_of_core(estimated_n);
   }
 
   *log << "InitialSolution_FA::process > Initialization completed\n";
 }
+
+// The models available to the solvers
+template class BasicInitialSolution_FA<HyperbolicModel>;
+template class BasicInitialSolution_FA<LogOverheadModel<>>;
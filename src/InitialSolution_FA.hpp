@@ -17,13 +17,33 @@ limitations under the License.
 #ifndef __OPT_DEADLINE__INITIAL_SOLUTION_FA__HPP
 #define __OPT_DEADLINE__INITIAL_SOLUTION_FA__HPP
 
+#include <memory>
 #include <ostream>
+#include <utility>
+#include "CriticalPathEstimator.hpp"
+#include "PerformanceModel.hpp"
 #include "Process.hpp"
 
-class InitialSolution_FA {
+//! Initial deadlines proportional to the average execution times; the
+//! cores are estimated with the performance model 'PerformanceModel'
+template <typename PerformanceModel>
+class BasicInitialSolution_FA {
  public:
   using TimeInstant = opt_common::TimeInstant;
+
+  //! With the estimators (of all the applications) the execution time of an
+  //! application is its critical path, otherwise the sum of the average
+  //! times of its stages
+  explicit BasicInitialSolution_FA(
+      std::shared_ptr<const CriticalPathEstimators> estimators = nullptr)
+      : m_estimators(std::move(estimators)) {}
+
   void process(Process* process_to_init, std::ostream* log);
+
+ private:
+  std::shared_ptr<const CriticalPathEstimators> m_estimators;
 };
 
+using InitialSolution_FA = BasicInitialSolution_FA<DefaultPerformanceModel>;
+
 #endif  // __OPT_DEADLINE__INITIAL_SOLUTION_FA__HPP
@@ -15,10 +15,17 @@ limitations under the License.
 */
 
 #include "InitialSolution_SA.hpp"
+#include <algorithm>
 #include <cmath>
 #include <vector>
-
-void InitialSolution_SA::process(Process* process_to_init, std::ostream* log) {
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+template <typename PerformanceModel>
+void BasicInitialSolution_SA<PerformanceModel>::process(
+    Process* process_to_init, std::ostream* log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::INITIAL_SOLUTION_SA);
+  Tracer::ScopedSpan trace_span("InitialSolution_SA", "phase");
   *log << "InitialSolution_SA::process > Starting initialization\n";
 
   // The index of the app of comparisons
@@ -31,28 +38,39 @@ void InitialSolution_SA::process(Process* process_to_init, std::ostream* log) {
   // Are there enoght applications in the process?
   assert(number_of_applications > INDEX_APP_REF);
 
-  std::vector<double> alpha_apps;
-  alpha_apps.resize(number_of_applications);
-
   // Get reference application
   const auto& ref_application =
       process_to_init->get_application_from_index(INDEX_APP_REF);
 
-  // For all applications (computation of alphas)
-  for (unsigned index_app = 0; index_app < number_of_applications;
-       ++index_app) {
-    const auto& application =
-        process_to_init->get_application_from_index(index_app);
-
-    // Compute the alpha for that application
-    alpha_apps[index_app] =
-        index_app == INDEX_APP_REF
-            ? 1.0
-            : compute_alpha_app(application, ref_application);
-  }  // for all apps
-
-  // Computation n1
-  const double n1 = compute_n1(alpha_apps, *process_to_init);
+  // The alphas depend on n1, except with the hyperbolic model: they are
+  // computed for the n1 found with the previous ones, until they converge
+  std::vector<double> alpha_apps(number_of_applications, 1.0);
+  double n1 = 1.0;
+  for (unsigned k = 0; k < MAX_ALPHA_ITERATIONS; ++k) {
+    double max_change = 0.0;
+
+    // For all applications (computation of alphas)
+    for (unsigned index_app = 0; index_app < number_of_applications;
+         ++index_app) {
+      if (index_app == INDEX_APP_REF) {
+        continue;
+      }
+      const double alpha = compute_alpha_app(
+          process_to_init->get_application_from_index(index_app),
+          ref_application, n1);
+      if (std::isfinite(alpha) && alpha > 0.0) {
+        max_change = std::max(
+            max_change, std::abs(alpha - alpha_apps[index_app]) / alpha);
+        alpha_apps[index_app] = alpha;
+      }
+    }  // for all apps
+
+    // Computation n1
+    n1 = compute_n1(alpha_apps, *process_to_init);
+    if (max_change <= ALPHA_TOLERANCE || !(n1 > 0.0)) {
+      break;
+    }
+  }
 
   // For all applications (computation of initial deadline)
   for (unsigned index_app = 0; index_app < number_of_applications;
@@ -88,15 +106,37 @@ void InitialSolution_SA::process(Process* process_to_init, std::ostream* log) {
   *log << "InitialSolution_SA::process > Initialization completed\n";
 }
 
-double InitialSolution_SA::compute_alpha_app(
-    const Application& app, const Application& reference) const {
+template <typename PerformanceModel>
+double BasicInitialSolution_SA<PerformanceModel>::compute_alpha_app(
+    const Application& app, const Application& reference, double n1) const {
+  // At the optimum the marginal costs divided by the weights are equal
+  const double reference_cost =
+      -PerformanceModel::marginal_cost(reference.get_machine_learning_model(),
+                                       n1) /
+      reference.get_weight();
+  const double n_app = PerformanceModel::cores_for_marginal_cost(
+      app.get_machine_learning_model(), reference_cost * app.get_weight());
+  return n_app / n1;
+}
+
+// The closed formula of the first version of the algorithm: the alphas do
+// not depend on n1. Both the chi_c are the ones of the reference application,
+// as they have always been, so the results of the default build do not change;
+// build with -DOPT_DEADLINE_SA_APPLICATION_CHI_C for the chi_c of 'app'
+template <>
+double BasicInitialSolution_SA<HyperbolicModel>::compute_alpha_app(
+    const Application& app, const Application& reference, double) const {
   // Get weights applications
   const double w_r = reference.get_weight();
   const double w_a = app.get_weight();
 
   // Get MLM application
   const auto& mlm_r = reference.get_machine_learning_model();
+#ifdef OPT_DEADLINE_SA_APPLICATION_CHI_C
+  const auto& mlm_a = app.get_machine_learning_model();
+#else
   const auto& mlm_a = reference.get_machine_learning_model();
+#endif
 
   // Get Chi C
   const double chiC_r = mlm_r.get_chi_c();
@@ -105,8 +145,9 @@ double InitialSolution_SA::compute_alpha_app(
   return std::sqrt((w_r * chiC_a) / (w_a * chiC_r));
 }
 
-double InitialSolution_SA::compute_n1(const std::vector<double>& alpha_apps,
-                                      const Process& process) const {
+template <typename PerformanceModel>
+double BasicInitialSolution_SA<PerformanceModel>::compute_n1(
+    const std::vector<double>& alpha_apps, const Process& process) const {
   const auto number_of_applications = process.get_number_applications();
 
   double sum_chi_0 = 0.0;
@@ -127,23 +168,48 @@ double InitialSolution_SA::compute_n1(const std::vector<double>& alpha_apps,
     num += (chiC_app / alpha_apps.at(index_app));
   }  // for all apps
 
-  // return formula
-  return num / (process.get_total_deadline() - sum_chi_0);
+  // Formula of the hyperbolic model
+  double n1 = num / (process.get_total_deadline() - sum_chi_0);
+
+  // Newton on: sum_i time_i(alpha_i * n1) = total deadline
+  const double tolerance = N1_TOLERANCE * process.get_total_deadline();
+  for (unsigned k = 0; k < MAX_NEWTON_ITERATIONS && n1 > 0.0; ++k) {
+    double residual = -static_cast<double>(process.get_total_deadline());
+    double derivative = 0.0;
+    for (unsigned index_app = 0; index_app < number_of_applications;
+         ++index_app) {
+      const auto& mlm = process.get_application_from_index(index_app)
+                            .get_machine_learning_model();
+      const double alpha = alpha_apps.at(index_app);
+      residual += PerformanceModel::execution_time(mlm, alpha * n1);
+      derivative += alpha * PerformanceModel::marginal_cost(mlm, alpha * n1);
+    }
+    if (std::abs(residual) <= tolerance || derivative >= 0.0) {
+      break;
+    }
+    n1 -= residual / derivative;
+  }
+
+  return n1;
 }
 
-double InitialSolution_SA::compute_n_app(const unsigned index_app,
-                                         const std::vector<double>& alpha_apps,
-                                         const double n1) const {
+template <typename PerformanceModel>
+double BasicInitialSolution_SA<PerformanceModel>::compute_n_app(
+    const unsigned index_app, const std::vector<double>& alpha_apps,
+    const double n1) const {
   return alpha_apps.at(index_app) * n1;
 }
 
-auto InitialSolution_SA::compute_deadline_app(const Application& app,
-                                              double n) const -> TimeInstant {
-  const auto& mlm = app.get_machine_learning_model();
-  const double chi_0 = mlm.get_chi_0();
-  const double chi_c = mlm.get_chi_c();
-  const double deadline = chi_0 + chi_c / n;
+template <typename PerformanceModel>
+auto BasicInitialSolution_SA<PerformanceModel>::compute_deadline_app(
+    const Application& app, double n) const -> TimeInstant {
+  const double deadline =
+      PerformanceModel::execution_time(app.get_machine_learning_model(), n);
 
   // Convert into integer
   return static_cast<TimeInstant>(deadline);
 }
+
+// The models available to the solvers
+template class BasicInitialSolution_SA<HyperbolicModel>;
+template class BasicInitialSolution_SA<LogOverheadModel<>>;
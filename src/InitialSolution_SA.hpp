@@ -19,18 +19,28 @@ limitations under the License.
 
 #include <ostream>
 #include <vector>
+#include "PerformanceModel.hpp"
 #include "Process.hpp"
 
-class InitialSolution_SA {
+//! Initial deadlines of the applications with the performance model
+//! 'PerformanceModel' (see PerformanceModel.hpp)
+template <typename PerformanceModel>
+class BasicInitialSolution_SA {
  public:
-  using Application = opt_common::Application;
+  using Application = Process::Application;
   using TimeInstant = opt_common::TimeInstant;
   void process(Process* process_to_init, std::ostream* log);
 
  private:
+  //! \return the ratio between the cores of 'app' and of the reference
+  //! application at the optimum, when the reference one has n1 cores (the
+  //! closed formula of the first version with the hyperbolic model)
   double compute_alpha_app(const Application& app,
-                           const Application& reference) const;
+                           const Application& reference, double n1) const;
 
+  //! Number of cores of the reference application: the closed formula of
+  //! the hyperbolic model, refined with Newton (on the marginal costs) until
+  //! the deadlines of the performance model fill the total deadline
   double compute_n1(const std::vector<double>& alpha_apps,
                     const Process& process) const;
 
@@ -39,6 +49,17 @@ class InitialSolution_SA {
                        const double n1) const;
 
   TimeInstant compute_deadline_app(const Application& app, double n) const;
+
+  static constexpr unsigned MAX_NEWTON_ITERATIONS = 64;
+  static constexpr unsigned MAX_ALPHA_ITERATIONS = 32;
+
+  //! Relative change of the alphas below which they have converged
+  static constexpr double ALPHA_TOLERANCE = 1e-6;
+
+  //! Tolerance (relative to the total deadline) of the refinement of n1
+  static constexpr double N1_TOLERANCE = 1e-9;
 };
 
+using InitialSolution_SA = BasicInitialSolution_SA<DefaultPerformanceModel>;
+
 #endif  // __OPT_DEADLINE__INITIAL_SOLUTION_SA__HPP
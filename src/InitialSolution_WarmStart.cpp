@@ -0,0 +1,257 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "InitialSolution_WarmStart.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "PerformanceModel.hpp"
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+bool InitialSolution_WarmStart::initialize(const SolverOptions& options,
+                                          Process* process,
+                                          std::ostream* log,
+                                          std::ostream* result_log) {
+  if (options.has_warm_start() == false) {
+    return false;
+  }
+  InitialSolution_WarmStart initial_deadline_solution =
+      options.m_warm_start_allocation.empty()
+          ? InitialSolution_WarmStart(options.m_warm_start_filename)
+          : InitialSolution_WarmStart(options.m_warm_start_allocation,
+                                      options.m_warm_start_total_deadline);
+  initial_deadline_solution.process(process, log);
+
+  // Dump with initial solution
+  process->dump_process(result_log, "Input Solution WarmStart");
+  return true;
+}
+
+void InitialSolution_WarmStart::process(Process* process_to_init,
+                                        std::ostream* log) {
+  Statistics::ScopedPhase phase_timer(
+      Statistics::Phase::INITIAL_SOLUTION_WARM_START);
+  Tracer::ScopedSpan trace_span("InitialSolution_WarmStart", "phase");
+  if (m_result_filename.empty()) {
+    *log << "InitialSolution_WarmStart::process > Starting initialization "
+            "from a previous allocation\n";
+  } else {
+    *log << "InitialSolution_WarmStart::process > Starting initialization "
+         << "from '" << m_result_filename << "'\n";
+  }
+
+  // Get the number of application in the process
+  const auto number_of_applications =
+      process_to_init->get_number_applications();
+
+  TimeInstant previous_total_deadline = m_total_deadline;
+  const Allocation previous =
+      m_result_filename.empty()
+          ? m_allocation
+          : read_allocation(*process_to_init, &previous_total_deadline);
+  if (previous.size() != number_of_applications) {
+    THROW_RUNTIME_ERROR(
+        "Warm start: the allocation does not match the process");
+  }
+
+  // The deadlines of the applications are their execution times, whose sum
+  // is usually smaller than the total deadline: the sum is used only if the
+  // total deadline is unknown (result files of older versions)
+  if (previous_total_deadline <= 0) {
+    for (const auto& previous_application : previous) {
+      previous_total_deadline += previous_application.m_deadline;
+    }
+  }
+
+  if (previous_total_deadline <= 0) {
+    THROW_RUNTIME_ERROR(
+        "Warm start: the previous total deadline is zero");
+  }
+
+  // Scale factor: new total deadline / previous total deadline
+  const double scale_factor =
+      static_cast<double>(process_to_init->get_total_deadline()) /
+      previous_total_deadline;
+  const bool must_scale = std::abs(scale_factor - 1.0) > 1e-9;
+  *log << "\tScale factor of deadlines: " << scale_factor << "\n";
+
+  for (unsigned index_app = 0; index_app < number_of_applications;
+       ++index_app) {
+    auto& application =
+        process_to_init->get_application_from_index_mod(index_app);
+    const auto& previous_application = previous[index_app];
+    application.set_allocation(previous_application);
+
+    if (must_scale) {
+      const TimeInstant new_deadline = static_cast<TimeInstant>(
+          previous_application.m_deadline * scale_factor);
+      application.set_deadline(new_deadline);
+
+      // The previous simulation does not answer the scaled deadline
+      application.set_execution_time(0);
+
+      // Estimate n using D and the performance model; the previous number
+      // of cores is kept if the model cannot meet the new deadline
+      unsigned estimated_n = 0;
+      if (compute_cores(application, new_deadline, &estimated_n)) {
+        application.set_number_of_core(estimated_n);
+      } else {
+        *log << "\tApp index (" << index_app
+             << ") deadline not met by the ML model: keeping the previous "
+                "cores\n";
+      }
+    }
+
+    *log << "\tApp index (" << index_app
+         << ") setting initial deadline: " << application.get_deadline()
+         << "; cores: " << application.get_number_of_core() << "\n";
+  }  // for all apps
+
+  *log << "InitialSolution_WarmStart::process > Initialization completed\n";
+}
+
+bool InitialSolution_WarmStart::compute_cores(const Application& application,
+                                              double deadline,
+                                              unsigned* cores) {
+  static constexpr double MAX_CORES = 1e9;
+  const double real_cores = DefaultPerformanceModel::number_of_cores(
+      application.get_machine_learning_model(), deadline);
+  if (!(real_cores >= 1.0 && real_cores < MAX_CORES)) {
+    return false;
+  }
+  *cores = static_cast<unsigned>(real_cores);
+  return true;
+}
+
+Allocation InitialSolution_WarmStart::read_allocation(
+    const Process& process, TimeInstant* total_deadline) const {
+  auto dumped_applications = read_last_dump(total_deadline);
+
+  Allocation allocation(process.get_number_applications());
+  for (unsigned index_app = 0; index_app < allocation.size(); ++index_app) {
+    auto& dumped =
+        match_application(process.get_application_from_index(index_app),
+                          index_app, &dumped_applications);
+    dumped.m_used = true;
+    allocation[index_app] = {dumped.m_deadline, dumped.m_number_of_cores,
+                             dumped.m_execution_time};
+  }
+  return allocation;
+}
+
+auto InitialSolution_WarmStart::read_last_dump(
+    TimeInstant* total_deadline) const -> std::vector<DumpedApplication> {
+  static constexpr const char* BEGIN_DUMP = "----DUMP PROCESS----";
+  static constexpr const char* END_DUMP = "----END DUMP----";
+  static constexpr const char* ID_FIELD = "Application ID: ";
+  static constexpr const char* CORES_FIELD = "No. Cores: ";
+  static constexpr const char* DEADLINE_FIELD = "Deadline: ";
+  static constexpr const char* EXECUTION_TIME_FIELD = "Execution time: ";
+  static constexpr const char* TOTAL_DEADLINE_FIELD = "Total deadline: ";
+
+  std::ifstream file(m_result_filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Impossible open the file '" + m_result_filename +
+                        "'");
+  }
+
+  std::vector<DumpedApplication> last_dump;
+  std::vector<DumpedApplication> current_dump;
+  TimeInstant current_total_deadline = 0;
+  bool inside_dump = false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line == BEGIN_DUMP) {
+      current_dump.clear();
+      current_total_deadline = 0;
+      inside_dump = true;
+    } else if (line == END_DUMP) {
+      if (inside_dump) {
+        last_dump = std::move(current_dump);
+        *total_deadline = current_total_deadline;
+      }
+      inside_dump = false;
+    } else if (inside_dump &&
+               line.compare(0, std::strlen(TOTAL_DEADLINE_FIELD),
+                            TOTAL_DEADLINE_FIELD) == 0) {
+      current_total_deadline = static_cast<TimeInstant>(
+          std::stold(line.substr(std::strlen(TOTAL_DEADLINE_FIELD))));
+    } else if (inside_dump && line.compare(0, std::strlen(ID_FIELD),
+                                           ID_FIELD) == 0) {
+      // Application ID: ID; Weight: W; No. Cores: N; Deadline: D
+      // [; Execution time: E]
+      const auto id_begin = std::strlen(ID_FIELD);
+      const auto id_end = line.find(';', id_begin);
+      const auto cores_index = line.find(CORES_FIELD);
+      const auto deadline_index = line.find(DEADLINE_FIELD);
+      if (id_end == std::string::npos || cores_index == std::string::npos ||
+          deadline_index == std::string::npos) {
+        THROW_RUNTIME_ERROR("Warm start: bad-formed line '" + line + "'");
+      }
+
+      DumpedApplication dumped;
+      dumped.m_application_id = line.substr(id_begin, id_end - id_begin);
+      dumped.m_number_of_cores =
+          std::stoul(line.substr(cores_index + std::strlen(CORES_FIELD)));
+      dumped.m_deadline = static_cast<TimeInstant>(std::stold(
+          line.substr(deadline_index + std::strlen(DEADLINE_FIELD))));
+      const auto execution_time_index = line.find(EXECUTION_TIME_FIELD);
+      dumped.m_execution_time =
+          execution_time_index == std::string::npos
+              ? 0
+              : static_cast<TimeInstant>(std::stold(line.substr(
+                    execution_time_index + std::strlen(EXECUTION_TIME_FIELD))));
+      dumped.m_used = false;
+      current_dump.push_back(std::move(dumped));
+    }
+  }
+
+  if (last_dump.empty()) {
+    THROW_RUNTIME_ERROR("Warm start: no process dump found in '" +
+                        m_result_filename + "'");
+  }
+
+  return last_dump;
+}
+
+auto InitialSolution_WarmStart::match_application(
+    const Application& application, unsigned index_app,
+    std::vector<DumpedApplication>* dumped_applications) const
+    -> DumpedApplication& {
+  const auto& id = application.get_application_id();
+
+  // Same position (the process has not been changed)
+  if (index_app < dumped_applications->size()) {
+    auto& dumped = dumped_applications->at(index_app);
+    if (dumped.m_used == false && dumped.m_application_id == id) {
+      return dumped;
+    }
+  }
+
+  // Otherwise the first unused application with the same ID
+  for (auto& dumped : *dumped_applications) {
+    if (dumped.m_used == false && dumped.m_application_id == id) {
+      return dumped;
+    }
+  }
+
+  THROW_RUNTIME_ERROR("Warm start: application '" + id +
+                      "' not found in the file '" + m_result_filename + "'");
+}
@@ -0,0 +1,92 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__INITIAL_SOLUTION_WARM_START__HPP
+#define __OPT_DEADLINE__INITIAL_SOLUTION_WARM_START__HPP
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Allocation.hpp"
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+
+/*! Initial solution read from the result file of a previous run, or
+  taken from an allocation of the same process found before.
+  The last dump of the process in the file (or the allocation) provides
+  deadline and number of cores of each application. If the previous total
+  deadline differs from the one of the process, the deadlines are scaled
+  proportionally and the number of cores is re-estimated with the ML model
+  (the previous one is kept if the model cannot meet the scaled deadline).
+  Otherwise the execution times simulated by dagSim are kept too, so that
+  FineGrain does not evaluate the applications again.
+ */
+class InitialSolution_WarmStart {
+ public:
+  using Application = Process::Application;
+  using TimeInstant = opt_common::TimeInstant;
+
+  explicit InitialSolution_WarmStart(const std::string& result_filename)
+      : m_result_filename(result_filename) {}
+
+  InitialSolution_WarmStart(Allocation allocation, TimeInstant total_deadline)
+      : m_allocation(std::move(allocation)), m_total_deadline(total_deadline) {}
+
+  void process(Process* process_to_init, std::ostream* log);
+
+  /*! Initialize the process from the warm start of 'options' (the result
+    file or the allocation) and dump it into 'result_log'
+    \return 'false' (and nothing is done) if 'options' has no warm start
+   */
+  static bool initialize(const SolverOptions& options, Process* process,
+                         std::ostream* log, std::ostream* result_log);
+
+ private:
+  //! An application as it has been dumped in the result file
+  struct DumpedApplication {
+    std::string m_application_id;
+    TimeInstant m_deadline;
+    unsigned m_number_of_cores;
+    TimeInstant m_execution_time;
+    bool m_used;
+  };
+
+  std::string m_result_filename;  // Empty if the allocation is given
+  Allocation m_allocation;
+  TimeInstant m_total_deadline = 0;  // Of the process of the allocation
+
+  //! Number of cores of the ML model for the deadline
+  //! \return 'false' if the model cannot meet the deadline
+  static bool compute_cores(const Application& application, double deadline,
+                            unsigned* cores);
+
+  //! \return the allocation of the process in the last complete dump of
+  //! the result file (and its total deadline, zero if not dumped)
+  Allocation read_allocation(const Process& process,
+                             TimeInstant* total_deadline) const;
+
+  //! \return the applications in the last complete dump of the result file
+  std::vector<DumpedApplication> read_last_dump(
+      TimeInstant* total_deadline) const;
+
+  //! \return the dumped application matching the application index_app
+  DumpedApplication& match_application(
+      const Application& application, unsigned index_app,
+      std::vector<DumpedApplication>* dumped_applications) const;
+};
+
+#endif  // __OPT_DEADLINE__INITIAL_SOLUTION_WARM_START__HPP
@@ -0,0 +1,294 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "MultiStartSearch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <utility>
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+template <typename PerformanceModel>
+bool BasicMultiStartSearch<PerformanceModel>::compute_cores(
+    const Process::Application& application, double deadline,
+    unsigned* cores) {
+  static constexpr double MAX_CORES = 1e9;
+  const double real_cores = PerformanceModel::number_of_cores(
+      application.get_machine_learning_model(), deadline);
+  if (!(real_cores >= 1.0 && real_cores < MAX_CORES)) {
+    return false;
+  }
+  *cores = static_cast<unsigned>(real_cores);
+  return true;
+}
+
+template <typename PerformanceModel>
+void BasicMultiStartSearch<PerformanceModel>::process(
+    Process* process, std::ostream* log, std::ostream* result_log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::MULTI_START_SEARCH);
+  Tracer::ScopedSpan trace_span("MultiStartSearch", "phase");
+  *log << "MultiStartSearch::process > Starting process\n";
+
+  const unsigned number_of_applications = process->get_number_applications();
+  if (number_of_applications == 0) {
+    THROW_RUNTIME_ERROR("MultiStartSearch: no applications to process");
+  }
+
+  // The allocation of the process is the first start
+  const Allocation start = initial_allocation(*process, log);
+  *log << "\t> Initial cost: " << start.m_cost << '\n';
+
+  // A thread for each core, each one with its own start
+  const unsigned number_of_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  std::vector<Allocation> results(number_of_threads);
+  std::vector<std::uint64_t> num_moves(number_of_threads, 0);
+  std::vector<std::uint64_t> num_accepted(number_of_threads, 0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < number_of_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      results[t] =
+          search(*process, start, t, &num_moves[t], &num_accepted[t]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Reduce to the best allocation
+  for (unsigned t = 0; t < number_of_threads; ++t) {
+    *log << "\t> Thread " << t << ": best cost " << results[t].m_cost << " ("
+         << num_moves[t] << " moves, " << num_accepted[t] << " accepted)\n";
+    Statistics::instance().increment(
+        Statistics::Counter::MULTI_START_SEARCH_MOVES, num_moves[t]);
+    Statistics::instance().increment(
+        Statistics::Counter::MULTI_START_SEARCH_ACCEPTED_MOVES,
+        num_accepted[t]);
+  }
+  const auto& best = *std::min_element(
+      results.cbegin(), results.cend(),
+      [](const Allocation& a1, const Allocation& a2) {
+        return a1.m_cost < a2.m_cost;
+      });
+
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    auto& application = process->get_application_from_index_mod(i);
+    const auto deadline = static_cast<TimeInstant>(best.m_deadlines[i]);
+    unsigned cores = best.m_cores[i];
+    compute_cores(application, deadline, &cores);
+    application.set_deadline(deadline);
+    application.set_number_of_core(cores);
+  }
+
+  *log << "\t> [Current Result] Global Objective Function: "
+       << process->compute_global_objective_function()
+       << "; MultiStartSearch\n";
+  const double lower_bound = process->compute_objective_lower_bound();
+  *log << "\t> Lower Bound: " << lower_bound << "; Gap: "
+       << 100.0 * process->compute_relative_gap(lower_bound) << "%\n";
+  process->dump_process(result_log, "MultiStartSearch");
+  m_options.report_progress(*process, "MultiStartSearch");
+
+  *log << "MultiStartSearch::process > End process\n";
+}
+
+template <typename PerformanceModel>
+auto BasicMultiStartSearch<PerformanceModel>::initial_allocation(
+    const Process& process, std::ostream* log) -> Allocation {
+  const unsigned number_of_applications = process.get_number_applications();
+  Allocation allocation{std::vector<double>(number_of_applications),
+                        std::vector<unsigned>(number_of_applications, 0),
+                        0.0};
+  std::vector<double> chi_0(number_of_applications);
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    const auto& application = process.get_application_from_index(i);
+    allocation.m_deadlines[i] = application.get_deadline();
+    chi_0[i] = application.get_machine_learning_model().get_chi_0();
+    compute_cores(application, allocation.m_deadlines[i],
+                  &allocation.m_cores[i]);
+  }
+
+  // The infeasible applications take half of the slack of the feasible
+  // application with the largest one, until their deadline can be met
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    const auto& application = process.get_application_from_index(i);
+    for (unsigned k = 0;
+         allocation.m_cores[i] == 0 && k < MAX_REPAIR_MOVES; ++k) {
+      unsigned donor = i;
+      double donor_slack = 0.0;
+      for (unsigned j = 0; j < number_of_applications; ++j) {
+        const double slack = allocation.m_deadlines[j] - chi_0[j];
+        if (allocation.m_cores[j] > 0 && slack > donor_slack) {
+          donor = j;
+          donor_slack = slack;
+        }
+      }
+      unsigned donor_cores;
+      if (donor == i ||
+          compute_cores(process.get_application_from_index(donor),
+                        allocation.m_deadlines[donor] - donor_slack / 2,
+                        &donor_cores) == false) {
+        break;
+      }
+      allocation.m_deadlines[donor] -= donor_slack / 2;
+      allocation.m_cores[donor] = donor_cores;
+      allocation.m_deadlines[i] += donor_slack / 2;
+      compute_cores(application, allocation.m_deadlines[i],
+                    &allocation.m_cores[i]);
+    }
+    if (allocation.m_cores[i] == 0) {
+      THROW_RUNTIME_ERROR("MultiStartSearch: the deadline of application '" +
+                          application.get_application_id() +
+                          "' cannot be met");
+    }
+    if (allocation.m_deadlines[i] != application.get_deadline()) {
+      *log << "\t> Deadline of application '"
+           << application.get_application_id() << "' moved to "
+           << allocation.m_deadlines[i] << '\n';
+    }
+  }
+
+  for (unsigned i = 0; i < number_of_applications; ++i) {
+    allocation.m_cost += process.get_application_from_index(i).get_weight() *
+                         allocation.m_cores[i];
+  }
+  return allocation;
+}
+
+template <typename PerformanceModel>
+auto BasicMultiStartSearch<PerformanceModel>::search(
+    const Process& process, Allocation current, unsigned thread_index,
+    std::uint64_t* num_moves, std::uint64_t* num_accepted) const
+    -> Allocation {
+  const unsigned number_of_applications = process.get_number_applications();
+  if (number_of_applications < 2) {
+    return current;
+  }
+
+  // The random stream of this thread
+  std::seed_seq seed{SEED, static_cast<std::uint64_t>(thread_index)};
+  std::mt19937_64 rnd_engine(seed);
+  std::uniform_real_distribution<double> rnd_uniform(0.0, 1.0);
+  std::uniform_int_distribution<unsigned> rnd_application(
+      0, number_of_applications - 1);
+
+  // A move of a fraction of the slack of 'm_from' to 'm_to'
+  struct Move {
+    unsigned m_from;
+    unsigned m_to;
+    double m_delta_deadline;
+    unsigned m_cores_from;
+    unsigned m_cores_to;
+    double m_delta_cost;
+  };
+  Move move;
+  const auto propose = [&](const Allocation& allocation, double step) {
+    move.m_from = rnd_application(rnd_engine);
+    move.m_to = rnd_application(rnd_engine);
+    if (move.m_from == move.m_to) {
+      return false;
+    }
+    const auto& app_from = process.get_application_from_index(move.m_from);
+    const auto& app_to = process.get_application_from_index(move.m_to);
+    const double slack = allocation.m_deadlines[move.m_from] -
+                         app_from.get_machine_learning_model().get_chi_0();
+    move.m_delta_deadline = slack * step * rnd_uniform(rnd_engine);
+    if (slack <= 0.0 ||
+        compute_cores(app_from,
+                      allocation.m_deadlines[move.m_from] -
+                          move.m_delta_deadline,
+                      &move.m_cores_from) == false ||
+        compute_cores(app_to,
+                      allocation.m_deadlines[move.m_to] +
+                          move.m_delta_deadline,
+                      &move.m_cores_to) == false) {
+      return false;
+    }
+    move.m_delta_cost =
+        app_from.get_weight() *
+            (static_cast<double>(move.m_cores_from) -
+             allocation.m_cores[move.m_from]) +
+        app_to.get_weight() * (static_cast<double>(move.m_cores_to) -
+                               allocation.m_cores[move.m_to]);
+    return true;
+  };
+  const auto apply = [&move](Allocation* allocation) {
+    allocation->m_deadlines[move.m_from] -= move.m_delta_deadline;
+    allocation->m_deadlines[move.m_to] += move.m_delta_deadline;
+    allocation->m_cores[move.m_from] = move.m_cores_from;
+    allocation->m_cores[move.m_to] = move.m_cores_to;
+    allocation->m_cost += move.m_delta_cost;
+  };
+
+  // Perturbed start (the first thread starts from the process)
+  for (unsigned k = 0;
+       thread_index > 0 && k < PERTURBATION_MOVES * number_of_applications;
+       ++k) {
+    if (propose(current, INITIAL_STEP)) {
+      apply(&current);
+    }
+  }
+
+  // Initial temperature: the mean increase of the cost of random moves
+  double sum_increases = 0.0;
+  unsigned num_increases = 0;
+  for (unsigned k = 0; k < TEMPERATURE_SAMPLES; ++k) {
+    if (propose(current, INITIAL_STEP) && move.m_delta_cost > 0.0) {
+      sum_increases += move.m_delta_cost;
+      ++num_increases;
+    }
+  }
+  const double initial_temperature =
+      num_increases > 0 ? sum_increases / num_increases : 1.0;
+
+  Allocation best = current;
+  const auto start_time = std::chrono::steady_clock::now();
+  double progress = 0.0;  // Elapsed time / time limit
+  while (progress < 1.0 &&
+         m_options.m_stop_condition->stop_requested() == false) {
+    const double temperature =
+        initial_temperature * std::pow(FINAL_TEMPERATURE_RATIO, progress);
+    const double step =
+        INITIAL_STEP * std::pow(FINAL_STEP / INITIAL_STEP, progress);
+    for (unsigned k = 0; k < MOVES_PER_CHECK; ++k) {
+      ++*num_moves;
+      if (propose(current, step) &&
+          (move.m_delta_cost <= 0.0 ||
+           rnd_uniform(rnd_engine) <
+               std::exp(-move.m_delta_cost / temperature))) {
+        apply(&current);
+        ++*num_accepted;
+        if (current.m_cost < best.m_cost) {
+          best = current;
+        }
+      }
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    progress = elapsed.count() / m_options.m_search_time_limit;
+  }
+
+  return best;
+}
+
+// The models available to the solvers
+template class BasicMultiStartSearch<HyperbolicModel>;
+template class BasicMultiStartSearch<LogOverheadModel<>>;
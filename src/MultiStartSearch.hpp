@@ -0,0 +1,99 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__MULTI_START_SEARCH__HPP
+#define __OPT_DEADLINE__MULTI_START_SEARCH__HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "PerformanceModel.hpp"
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+
+/*! Parallel multi-start simulated annealing on the objective of the ML
+  model (sum of weight * cores, the cores of an application given by
+  'PerformanceModel' for its deadline).
+  Each thread has its own random stream and its own copy of the allocation:
+  the first one starts from the allocation of the process, the others from
+  a random perturbation of it. A move shifts a random fraction of the slack
+  of an application (its deadline minus chi_0) to another one; worse moves
+  are accepted with probability exp(-delta / T), with the temperature
+  decreasing geometrically with the elapsed time. When the time limit
+  expires the best allocation of all the threads is applied to the process.
+ */
+template <typename PerformanceModel>
+class BasicMultiStartSearch {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+
+  explicit BasicMultiStartSearch(const SolverOptions& options)
+      : m_options(options) {}
+
+  void process(Process* process, std::ostream* log, std::ostream* result_log);
+
+ private:
+  //! Final temperature, relative to the initial one
+  static constexpr double FINAL_TEMPERATURE_RATIO = 1e-4;
+
+  //! Fraction of the slack moved at most at the beginning (and at the end)
+  static constexpr double INITIAL_STEP = 0.5;
+  static constexpr double FINAL_STEP = 0.005;
+
+  //! Moves between two checks of the time limit
+  static constexpr unsigned MOVES_PER_CHECK = 256;
+
+  //! Random moves which estimate the initial temperature
+  static constexpr unsigned TEMPERATURE_SAMPLES = 100;
+
+  //! Random moves (per application) of the perturbed starts
+  static constexpr unsigned PERTURBATION_MOVES = 10;
+
+  //! Moves of deadline (per application) which repair the initial solution
+  static constexpr unsigned MAX_REPAIR_MOVES = 64;
+
+  static constexpr std::uint64_t SEED = 20170601;
+
+  SolverOptions m_options;
+
+  //! An allocation of the deadline (private to a thread)
+  struct Allocation {
+    std::vector<double> m_deadlines;
+    std::vector<unsigned> m_cores;
+    double m_cost;
+  };
+
+  //! \return 'false' if the deadline cannot be met (or it needs no core)
+  static bool compute_cores(const Process::Application& application,
+                            double deadline, unsigned* cores);
+
+  /*! \return the allocation of the process. The applications whose deadline
+    cannot be met take deadline from the others (half of the largest slack
+    at a time) and the changed deadlines are logged.
+   */
+  static Allocation initial_allocation(const Process& process,
+                                       std::ostream* log);
+
+  //! Run the annealing from 'start' until the time limit
+  Allocation search(const Process& process, Allocation start,
+                    unsigned thread_index, std::uint64_t* num_moves,
+                    std::uint64_t* num_accepted) const;
+};
+
+using MultiStartSearch = BasicMultiStartSearch<DefaultPerformanceModel>;
+
+#endif  // __OPT_DEADLINE__MULTI_START_SEARCH__HPP
@@ -0,0 +1,166 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "OptDeadlineSolver.hpp"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include "Algorithm1.hpp"
+#include "Algorithm2.hpp"
+#include "Algorithm3.hpp"
+#include "Statistics.hpp"
+#include "StopCondition.hpp"
+#include "Tracer.hpp"
+
+OptDeadlineSolver::OptDeadlineSolver(const std::string& config_filename,
+                                     SolverOptions options)
+    : m_config_filename(config_filename), m_options(std::move(options)) {
+  m_configuration.read_configuration_from_file(config_filename);
+  if (m_options.m_stop_condition &&
+      m_options.m_stop_condition->has_time_budget()) {
+    m_time_budget = m_options.m_stop_condition->get_time_budget();
+  }
+  m_options.m_dagSim_result_filename.clear();
+  m_options.m_checkpoint_filename.clear();
+  m_options.m_resume = false;
+}
+
+auto OptDeadlineSolver::solve(const ProcessDescription& description,
+                              AlgorithmSelection algorithms, std::ostream* log,
+                              std::ostream* result_log) const -> Result {
+  std::ostream discarded_log(nullptr);
+  if (log == nullptr) {
+    log = &discarded_log;
+  }
+  if (result_log == nullptr) {
+    result_log = &discarded_log;
+  }
+
+  // Without a registry in the options, each solve has its own: the files
+  // and the evaluations may change between two solves
+  SolverOptions options = m_options;
+  if (!options.m_application_registry) {
+    options.m_application_registry = std::make_shared<ApplicationRegistry>();
+  }
+
+  Process process = Process::create_empty_process(
+      m_config_filename, description.m_total_deadline);
+  {
+    Statistics::ScopedPhase phase_timer(Statistics::Phase::CSV_LOADING);
+    Tracer::ScopedSpan trace_span("CSVLoading", "phase");
+    for (const auto& application : description.m_applications) {
+      process.push_application(application.m_files, application.m_weight,
+                               options.m_application_registry.get());
+    }
+  }
+
+  // A new stop condition: cancel() stops only the running solves
+  options.m_stop_condition = std::make_shared<StopCondition>();
+  if (m_time_budget > 0.0) {
+    options.m_stop_condition->set_time_budget(m_time_budget);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_running_mutex);
+    m_running_stops.push_back(options.m_stop_condition);
+  }
+  const auto remove_running_stop = [this, &options]() {
+    std::lock_guard<std::mutex> lock(m_running_mutex);
+    m_running_stops.erase(std::find(m_running_stops.begin(),
+                                    m_running_stops.end(),
+                                    options.m_stop_condition));
+  };
+
+  if (m_progress_callback) {
+    options.m_progress_callback = [this](const Process& process_solved,
+                                         const std::string& stage) {
+      m_progress_callback(stage, make_result(process_solved, false));
+    };
+  }
+
+  bool status_algorithm = false;
+  try {
+    status_algorithm = run_algorithms(algorithms, m_configuration, options,
+                                      &process, log, result_log);
+  } catch (...) {
+    remove_running_stop();
+    throw;
+  }
+  remove_running_stop();
+  if (status_algorithm == false) {
+    THROW_RUNTIME_ERROR("OptDeadlineSolver: the algorithms have failed");
+  }
+  return make_result(process,
+                     options.m_stop_condition->stop_requested() == false);
+}
+
+void OptDeadlineSolver::cancel() {
+  std::lock_guard<std::mutex> lock(m_running_mutex);
+  for (const auto& stop_condition : m_running_stops) {
+    stop_condition->request_stop();
+  }
+}
+
+bool OptDeadlineSolver::run_algorithms(AlgorithmSelection algorithms,
+                                       const Configuration& configuration,
+                                       const SolverOptions& options,
+                                       Process* process, std::ostream* log,
+                                       std::ostream* result_log) {
+  bool status_algorithm = false;
+  switch (algorithms) {
+    case AlgorithmSelection::ALGORITHM_1:
+      Algorithm1 algorithm1;
+      status_algorithm =
+          algorithm1.process(configuration, options, process, log, result_log);
+      break;
+    case AlgorithmSelection::ALGORITHM_2:
+      Algorithm2 algorithm2;
+      status_algorithm =
+          algorithm2.process(configuration, options, process, log, result_log);
+      break;
+    case AlgorithmSelection::ALGORITHM_3:
+      Algorithm3 algorithm3;
+      status_algorithm =
+          algorithm3.process(configuration, options, process, log, result_log);
+      break;
+    case AlgorithmSelection::ALGORITHM_12:
+      Algorithm1 algorithm1_2;
+      Algorithm2 algorithm2_2;
+      status_algorithm = algorithm1_2.process(configuration, options, process,
+                                              log, result_log);
+      if (status_algorithm == true) {
+        status_algorithm = algorithm2_2.process(configuration, options,
+                                                process, log, result_log);
+      }
+      break;
+    default:
+      *log << "Algorithm type not recognized\n";
+  }
+  return status_algorithm;
+}
+
+auto OptDeadlineSolver::make_result(const Process& process, bool completed)
+    -> Result {
+  Result result{{}, process.compute_global_objective_function(), completed};
+  result.m_allocations.reserve(process.get_number_applications());
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    const auto& application = process.get_application_from_index(i);
+    result.m_allocations.push_back({application.get_application_id(),
+                                    application.get_deadline(),
+                                    application.get_number_of_core()});
+  }
+  return result;
+}
@@ -0,0 +1,145 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__OPT_DEADLINE_SOLVER__HPP
+#define __OPT_DEADLINE__OPT_DEADLINE_SOLVER__HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+#include "StopCondition.hpp"
+
+/*! Entry point of the library (libopt_deadline): it solves a process
+  described in memory and returns the allocation.
+  The solvers are reentrant: independent instances can solve concurrently on
+  different threads of the same program (each one with its own options and
+  temporary files). The run statistics and the trace are process-wide, so
+  they sum the solves of all the instances. Each solve has its own
+  application registry (each application is parsed once and identical
+  evaluations are resolved once), unless one is given with the options:
+  then it is shared by all the solves of the instance.
+
+  \code
+  OptDeadlineSolver solver("config.txt");
+  solver.set_progress_callback(
+      [](const std::string& stage, const OptDeadlineSolver::Result& result) {
+        std::cout << stage << ": " << result.m_objective << '\n';
+      });
+  const auto result = solver.solve(
+      description, OptDeadlineSolver::AlgorithmSelection::ALGORITHM_2);
+  \endcode
+ */
+class OptDeadlineSolver {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+  using Configuration = opt_common::Configuration;
+
+  enum class AlgorithmSelection {
+    ALGORITHM_1,
+    ALGORITHM_2,
+    ALGORITHM_3,
+    ALGORITHM_12
+  };
+
+  //! An application of the process (as a line of the process file)
+  struct ApplicationDescription {
+    Process::Application::FileResources m_files;
+    double m_weight;
+  };
+
+  struct ProcessDescription {
+    std::vector<ApplicationDescription> m_applications;
+    TimeInstant m_total_deadline;
+  };
+
+  //! The deadline and the cores of an application
+  struct ApplicationAllocation {
+    std::string m_application_id;
+    TimeInstant m_deadline;
+    unsigned m_cores;
+  };
+
+  struct Result {
+    std::vector<ApplicationAllocation> m_allocations;  // In process order
+    double m_objective;
+    bool m_completed;  // 'false' if the solve has been cancelled
+  };
+
+  //! Called with each new allocation found (and the algorithm which found
+  //! it) on the thread which runs 'solve'
+  using ProgressCallback =
+      std::function<void(const std::string& stage, const Result& result)>;
+
+  /*! \param config_filename  The configuration file (OPT_IC, dagSim and
+                              temporary directory)
+      \param options          The options of the algorithms. Each solve
+                              has a stop condition of its own, with the
+                              time budget of the one given (if any). The
+                              result file of dagSim and the checkpoints are
+                              not written.
+   */
+  explicit OptDeadlineSolver(const std::string& config_filename,
+                             SolverOptions options = SolverOptions());
+
+  void set_progress_callback(ProgressCallback progress_callback) {
+    m_progress_callback = std::move(progress_callback);
+  }
+
+  /*! Solve the process with the algorithms. It throws if the process cannot
+    be loaded or the algorithms fail.
+    \param [out] log         Where the log is written (discarded if null)
+    \param [out] result_log  Where the solutions are dumped, as in the result
+                             file of opt_deadline (discarded if null)
+    \return the best allocation found (partial if the solve is cancelled)
+   */
+  Result solve(const ProcessDescription& description,
+               AlgorithmSelection algorithms, std::ostream* log = nullptr,
+               std::ostream* result_log = nullptr) const;
+
+  //! Stop the running solves as soon as possible (the following ones are
+  //! not affected). It can be called from any thread.
+  void cancel();
+
+  //! Run the selected algorithms on the process
+  //! \return 'false' if they have failed (the error is in the log)
+  static bool run_algorithms(AlgorithmSelection algorithms,
+                             const Configuration& configuration,
+                             const SolverOptions& options, Process* process,
+                             std::ostream* log, std::ostream* result_log);
+
+ private:
+  std::string m_config_filename;
+  Configuration m_configuration;
+  SolverOptions m_options;
+  ProgressCallback m_progress_callback;
+
+  //! The time budget of each solve (none if not positive)
+  double m_time_budget = 0.0;
+
+  //! The stop conditions of the running solves
+  mutable std::mutex m_running_mutex;
+  mutable std::vector<std::shared_ptr<StopCondition>> m_running_stops;
+
+  static Result make_result(const Process& process, bool completed);
+};
+
+#endif  // __OPT_DEADLINE__OPT_DEADLINE_SOLVER__HPP
@@ -0,0 +1,37 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__PENDING_COMMAND__HPP
+#define __OPT_DEADLINE__PENDING_COMMAND__HPP
+
+#include <string>
+
+/*! An external command (OPT_IC or dagSim) running asynchronously, either as
+  a local subprocess or on a remote worker.
+ */
+class PendingCommand {
+ public:
+  virtual ~PendingCommand() = default;
+
+  //! Wait the end of the command
+  //! \return the standard output of the command
+  virtual std::string wait() = 0;
+
+  //! Stop the command. It has no effect if the command is already terminated
+  virtual void cancel() noexcept = 0;
+};
+
+#endif  // __OPT_DEADLINE__PENDING_COMMAND__HPP
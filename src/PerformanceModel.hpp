@@ -0,0 +1,225 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__PERFORMANCE_MODEL__HPP
+#define __OPT_DEADLINE__PERFORMANCE_MODEL__HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ratio>
+#include <vector>
+#include "ApplicationProfile.hpp"
+
+/*! Performance models: the execution time of an application as a function
+  of its number of cores, given the parameters of its ML model.
+  A model is a policy (a class with static functions only) passed as a
+  template parameter to the solvers, so that its formulas are inlined into
+  their loops. A model provides:
+    - execution_time(mlm, n)    the execution time with 'n' cores
+    - number_of_cores(mlm, d)   the (real) number of cores which meets the
+                                deadline 'd'; <= 0 if 'd' cannot be met
+    - marginal_cost(mlm, n)     the derivative of the execution time with
+                                respect to the number of cores
+    - cores_for_marginal_cost(mlm, c)
+                                the number of cores whose marginal cost is
+                                '-c' (c > 0)
+    - relaxed_objective(terms, d)
+                                the minimum of sum(weight * n) with real
+                                cores and a total execution time 'd' (0 if
+                                'd' cannot be met)
+ */
+
+//! A term of the objective function: an application and its weight
+struct WeightedModel {
+  double m_weight;
+  const ApplicationProfile::MachineLearningModel* m_mlm;
+};
+
+//! time = chi_0 + chi_c / n
+struct HyperbolicModel {
+  using MachineLearningModel = ApplicationProfile::MachineLearningModel;
+
+  static double execution_time(const MachineLearningModel& mlm, double n) {
+    return mlm.get_chi_0() + mlm.get_chi_c() / n;
+  }
+
+  static double number_of_cores(const MachineLearningModel& mlm,
+                                double deadline) {
+    return mlm.get_chi_c() / (deadline - mlm.get_chi_0());
+  }
+
+  static double marginal_cost(const MachineLearningModel& mlm, double n) {
+    return -mlm.get_chi_c() / (n * n);
+  }
+
+  static double cores_for_marginal_cost(const MachineLearningModel& mlm,
+                                        double cost) {
+    return std::sqrt(mlm.get_chi_c() / cost);
+  }
+
+  //! With n = chi_c / (d - chi_0) the optimum of sum(w * n) under
+  //! sum(d) = D is (sum(sqrt(w * chi_c)))^2 / (D - sum(chi_0))
+  static double relaxed_objective(const std::vector<WeightedModel>& terms,
+                                  double deadline) {
+    double sum_chi_0 = 0.0;
+    double sum_sqrt = 0.0;
+    for (const auto& term : terms) {
+      sum_chi_0 += term.m_mlm->get_chi_0();
+      sum_sqrt += std::sqrt(term.m_weight * term.m_mlm->get_chi_c());
+    }
+    const double slack = deadline - sum_chi_0;
+    return slack > 0.0 ? sum_sqrt * sum_sqrt / slack : 0.0;
+  }
+};
+
+/*! time = chi_0 * (1 + r * log2(n)) + chi_c / n
+  Every doubling of the cores adds the fraction 'r' (the std::ratio
+  'Overhead') of the serial time chi_0 for coordination and shuffling.
+  The execution time has a minimum in n* = chi_c * ln(2) / (r * chi_0):
+  a deadline is met by the smallest number of cores (not beyond n*).
+ */
+template <typename Overhead = std::ratio<1, 100>>
+struct LogOverheadModel {
+  using MachineLearningModel = ApplicationProfile::MachineLearningModel;
+
+  static double execution_time(const MachineLearningModel& mlm, double n) {
+    return mlm.get_chi_0() * (1.0 + overhead() * std::log2(n)) +
+           mlm.get_chi_c() / n;
+  }
+
+  static double number_of_cores(const MachineLearningModel& mlm,
+                                double deadline) {
+    const double log_coefficient = mlm.get_chi_0() * overhead();
+    if (log_coefficient <= 0.0) {
+      return HyperbolicModel::number_of_cores(mlm, deadline);
+    }
+
+    const double best_n = mlm.get_chi_c() * std::log(2.0) / log_coefficient;
+    if (execution_time(mlm, best_n) > deadline) {
+      return 0.0;  // Not even the fastest configuration meets the deadline
+    }
+
+    // Start on the left of the solution (the hyperbolic estimate, if any)
+    double n = best_n;
+    if (deadline > mlm.get_chi_0()) {
+      n = std::min(n, HyperbolicModel::number_of_cores(mlm, deadline));
+    }
+    while (execution_time(mlm, n) < deadline) {
+      n /= 2.0;
+    }
+
+    // The time is convex and decreasing on (0, n*]: Newton converges
+    // monotonically from the left
+    for (unsigned k = 0; k < MAX_NEWTON_ITERATIONS; ++k) {
+      const double step =
+          (execution_time(mlm, n) - deadline) / marginal_cost(mlm, n);
+      n = std::min(n - step, best_n);
+      if (std::abs(step) <= n * std::numeric_limits<double>::epsilon()) {
+        break;
+      }
+    }
+    return n;
+  }
+
+  static double marginal_cost(const MachineLearningModel& mlm, double n) {
+    return mlm.get_chi_0() * overhead() / (n * std::log(2.0)) -
+           mlm.get_chi_c() / (n * n);
+  }
+
+  //! Positive root of cost * n^2 + (r * chi_0 / ln(2)) * n - chi_c = 0
+  static double cores_for_marginal_cost(const MachineLearningModel& mlm,
+                                        double cost) {
+    const double b = mlm.get_chi_0() * overhead() / std::log(2.0);
+    return 2.0 * mlm.get_chi_c() /
+           (b + std::sqrt(b * b + 4.0 * cost * mlm.get_chi_c()));
+  }
+
+  /*! At the optimum the marginal costs divided by the weights are equal
+    (-mu). The total time grows with mu: mu is bisected until the time is
+    'deadline', and the objective of the larger mu (the fewer cores) is
+    returned, so that it never exceeds the optimum.
+   */
+  static double relaxed_objective(const std::vector<WeightedModel>& terms,
+                                  double deadline) {
+    double objective = 0.0;
+    const auto total_time = [&terms, &objective](double mu) {
+      double time = 0.0;
+      objective = 0.0;
+      for (const auto& term : terms) {
+        if (term.m_weight <= 0.0 || term.m_mlm->get_chi_c() <= 0.0) {
+          time += term.m_mlm->get_chi_0();  // No cores are needed
+          continue;
+        }
+        const double n =
+            cores_for_marginal_cost(*term.m_mlm, mu * term.m_weight);
+        time += execution_time(*term.m_mlm, n);
+        objective += term.m_weight * n;
+      }
+      return time;
+    };
+
+    // Bracket the deadline: [mu_low, mu_high]
+    double mu_low = 1.0;
+    double mu_high = 1.0;
+    unsigned steps = 0;
+    while (total_time(mu_low) >= deadline) {
+      if (++steps > MAX_BRACKET_STEPS) {
+        return 0.0;  // Not even the fastest configurations meet it
+      }
+      mu_low /= 2.0;
+    }
+    for (steps = 0; total_time(mu_high) < deadline; mu_high *= 2.0) {
+      if (++steps > MAX_BRACKET_STEPS) {
+        return 0.0;
+      }
+    }
+
+    for (unsigned k = 0; k < MAX_BISECTION_ITERATIONS &&
+                         mu_high > mu_low * (1.0 + RELATIVE_TOLERANCE);
+         ++k) {
+      const double mu = std::sqrt(mu_low * mu_high);
+      if (total_time(mu) < deadline) {
+        mu_low = mu;
+      } else {
+        mu_high = mu;
+      }
+    }
+    total_time(mu_high);
+    return objective;
+  }
+
+ private:
+  static constexpr unsigned MAX_NEWTON_ITERATIONS = 64;
+  static constexpr unsigned MAX_BRACKET_STEPS = 1000;
+  static constexpr unsigned MAX_BISECTION_ITERATIONS = 200;
+  static constexpr double RELATIVE_TOLERANCE = 1e-12;
+
+  static constexpr double overhead() {
+    return static_cast<double>(Overhead::num) / Overhead::den;
+  }
+};
+
+//! The model used by the solvers (build with
+//! -DOPT_DEADLINE_LOG_OVERHEAD_MODEL for LogOverheadModel)
+#ifdef OPT_DEADLINE_LOG_OVERHEAD_MODEL
+using DefaultPerformanceModel = LogOverheadModel<>;
+#else
+using DefaultPerformanceModel = HyperbolicModel;
+#endif
+
+#endif  // __OPT_DEADLINE__PERFORMANCE_MODEL__HPP
@@ -17,7 +17,12 @@ limitations under the License.
 */
 
 #include "Process.hpp"
+#include "ApplicationRegistry.hpp"
+#include "PerformanceModel.hpp"
+#include "Statistics.hpp"
+#include "Tracer.hpp"
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -35,8 +40,122 @@ Process::Application& Process::get_application_from_index_mod(unsigned index) {
 }
 
 void Process::push_application(opt_common::Application app) {
-  app.set_alpha_beta(15, 10);
-  m_applications.push_back(std::move(app));
+  const double weight = app.get_weight();
+  const ApplicationAllocation allocation{app.get_deadline(),
+                                         app.get_number_of_core()};
+  m_applications.emplace_back(
+      ApplicationRegistry::create_profile(std::move(app)), weight, allocation);
+}
+
+void Process::push_application_from_line(const std::string& line,
+                                         ApplicationRegistry* registry) {
+  std::istringstream iss{line};
+  Application::FileResources resources_filename;
+  std::string weight_str;
+  iss >> resources_filename.m_Application_File;
+  iss >> resources_filename.m_Jobs_File;
+  iss >> resources_filename.m_Stages_File;
+  iss >> resources_filename.m_Tasks_File;
+  iss >> resources_filename.m_Lua_File;
+  iss >> resources_filename.m_Infrastructure_File;
+  iss >> weight_str;
+  if (iss.fail()) {
+    THROW_RUNTIME_ERROR("Bad-formed application line '" + line + "'");
+  }
+
+  push_application(resources_filename, std::stod(weight_str), registry);
+}
+
+void Process::push_application(
+    const Application::FileResources& resources_filename, double weight,
+    ApplicationRegistry* registry) {
+  if (registry != nullptr) {
+    m_applications.emplace_back(
+        registry->get_profile(resources_filename, m_config_namefile), weight);
+    return;
+  }
+
+  auto application = opt_common::Application::create_application(
+      resources_filename, m_config_namefile, "0");
+  application.set_weight(weight);
+
+  push_application(std::move(application));
+}
+
+unsigned Process::get_application_index(
+    const std::string& application_id) const {
+  const auto it = std::find_if(m_applications.cbegin(), m_applications.cend(),
+                               [&application_id](const Application& app) {
+                                 return app.get_application_id() ==
+                                        application_id;
+                               });
+  if (it == m_applications.cend()) {
+    THROW_RUNTIME_ERROR("Application '" + application_id +
+                        "' not found in the process");
+  }
+  return it - m_applications.cbegin();
+}
+
+void Process::remove_application(unsigned index) {
+  m_applications.erase(m_applications.begin() + index);
+}
+
+Process Process::create_subprocess(const std::vector<unsigned>& indices,
+                                   TimeInstant total_deadline) const {
+  Process subprocess;
+  subprocess.m_config_namefile = m_config_namefile;
+  subprocess.set_total_deadline(total_deadline);
+  subprocess.m_applications.reserve(indices.size());
+  for (const auto index : indices) {
+    subprocess.m_applications.push_back(m_applications.at(index));
+  }
+  return subprocess;
+}
+
+Allocation Process::get_allocation() const {
+  Allocation allocation;
+  allocation.reserve(m_applications.size());
+  for (const auto& app : m_applications) {
+    allocation.push_back(app.get_allocation());
+  }
+  return allocation;
+}
+
+void Process::set_allocation(const Allocation& allocation) {
+  if (allocation.size() != m_applications.size()) {
+    THROW_RUNTIME_ERROR("The allocation does not match the process");
+  }
+  for (std::size_t i = 0; i < allocation.size(); ++i) {
+    m_applications[i].set_allocation(allocation[i]);
+  }
+}
+
+double Process::compute_global_objective_function(
+    const Allocation& allocation) const {
+  if (allocation.size() != m_applications.size()) {
+    THROW_RUNTIME_ERROR("The allocation does not match the process");
+  }
+  double of = 0.0;
+  for (std::size_t i = 0; i < allocation.size(); ++i) {
+    of += m_applications[i].get_weight() * allocation[i].m_number_of_core;
+  }
+  return of;
+}
+
+double Process::compute_objective_lower_bound() const noexcept {
+  std::vector<WeightedModel> terms;
+  terms.reserve(m_applications.size());
+  double sum_weights = 0.0;
+  for (const auto& app : m_applications) {
+    terms.push_back({app.get_weight(), &app.get_machine_learning_model()});
+    sum_weights += app.get_weight();
+  }
+  const double relaxed_objective = DefaultPerformanceModel::relaxed_objective(
+      terms, static_cast<double>(m_total_deadline));
+  if (relaxed_objective <= 0.0) {
+    return 0.0;
+  }
+  return std::max(0.0, relaxed_objective - sum_weights);
 }
 
 Process::TimeInstant Process::compute_min_deadline() {
@@ -48,50 +167,51 @@ Process::TimeInstant Process::compute_min_deadline() {
 Process::TimeInstant Process::compute_total_real_time() const {
   TimeInstant sum = 0;
   for (const auto& app : m_applications) {
-    sum += app.compute_avg_execution_time();
+    sum += app.get_min_execution_time();
   }
   return sum;
 }
 
 void Process::set_cores_applications() {
   for (auto& app : m_applications) {
-    app.set_number_of_core(app.compute_max_number_of_task());
+    app.set_number_of_core(app.get_max_number_of_tasks());
   }
 }
 
+Process Process::create_empty_process(const std::string& config_namefile,
+                                      TimeInstant total_deadline_process) {
+  Process process;
+  process.m_config_namefile = config_namefile;
+  process.set_total_deadline(total_deadline_process);
+  return process;
+}
+
 Process Process::create_process(const std::string& data_input_namefile,
                                 const std::string& config_namefile,
-                                TimeInstant total_deadline_process) {
+                                TimeInstant total_deadline_process,
+                                ApplicationRegistry* registry) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::CSV_LOADING);
+  Tracer::ScopedSpan trace_span("CSVLoading", "phase");
+
   std::ifstream ifs{data_input_namefile};
   if (ifs.fail()) {
     THROW_RUNTIME_ERROR("Impossible open the file '" + data_input_namefile +
                         "'");
   }
 
-  Process process;
-  process.m_config_namefile = config_namefile;
-  process.set_total_deadline(total_deadline_process);
+  Process process =
+      create_empty_process(config_namefile, total_deadline_process);
+
+  ApplicationRegistry process_registry;
+  if (registry == nullptr) {
+    registry = &process_registry;
+  }
 
   std::string line;
   while (std::getline(ifs, line)) {
     // Skip empty line and if starts with dash
     if (line.empty() == false && line.at(0) != '#') {
-      std::istringstream iss{line};
-      Application::FileResources resources_filename;
-      std::string weight_str;
-      iss >> resources_filename.m_Application_File;
-      iss >> resources_filename.m_Jobs_File;
-      iss >> resources_filename.m_Stages_File;
-      iss >> resources_filename.m_Tasks_File;
-      iss >> resources_filename.m_Lua_File;
-      iss >> resources_filename.m_Infrastructure_File;
-      iss >> weight_str;
-
-      auto application = Application::create_application(resources_filename,
-                                                         config_namefile, "0");
-      application.set_weight(std::stod(weight_str));
-
-      process.push_application(std::move(application));
+      process.push_application_from_line(line, registry);
     }
   }
 
@@ -105,8 +225,16 @@ void Process::dump_process(std::ostream* out,
     *out << "Application ID: " << app.get_application_id() << "; "
          << "Weight: " << app.get_weight() << "; "
          << "No. Cores: " << app.get_number_of_core() << "; "
-         << "Deadline: " << app.get_deadline() << "\n";
+         << "Deadline: " << app.get_deadline();
+    // Read back by the warm start, which skips the simulation of the cores
+    if (app.get_execution_time() > 0) {
+      *out << "; Execution time: " << app.get_execution_time();
+    }
+    *out << "\n";
   }
+  // The warm start scales the deadlines against the total one (the lowercase
+  // label keeps it apart from the deadlines of the applications)
+  *out << "Total deadline: " << m_total_deadline << "\n";
   *out << "Objective Function: " << compute_global_objective_function() << "\n";
   *out << additional_message << "\n";
   *out << "----END DUMP----\n" << std::endl;
@@ -22,17 +22,34 @@ limitations under the License.
 #include <opt_common/Application.hpp>
 #include <opt_common/helper.hpp>
 #include <ostream>
+#include <vector>
+#include "Allocation.hpp"
+#include "ProcessApplication.hpp"
 
+class ApplicationRegistry;
+
+/*! A process: the applications, each one with its shared read-only profile
+  and its weight, and their allocation. Copying a process does not copy the
+  profiles; the allocation alone can be taken, changed and applied back to
+  explore candidate allocations.
+ */
 class Process {
  public:
-  using Application = opt_common::Application;
+  using Application = ProcessApplication;
   using TimeInstant = opt_common::TimeInstant;
 
   Process() = default;
 
+  //! The applications are taken from 'registry' (if null, each application
+  //! listed more than once in the file is parsed only once)
   static Process create_process(const std::string& data_input_namefile,
                                 const std::string& config_namefile,
-                                TimeInstant total_deadline_process);
+                                TimeInstant total_deadline_process,
+                                ApplicationRegistry* registry = nullptr);
+
+  //! \return a process without applications
+  static Process create_empty_process(const std::string& config_namefile,
+                                      TimeInstant total_deadline_process);
 
   void dump_process(std::ostream* out, const std::string& additional_message) const;
 
@@ -52,10 +69,38 @@ class Process {
     m_total_deadline = total_deadline;
   }
 
-  void push_application(Application app);
+  //! Add the application with its weight and allocation (its records are
+  //! dropped)
+  void push_application(opt_common::Application app);
+
+  //! Add the application described by its files and its weight (taken from
+  //! 'registry', if not null)
+  void push_application(const Application::FileResources& resources_filename,
+                        double weight, ApplicationRegistry* registry = nullptr);
+
+  //! Add the application described by a line of the data input file
+  //! (APP_CSV JOBS_CSV STAGES_CSV TASKS_CSV LUA_FILE CONFIG_INFR WEIGHT)
+  void push_application_from_line(const std::string& line,
+                                  ApplicationRegistry* registry = nullptr);
+
+  //! \return the index of the application. It throws if it does not exist
+  unsigned get_application_index(const std::string& application_id) const;
+
+  void remove_application(unsigned index);
+
+  //! \return a process with a copy of the applications of the given indices
+  //! (in that order) and the given total deadline
+  Process create_subprocess(const std::vector<unsigned>& indices,
+                            TimeInstant total_deadline) const;
 
   TimeInstant compute_min_deadline();
 
+  //! \return the deadline and the cores of each application
+  Allocation get_allocation() const;
+
+  //! Apply an allocation of this process (it throws if its size differs)
+  void set_allocation(const Allocation& allocation);
+
   const std::string& get_config_filename() const noexcept {
     return m_config_namefile;
   }
@@ -68,6 +113,22 @@ class Process {
     return of;
   }
 
+  //! \return the objective function of an allocation of this process
+  double compute_global_objective_function(const Allocation& allocation) const;
+
+  /*! \return a lower bound of the objective function: the optimum of its
+    continuous relaxation with the performance model of the solvers
+    (DefaultPerformanceModel), minus the sum of the weights since the
+    solvers truncate the cores. It is 0 if the total deadline cannot be met.
+   */
+  double compute_objective_lower_bound() const noexcept;
+
+  //! \return the relative gap between the objective function and the bound
+  double compute_relative_gap(double lower_bound) const noexcept {
+    const double of = compute_global_objective_function();
+    return of > 0.0 ? (of - lower_bound) / of : 0.0;
+  }
+
  private:
   std::vector<Application> m_applications;
   TimeInstant m_total_deadline = 0;
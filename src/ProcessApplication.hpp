@@ -0,0 +1,126 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__PROCESS_APPLICATION__HPP
+#define __OPT_DEADLINE__PROCESS_APPLICATION__HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Allocation.hpp"
+#include "ApplicationProfile.hpp"
+
+/*! An application of a process: its shared (read-only) profile, its weight
+  and its allocation. Copying it copies only a pointer and a few numbers.
+ */
+class ProcessApplication {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+  using FileResources = ApplicationProfile::FileResources;
+  using MachineLearningModel = ApplicationProfile::MachineLearningModel;
+  using InfrastructureConfig = ApplicationProfile::InfrastructureConfig;
+
+  ProcessApplication(std::shared_ptr<const ApplicationProfile> profile,
+                     double weight, ApplicationAllocation allocation = {})
+      : m_profile(std::move(profile)),
+        m_weight(weight),
+        m_allocation(allocation) {}
+
+  const ApplicationProfile& get_profile() const noexcept { return *m_profile; }
+
+  const std::shared_ptr<const ApplicationProfile>& get_shared_profile() const
+      noexcept {
+    return m_profile;
+  }
+
+  const std::string& get_application_id() const noexcept {
+    return m_profile->get_application_id();
+  }
+
+  const FileResources& get_files_resources() const noexcept {
+    return m_profile->get_files_resources();
+  }
+
+  const std::string& get_lua_name() const noexcept {
+    return m_profile->get_lua_name();
+  }
+
+  const MachineLearningModel& get_machine_learning_model() const noexcept {
+    return m_profile->get_machine_learning_model();
+  }
+
+  const InfrastructureConfig& get_infrastructure_config() const noexcept {
+    return m_profile->get_infrastructure_config();
+  }
+
+  const std::vector<TimeInstant>& get_stage_avg_times() const noexcept {
+    return m_profile->get_stage_avg_times();
+  }
+
+  unsigned get_max_number_of_tasks() const noexcept {
+    return m_profile->get_max_number_of_tasks();
+  }
+
+  TimeInstant get_min_execution_time() const noexcept {
+    return m_profile->get_min_execution_time();
+  }
+
+  double get_weight() const noexcept { return m_weight; }
+  void set_weight(double weight) noexcept { m_weight = weight; }
+
+  const ApplicationAllocation& get_allocation() const noexcept {
+    return m_allocation;
+  }
+  void set_allocation(const ApplicationAllocation& allocation) noexcept {
+    m_allocation = allocation;
+  }
+
+  TimeInstant get_deadline() const noexcept {
+    return m_allocation.m_deadline;
+  }
+  void set_deadline(TimeInstant deadline) noexcept {
+    m_allocation.m_deadline = deadline;
+  }
+
+  unsigned get_number_of_core() const noexcept {
+    return m_allocation.m_number_of_core;
+  }
+  void set_number_of_core(unsigned number_of_core) noexcept {
+    // The simulated execution time refers to the previous cores
+    if (number_of_core != m_allocation.m_number_of_core) {
+      m_allocation.m_execution_time = 0;
+    }
+    m_allocation.m_number_of_core = number_of_core;
+  }
+
+  //! \return the execution time simulated by dagSim with the current cores
+  //! (zero if unknown)
+  TimeInstant get_execution_time() const noexcept {
+    return m_allocation.m_execution_time;
+  }
+  void set_execution_time(TimeInstant execution_time) noexcept {
+    m_allocation.m_execution_time = execution_time;
+  }
+
+ private:
+  std::shared_ptr<const ApplicationProfile> m_profile;
+  double m_weight;
+  ApplicationAllocation m_allocation;
+};
+
+#endif  // __OPT_DEADLINE__PROCESS_APPLICATION__HPP
@@ -0,0 +1,209 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "ResponseTable.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+void ResponseTable::add_point(unsigned cores, double time) {
+  m_points.push_back({cores, time, 0.0});
+}
+
+void ResponseTable::finalize() {
+  std::sort(m_points.begin(), m_points.end(),
+            [](const Point& p1, const Point& p2) {
+              return p1.m_cores < p2.m_cores;
+            });
+  m_points.erase(std::unique(m_points.begin(), m_points.end(),
+                             [](const Point& p1, const Point& p2) {
+                               return p1.m_cores == p2.m_cores;
+                             }),
+                 m_points.end());
+
+  // More cores never take longer (simulation noise is flattened)
+  for (std::size_t k = 1; k < m_points.size(); ++k) {
+    m_points[k].m_time = std::min(m_points[k].m_time, m_points[k - 1].m_time);
+  }
+
+  // Leave-one-out error of each interior point
+  std::vector<double> point_error(m_points.size(),
+                                  std::numeric_limits<double>::infinity());
+  for (std::size_t k = 1; k + 1 < m_points.size(); ++k) {
+    const double inv_prev = 1.0 / m_points[k - 1].m_cores;
+    const double inv_next = 1.0 / m_points[k + 1].m_cores;
+    const double inv = 1.0 / m_points[k].m_cores;
+    const double estimate =
+        m_points[k - 1].m_time + (m_points[k + 1].m_time -
+                                  m_points[k - 1].m_time) *
+                                     (inv - inv_prev) / (inv_next - inv_prev);
+    point_error[k] =
+        std::abs(estimate - m_points[k].m_time) / m_points[k].m_time;
+  }
+
+  // A segment is as accurate as the worst of its interior endpoints
+  for (std::size_t k = 0; k + 1 < m_points.size(); ++k) {
+    const double error_begin = k > 0 ? point_error[k] : point_error[k + 1];
+    const double error_end =
+        k + 2 < m_points.size() ? point_error[k + 1] : point_error[k];
+    m_points[k].m_error = std::max(error_begin, error_end);
+  }
+  if (m_points.empty() == false) {
+    m_points.back().m_error = 0.0;
+  }
+}
+
+double ResponseTable::interpolate(std::size_t k, double cores) const {
+  const auto& p1 = m_points[k];
+  const auto& p2 = m_points[k + 1];
+  const double inv1 = 1.0 / p1.m_cores;
+  const double inv2 = 1.0 / p2.m_cores;
+  return p1.m_time + (p2.m_time - p1.m_time) * (1.0 / cores - inv1) /
+                         (inv2 - inv1);
+}
+
+bool ResponseTable::lookup_time(double cores, double tolerance,
+                                double* time) const {
+  if (m_points.size() < 2 || cores < m_points.front().m_cores ||
+      cores > m_points.back().m_cores) {
+    return false;
+  }
+
+  if (cores == m_points.back().m_cores) {
+    *time = m_points.back().m_time;
+    return true;
+  }
+
+  // First point with more cores (the segment is the one before)
+  const auto it = std::upper_bound(
+      m_points.cbegin(), m_points.cend(), cores,
+      [](double value, const Point& point) { return value < point.m_cores; });
+  const std::size_t k = (it - m_points.cbegin()) - 1;
+
+  if (m_points[k].m_cores == cores) {
+    *time = m_points[k].m_time;
+    return true;
+  }
+  if (m_points[k].m_error > tolerance) {
+    return false;
+  }
+  *time = interpolate(k, cores);
+  return true;
+}
+
+bool ResponseTable::lookup_cores(double deadline, double tolerance,
+                                 double* cores) const {
+  // Time is non-increasing with the cores
+  if (m_points.size() < 2 || deadline > m_points.front().m_time ||
+      deadline < m_points.back().m_time) {
+    return false;
+  }
+
+  // First point which meets the deadline (the segment is the one before)
+  const auto it = std::find_if(
+      m_points.cbegin(), m_points.cend(),
+      [deadline](const Point& point) { return point.m_time <= deadline; });
+  const std::size_t k = it - m_points.cbegin();
+  if (k == 0 || it->m_time == deadline) {
+    *cores = it->m_cores;
+    return true;
+  }
+
+  const auto& p1 = m_points[k - 1];
+  const auto& p2 = m_points[k];
+  if (p1.m_error > tolerance) {
+    return false;
+  }
+
+  // Invert the interpolation (linear in 1/cores)
+  const double inv1 = 1.0 / p1.m_cores;
+  const double inv2 = 1.0 / p2.m_cores;
+  const double inv =
+      inv1 + (deadline - p1.m_time) * (inv2 - inv1) / (p2.m_time - p1.m_time);
+  *cores = 1.0 / inv;
+  return true;
+}
+
+void ResponseTable::save(const std::string& filename,
+                         std::size_t key) const {
+  std::ofstream file(filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open response table file '" + filename + "'");
+  }
+  file.precision(std::numeric_limits<double>::max_digits10);
+
+  file << HEADER << ' ' << VERSION << '\n';
+  file << "key " << key << '\n';
+  file << "points " << m_points.size() << '\n';
+  for (const auto& point : m_points) {
+    file << point.m_cores << ' ' << point.m_time << '\n';
+  }
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot write response table file '" + filename +
+                        "'");
+  }
+}
+
+bool ResponseTable::load(const std::string& filename, std::size_t key) {
+  std::ifstream file(filename);
+  if (file.fail()) {
+    return false;
+  }
+
+  std::string header, field;
+  unsigned version = 0;
+  std::size_t read_key = 0;
+  std::size_t size = 0;
+  file >> header >> version >> field >> read_key;
+  if (header != HEADER || version != VERSION || read_key != key) {
+    return false;
+  }
+  file >> field >> size;
+
+  m_points.clear();
+  for (std::size_t i = 0; i < size; ++i) {
+    unsigned cores = 0;
+    double time = 0.0;
+    file >> cores >> time;
+    add_point(cores, time);
+  }
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("The response table file '" + filename +
+                        "' is bad-formed");
+  }
+
+  finalize();
+  return true;
+}
+
+const ResponseTable* ResponseTables::find(
+    const Application& application) const {
+  const auto finder = m_tables.find(application.get_lua_name());
+  return finder != m_tables.cend() ? &finder->second : nullptr;
+}
+
+bool ResponseTables::lookup_time(const Application& application, double cores,
+                                 double* time) const {
+  const auto* table = find(application);
+  return table != nullptr && table->lookup_time(cores, m_tolerance, time);
+}
+
+bool ResponseTables::lookup_cores(const Application& application,
+                                  double deadline, double* cores) const {
+  const auto* table = find(application);
+  return table != nullptr && table->lookup_cores(deadline, m_tolerance, cores);
+}
@@ -0,0 +1,106 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__RESPONSE_TABLE__HPP
+#define __OPT_DEADLINE__RESPONSE_TABLE__HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "ApplicationProfile.hpp"
+
+/*! Precomputed response of an application: dagSim execution time for a set
+  of core counts. Between two points the time is interpolated linearly in
+  1/cores (exact for the hyperbolic model time = chi_0 + chi_c / cores).
+  The interpolation error of each segment is estimated (leave-one-out on the
+  neighbouring points): queries falling in a segment whose estimated error is
+  above the tolerance, or outside the table, are not answered.
+ */
+class ResponseTable {
+ public:
+  struct Point {
+    unsigned m_cores;
+    double m_time;
+    double m_error;  // Estimated relative error of the following segment
+  };
+
+  void add_point(unsigned cores, double time);
+
+  //! Sort the points, make the time non-increasing with the cores and
+  //! estimate the interpolation error of each segment
+  void finalize();
+
+  bool empty() const noexcept { return m_points.empty(); }
+
+  const std::vector<Point>& get_points() const noexcept { return m_points; }
+
+  //! \return 'true' if the execution time with 'cores' has been answered
+  bool lookup_time(double cores, double tolerance, double* time) const;
+
+  //! \return 'true' if the (fractional) number of cores needed to meet the
+  //! deadline has been answered
+  bool lookup_cores(double deadline, double tolerance, double* cores) const;
+
+  //! Write the table into a file. 'key' identifies the application (its
+  //! LUA template, its files and the configuration)
+  void save(const std::string& filename, std::size_t key) const;
+
+  //! \return 'false' if the file does not exist or it has been computed for
+  //! a different key
+  bool load(const std::string& filename, std::size_t key);
+
+ private:
+  static constexpr const char* HEADER = "OPT_DEADLINE_RESPONSE_TABLE";
+  static constexpr unsigned VERSION = 2;
+
+  std::vector<Point> m_points;  // Sorted by number of cores
+
+  //! Interpolated time at 'cores' in the segment [k, k + 1]
+  double interpolate(std::size_t k, double cores) const;
+};
+
+//! The response tables of all the applications (by LUA template)
+class ResponseTables {
+ public:
+  using Application = ApplicationProfile;
+
+  explicit ResponseTables(double tolerance) : m_tolerance(tolerance) {}
+
+  ResponseTable& get_table_mod(const std::string& lua_filename) {
+    return m_tables[lua_filename];
+  }
+
+  //! \return the table of the application or null if there is not
+  const ResponseTable* find(const Application& application) const;
+
+  bool lookup_time(const Application& application, double cores,
+                   double* time) const;
+
+  bool lookup_cores(const Application& application, double deadline,
+                    double* cores) const;
+
+  //! \return the file where the table of a LUA template is stored
+  static std::string get_table_filename(const std::string& lua_filename) {
+    return lua_filename + ".response_table";
+  }
+
+ private:
+  double m_tolerance;
+  std::map<std::string, ResponseTable> m_tables;
+};
+
+#endif  // __OPT_DEADLINE__RESPONSE_TABLE__HPP
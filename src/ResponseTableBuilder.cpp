@@ -0,0 +1,201 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "ResponseTableBuilder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "FineGrain.hpp"
+#include "PendingCommand.hpp"
+#include "PerformanceModel.hpp"
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+ResponseTables ResponseTableBuilder::build(const Configuration& configuration,
+                                           const SolverOptions& options,
+                                           const Process& process,
+                                           unsigned points, double tolerance,
+                                           std::ostream* log) {
+  Statistics::ScopedPhase phase_timer(Statistics::Phase::PRECOMPUTE);
+  Tracer::ScopedSpan trace_span("Precompute", "phase");
+  *log << "ResponseTableBuilder::build > Starting precompute\n";
+
+  // A simulation of the sweep
+  struct SweepPoint {
+    const Application* m_application;
+    unsigned m_cores;
+  };
+
+  ResponseTables tables(tolerance);
+  std::vector<SweepPoint> sweep;
+  std::vector<std::pair<std::string, std::size_t>> tables_to_save;
+  std::set<std::string> lua_filenames;
+
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    const auto& application = process.get_application_from_index(i);
+    const std::string& lua_filename = application.get_lua_name();
+
+    // Applications with the same LUA template share the table
+    if (lua_filenames.insert(lua_filename).second == false) {
+      continue;
+    }
+
+    const std::size_t table_key =
+        compute_table_key(application, process.get_config_filename());
+    auto& table = tables.get_table_mod(lua_filename);
+    const std::string table_filename =
+        ResponseTables::get_table_filename(lua_filename);
+    if (table.load(table_filename, table_key)) {
+      *log << "\t> Response table '" << table_filename << "' loaded ("
+           << table.get_points().size() << " points)\n";
+      continue;
+    }
+
+    for (const auto cores : compute_core_grid(application, process, points)) {
+      sweep.push_back({&application, cores});
+    }
+    tables_to_save.emplace_back(lua_filename, table_key);
+  }
+
+  // Run the sweep with as many simulations at once as the workers (or the
+  // local hardware threads)
+  const std::size_t max_running =
+      options.m_worker_pool
+          ? options.m_worker_pool->get_number_of_workers()
+          : std::max(1u, std::thread::hardware_concurrency());
+  *log << "\t> Sweep of " << sweep.size() << " simulations (" << max_running
+       << " at once)\n";
+
+  const FineGrain fine_grain(configuration, options);
+  std::deque<std::pair<std::size_t, std::unique_ptr<PendingCommand>>> running;
+  std::size_t next = 0;
+  while (next < sweep.size() || running.empty() == false) {
+    if (options.m_stop_condition->stop_requested()) {
+      *log << "\t> Stop requested. Precompute interrupted\n";
+      return ResponseTables(tolerance);
+    }
+
+    // Fill the window of running simulations
+    while (next < sweep.size() && running.size() < max_running) {
+      running.emplace_back(next, fine_grain.launch_dagSim(
+                                     *sweep[next].m_application,
+                                     sweep[next].m_cores, log));
+      ++next;
+    }
+
+    // Collect the oldest one
+    const auto start = std::chrono::steady_clock::now();
+    const auto& point = sweep[running.front().first];
+    const std::string output = running.front().second->wait();
+    running.pop_front();
+    Statistics::instance().add_external_call(
+        Statistics::ExternalCall::DAGSIM,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+
+    double time = 0.0;
+    try {
+      time = std::stod(output);
+    } catch (const std::exception&) {
+      THROW_RUNTIME_ERROR("Dagsim result is empty or bad-formed: '" + output +
+                          "'");
+    }
+    *log << "\t> " << point.m_application->get_application_id() << ": "
+         << point.m_cores << " cores -> " << time << '\n';
+    tables.get_table_mod(point.m_application->get_lua_name())
+        .add_point(point.m_cores, time);
+  }
+
+  // Store the new tables beside the LUA templates
+  for (const auto& table_to_save : tables_to_save) {
+    auto& table = tables.get_table_mod(table_to_save.first);
+    table.finalize();
+    const std::string table_filename =
+        ResponseTables::get_table_filename(table_to_save.first);
+    try {
+      table.save(table_filename, table_to_save.second);
+      *log << "\t> Response table '" << table_filename << "' saved\n";
+    } catch (const std::exception& error) {
+      *log << "\t> " << error.what() << ". The table is not stored\n";
+    }
+  }
+
+  *log << "ResponseTableBuilder::build > End precompute\n";
+  return tables;
+}
+
+std::size_t ResponseTableBuilder::compute_table_key(
+    const Application& application, const std::string& config_filename) {
+  const auto& resources = application.get_files_resources();
+  std::string contents_hashes;
+  for (const auto& filename :
+       {application.get_lua_name(), resources.m_Application_File,
+        resources.m_Jobs_File, resources.m_Stages_File,
+        resources.m_Tasks_File, resources.m_Infrastructure_File,
+        config_filename}) {
+    std::ifstream file(filename);
+    contents_hashes += std::to_string(std::hash<std::string>()(
+                           std::string((std::istreambuf_iterator<char>(file)),
+                                       std::istreambuf_iterator<char>()))) +
+                       ' ';
+  }
+  return std::hash<std::string>()(contents_hashes);
+}
+
+std::vector<unsigned> ResponseTableBuilder::compute_core_grid(
+    const Application& application, const Process& process, unsigned points) {
+  // ML estimate of the cores for a fair share of the deadline
+  const auto& mlm = application.get_machine_learning_model();
+  const double fair_deadline =
+      static_cast<double>(process.get_total_deadline()) /
+      process.get_number_applications();
+  const double total_deadline = process.get_total_deadline();
+  double center =
+      DefaultPerformanceModel::number_of_cores(mlm, fair_deadline);
+  if (!std::isfinite(center) || center <= 0.0) {
+    center = DefaultPerformanceModel::number_of_cores(mlm, total_deadline);
+  }
+  if (!std::isfinite(center) || center <= 0.0) {
+    center = 1.0;
+  }
+
+  const double lowest = std::max(1.0, std::floor(center / SWEEP_RANGE));
+  const double highest =
+      std::max(lowest + 1.0, std::ceil(center * SWEEP_RANGE));
+
+  // Geometric grid (rounded to whole cores)
+  std::vector<unsigned> grid;
+  for (unsigned k = 0; k < points; ++k) {
+    const double exponent =
+        points > 1 ? static_cast<double>(k) / (points - 1) : 0.0;
+    const auto cores = static_cast<unsigned>(
+        std::round(lowest * std::pow(highest / lowest, exponent)));
+    if (grid.empty() || grid.back() != cores) {
+      grid.push_back(cores);
+    }
+  }
+  return grid;
+}
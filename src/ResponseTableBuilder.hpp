@@ -0,0 +1,64 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__RESPONSE_TABLE_BUILDER__HPP
+#define __OPT_DEADLINE__RESPONSE_TABLE_BUILDER__HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Process.hpp"
+#include "ResponseTable.hpp"
+#include "SolverOptions.hpp"
+
+/*! Precompute stage: it sweeps each application over a range of core counts
+  with dagSim (in parallel) and builds its response table. The tables are
+  stored beside the LUA templates and reused by the next runs while the
+  templates, the files of the application and the configuration file do
+  not change.
+ */
+class ResponseTableBuilder {
+ public:
+  using Application = Process::Application;
+  using Configuration = opt_common::Configuration;
+
+  /*! Build (or load) the tables of all the applications of the process
+    \param [in] points  Number of core counts of each sweep
+   */
+  static ResponseTables build(const Configuration& configuration,
+                              const SolverOptions& options,
+                              const Process& process, unsigned points,
+                              double tolerance, std::ostream* log);
+
+ private:
+  //! Ratio between the ends of the sweep and the ML estimate of the cores
+  static constexpr double SWEEP_RANGE = 8.0;
+
+  /*! \return the core counts of the sweep: geometric grid around the number
+    of cores estimated by the ML model for a fair share of the deadline
+   */
+  static std::vector<unsigned> compute_core_grid(
+      const Application& application, const Process& process,
+      unsigned points);
+
+  //! \return the key of the table of the application: a hash of the
+  //! contents of its LUA template, of its files and of the configuration
+  static std::size_t compute_table_key(const Application& application,
+                                       const std::string& config_filename);
+};
+
+#endif  // __OPT_DEADLINE__RESPONSE_TABLE_BUILDER__HPP
@@ -0,0 +1,141 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__SOLVER_OPTIONS__HPP
+#define __OPT_DEADLINE__SOLVER_OPTIONS__HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "Allocation.hpp"
+#include "ApplicationRegistry.hpp"
+#include "CriticalPathEstimator.hpp"
+#include "EvaluationTrace.hpp"
+#include "ResponseTable.hpp"
+#include "StopCondition.hpp"
+#include "WorkerPool.hpp"
+
+class Process;
+
+//! Options of the algorithms (provided by the command line)
+struct SolverOptions {
+  // FineGrain checkpoint file (empty if checkpoints are disabled)
+  std::string m_checkpoint_filename;
+
+  // Continue FineGrain from the state stored in the checkpoint file
+  bool m_resume = false;
+
+  // The algorithm which runs FineGrain (stored in its checkpoints)
+  std::string m_algorithm;
+
+  // Result file of a previous run used as initial solution (empty if the
+  // initial solution is computed from scratch)
+  std::string m_warm_start_filename;
+
+  // Allocation of the process found before used as initial solution (empty
+  // if there is not). It takes the precedence over the result file
+  Allocation m_warm_start_allocation;
+
+  // Total deadline of the process for which m_warm_start_allocation was found
+  opt_common::TimeInstant m_warm_start_total_deadline = 0;
+
+  bool has_warm_start() const noexcept {
+    return m_warm_start_filename.empty() == false ||
+           m_warm_start_allocation.empty() == false;
+  }
+
+  // When the algorithms have to stop (shared among all the algorithms of a
+  // run). With a time budget the most promising candidates are evaluated first
+  std::shared_ptr<StopCondition> m_stop_condition =
+      std::make_shared<StopCondition>();
+
+  // Number of jobs of the low fidelity dagSim simulations used to rank
+  // FineGrain candidates (0 disables the multi-fidelity evaluation)
+  unsigned m_screening_max_jobs = 0;
+
+  // Maximum number of dagSim simulations launched in background for the
+  // leading FineGrain candidates (0 disables the speculative execution)
+  unsigned m_max_speculative_dagSims = 0;
+
+  // Remote workers which run OPT_IC and dagSim (null if they run locally)
+  std::shared_ptr<WorkerPool> m_worker_pool;
+
+  // Precomputed response tables (null if the precompute stage is disabled)
+  std::shared_ptr<const ResponseTables> m_response_tables;
+
+  // Analytic estimators of the execution time from the DAG of the LUA
+  // templates (null if they are disabled)
+  std::shared_ptr<const CriticalPathEstimators> m_critical_path_estimators;
+
+  // Evaluate the OPT_IC queries of a FineGrain iteration with a single local
+  // invocation (an input line for each query)
+  bool m_batch_optIC = false;
+
+  // FineGrain finds the number of cores for a deadline with its own search
+  // on dagSim simulations, instead of OPT_IC
+  bool m_native_core_search = false;
+
+  // Record (or replay) of the OPT_IC and dagSim evaluations (null if the
+  // evaluations are neither recorded nor replayed)
+  std::shared_ptr<EvaluationTrace> m_evaluation_trace;
+
+  // The applications and the evaluations shared by the processes of the run
+  // (null if the identical evaluations are not shared)
+  std::shared_ptr<ApplicationRegistry> m_application_registry;
+
+  // Wall-clock time (seconds) of the multi-start local search of Algorithm3
+  double m_search_time_limit = 5.0;
+
+  // CoarseGrain and FineGrain stop once the relative gap between the
+  // objective function and its lower bound is not larger (0 if they never
+  // stop for the gap). The gap of FineGrain is an estimate: its objective
+  // is evaluated by OPT_IC and dagSim, the bound with the ML models
+  double m_gap_threshold = 0.0;
+
+  // File where the execution time of the last dagSim simulation is written
+  // (empty if it is not written)
+  std::string m_dagSim_result_filename = "result.txt";
+
+  // Called with the process whenever the algorithms find a new allocation,
+  // on the thread which runs them (empty if the progress is not reported)
+  std::function<void(const Process& process, const std::string& stage)>
+      m_progress_callback;
+
+  //! \return the options of the FineGrain of 'algorithm': each algorithm
+  //! has its own checkpoint file (with the suffix '.<algorithm>')
+  SolverOptions for_algorithm(const std::string& algorithm) const {
+    SolverOptions options = *this;
+    options.m_algorithm = algorithm;
+    if (options.m_checkpoint_filename.empty() == false) {
+      options.m_checkpoint_filename += '.' + algorithm;
+    }
+    return options;
+  }
+
+  //! A negative gap means that the bound does not hold: it is never closed
+  bool gap_closed(double relative_gap) const noexcept {
+    return m_gap_threshold > 0.0 && relative_gap >= 0.0 &&
+           relative_gap <= m_gap_threshold;
+  }
+
+  void report_progress(const Process& process, const std::string& stage) const {
+    if (m_progress_callback) {
+      m_progress_callback(process, stage);
+    }
+  }
+};
+
+#endif  // __OPT_DEADLINE__SOLVER_OPTIONS__HPP
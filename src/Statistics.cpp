@@ -0,0 +1,271 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Statistics.hpp"
+#include <opt_common/helper.hpp>
+#include <sys/resource.h>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr double NS_TO_SECONDS = 1e-9;
+constexpr double NS_TO_MS = 1e-6;
+
+}  // anonymous namespace
+
+Statistics& Statistics::instance() {
+  static Statistics statistics;
+  return statistics;
+}
+
+void Statistics::add_phase_time(Phase phase, std::uint64_t wall_ns,
+                                std::uint64_t cpu_ns) noexcept {
+  auto& stats = m_phases[static_cast<std::size_t>(phase)];
+  stats.m_count.fetch_add(1, std::memory_order_relaxed);
+  stats.m_wall_ns.fetch_add(wall_ns, std::memory_order_relaxed);
+  stats.m_cpu_ns.fetch_add(cpu_ns, std::memory_order_relaxed);
+}
+
+void Statistics::add_external_call(ExternalCall call,
+                                   std::uint64_t latency_ns) noexcept {
+  auto& stats = m_calls[static_cast<std::size_t>(call)];
+  stats.m_count.fetch_add(1, std::memory_order_relaxed);
+  stats.m_total_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+  stats.m_histogram[latency_bucket(latency_ns)].fetch_add(
+      1, std::memory_order_relaxed);
+
+  // Update the max latency
+  auto current_max = stats.m_max_ns.load(std::memory_order_relaxed);
+  while (current_max < latency_ns &&
+         !stats.m_max_ns.compare_exchange_weak(current_max, latency_ns,
+                                               std::memory_order_relaxed)) {
+  }
+}
+
+std::size_t Statistics::latency_bucket(std::uint64_t latency_ns) noexcept {
+  std::uint64_t latency_ms = latency_ns / 1000000;
+  std::size_t bucket = 0;
+  while (latency_ms > 0 && bucket < NUM_LATENCY_BUCKETS - 1) {
+    latency_ms >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+long Statistics::get_peak_rss_kb() noexcept {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // On Linux 'ru_maxrss' is already expressed in KiB
+  return usage.ru_maxrss;
+}
+
+const char* Statistics::phase2string(Phase phase) {
+  switch (phase) {
+    case Phase::CSV_LOADING:
+      return "CSVLoading";
+    case Phase::PRECOMPUTE:
+      return "Precompute";
+    case Phase::INITIAL_SOLUTION_SA:
+      return "InitialSolution_SA";
+    case Phase::INITIAL_SOLUTION_FA:
+      return "InitialSolution_FA";
+    case Phase::INITIAL_SOLUTION_WARM_START:
+      return "InitialSolution_WarmStart";
+    case Phase::COARSE_GRAIN:
+      return "CoarseGrain";
+    case Phase::FINE_GRAIN:
+      return "FineGrain";
+    case Phase::STREAM_REBALANCE:
+      return "StreamRebalance";
+    case Phase::HIERARCHICAL:
+      return "Hierarchical";
+    case Phase::MULTI_START_SEARCH:
+      return "MultiStartSearch";
+    case Phase::CORE_BUDGET_SEARCH:
+      return "CoreBudgetSearch";
+    default:
+      THROW_RUNTIME_ERROR("Phase not recognized");
+  }
+}
+
+const char* Statistics::call2string(ExternalCall call) {
+  switch (call) {
+    case ExternalCall::OPT_IC:
+      return "OPT_IC";
+    case ExternalCall::DAGSIM:
+      return "dagSim";
+    default:
+      THROW_RUNTIME_ERROR("External call not recognized");
+  }
+}
+
+const char* Statistics::counter2string(Counter counter) {
+  switch (counter) {
+    case Counter::COARSE_GRAIN_ITERATIONS:
+      return "CoarseGrainIterations";
+    case Counter::COARSE_GRAIN_PAIR_EVALUATIONS:
+      return "CoarseGrainPairEvaluations";
+    case Counter::FINE_GRAIN_ITERATIONS:
+      return "FineGrainIterations";
+    case Counter::DAGSIM_SCREENING_RUNS:
+      return "DagSimScreeningRuns";
+    case Counter::DAGSIM_FIDELITY_ESCALATIONS:
+      return "DagSimFidelityEscalations";
+    case Counter::SPECULATIVE_DAGSIM_LAUNCHES:
+      return "SpeculativeDagSimLaunches";
+    case Counter::SPECULATIVE_DAGSIM_HITS:
+      return "SpeculativeDagSimHits";
+    case Counter::SPECULATIVE_DAGSIM_CANCELLATIONS:
+      return "SpeculativeDagSimCancelled";
+    case Counter::WORKER_JOBS:
+      return "WorkerJobs";
+    case Counter::WORKER_REQUEUED_JOBS:
+      return "WorkerRequeuedJobs";
+    case Counter::RESPONSE_TABLE_HITS:
+      return "ResponseTableHits";
+    case Counter::RESPONSE_TABLE_MISSES:
+      return "ResponseTableMisses";
+    case Counter::CORE_COUNT_INDEX_HITS:
+      return "CoreCountIndexHits";
+    case Counter::CORE_COUNT_INDEX_PRUNED:
+      return "CoreCountIndexPruned";
+    case Counter::STREAM_EVENTS:
+      return "StreamEvents";
+    case Counter::HIERARCHICAL_GROUP_SOLVES:
+      return "HierarchicalGroupSolves";
+    case Counter::CRITICAL_PATH_FILTERED:
+      return "CriticalPathFiltered";
+    case Counter::MULTI_START_SEARCH_MOVES:
+      return "MultiStartSearchMoves";
+    case Counter::MULTI_START_SEARCH_ACCEPTED_MOVES:
+      return "MultiStartSearchAcceptedMoves";
+    case Counter::OPT_IC_BATCHED_QUERIES:
+      return "OptICBatchedQueries";
+    case Counter::OPT_IC_BATCH_FALLBACKS:
+      return "OptICBatchFallbacks";
+    case Counter::NATIVE_CORE_SEARCHES:
+      return "NativeCoreSearches";
+    case Counter::NATIVE_CORE_SEARCH_SIMULATIONS:
+      return "NativeCoreSearchSimulations";
+    case Counter::APPLICATION_REGISTRY_HITS:
+      return "ApplicationRegistryHits";
+    case Counter::SHARED_EVALUATION_HITS:
+      return "SharedEvaluationHits";
+    case Counter::CORE_BUDGET_PROBES:
+      return "CoreBudgetProbes";
+    default:
+      THROW_RUNTIME_ERROR("Counter not recognized");
+  }
+}
+
+void Statistics::print_summary(std::ostream* out) const {
+  const auto flags = out->flags();
+  *out << "----RUN STATISTICS----\n";
+
+  *out << std::left << std::setw(28) << "Phase" << std::right << std::setw(8)
+       << "Count" << std::setw(14) << "Wall (s)" << std::setw(14) << "CPU (s)"
+       << '\n';
+  for (std::size_t i = 0; i < NUM_PHASES; ++i) {
+    const auto& stats = m_phases[i];
+    *out << std::left << std::setw(28) << phase2string(static_cast<Phase>(i))
+         << std::right << std::setw(8) << stats.m_count.load() << std::fixed
+         << std::setprecision(3) << std::setw(14)
+         << stats.m_wall_ns.load() * NS_TO_SECONDS << std::setw(14)
+         << stats.m_cpu_ns.load() * NS_TO_SECONDS << '\n';
+  }
+
+  *out << std::left << std::setw(28) << "External Call" << std::right
+       << std::setw(8) << "Count" << std::setw(14) << "Total (s)"
+       << std::setw(14) << "Mean (ms)" << std::setw(14) << "Max (ms)" << '\n';
+  for (std::size_t i = 0; i < NUM_CALLS; ++i) {
+    const auto& stats = m_calls[i];
+    const auto count = stats.m_count.load();
+    const double total_ns = stats.m_total_ns.load();
+    *out << std::left << std::setw(28)
+         << call2string(static_cast<ExternalCall>(i)) << std::right
+         << std::setw(8) << count << std::fixed << std::setprecision(3)
+         << std::setw(14) << total_ns * NS_TO_SECONDS << std::setw(14)
+         << (count > 0 ? total_ns * NS_TO_MS / count : 0.0) << std::setw(14)
+         << stats.m_max_ns.load() * NS_TO_MS << '\n';
+
+    // Histogram (only not empty buckets)
+    for (std::size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b) {
+      const auto bucket_count = stats.m_histogram[b].load();
+      if (bucket_count > 0) {
+        *out << "\t< " << (1ull << b) << " ms: " << bucket_count << '\n';
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < NUM_COUNTERS; ++i) {
+    *out << std::left << std::setw(30)
+         << counter2string(static_cast<Counter>(i)) << std::right
+         << m_counters[i].load() << '\n';
+  }
+  *out << std::left << std::setw(30) << "PeakRSS (KiB)" << std::right
+       << get_peak_rss_kb() << '\n';
+  *out << "----END RUN STATISTICS----\n";
+  out->flags(flags);
+}
+
+void Statistics::write_json(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open statistics file '" + filename + "'");
+  }
+
+  file << "{\n  \"phases\": {";
+  for (std::size_t i = 0; i < NUM_PHASES; ++i) {
+    const auto& stats = m_phases[i];
+    file << (i == 0 ? "\n" : ",\n") << "    \""
+         << phase2string(static_cast<Phase>(i))
+         << "\": {\"count\": " << stats.m_count.load()
+         << ", \"wall_s\": " << stats.m_wall_ns.load() * NS_TO_SECONDS
+         << ", \"cpu_s\": " << stats.m_cpu_ns.load() * NS_TO_SECONDS << "}";
+  }
+
+  file << "\n  },\n  \"external_calls\": {";
+  for (std::size_t i = 0; i < NUM_CALLS; ++i) {
+    const auto& stats = m_calls[i];
+    file << (i == 0 ? "\n" : ",\n") << "    \""
+         << call2string(static_cast<ExternalCall>(i))
+         << "\": {\"count\": " << stats.m_count.load()
+         << ", \"total_s\": " << stats.m_total_ns.load() * NS_TO_SECONDS
+         << ", \"max_ms\": " << stats.m_max_ns.load() * NS_TO_MS
+         << ", \"histogram_ms_upper_bounds\": [";
+    for (std::size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b) {
+      file << (b == 0 ? "" : ", ") << (1ull << b);
+    }
+    file << "], \"histogram_counts\": [";
+    for (std::size_t b = 0; b < NUM_LATENCY_BUCKETS; ++b) {
+      file << (b == 0 ? "" : ", ") << stats.m_histogram[b].load();
+    }
+    file << "]}";
+  }
+
+  file << "\n  },\n  \"counters\": {";
+  for (std::size_t i = 0; i < NUM_COUNTERS; ++i) {
+    file << (i == 0 ? "\n" : ",\n") << "    \""
+         << counter2string(static_cast<Counter>(i))
+         << "\": " << m_counters[i].load();
+  }
+  file << "\n  },\n  \"peak_rss_kb\": " << get_peak_rss_kb() << "\n}\n";
+}
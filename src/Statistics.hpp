@@ -0,0 +1,190 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__STATISTICS__HPP
+#define __OPT_DEADLINE__STATISTICS__HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+
+/*! Process-wide run instrumentation.
+  It collects wall/CPU time per phase, count and latency histogram per type of
+  external call and some algorithm counters. All the updates are lock-free
+  (relaxed atomics) so the instrumentation can be always enabled.
+ */
+class Statistics {
+ public:
+  enum class Phase {
+    CSV_LOADING,
+    PRECOMPUTE,
+    INITIAL_SOLUTION_SA,
+    INITIAL_SOLUTION_FA,
+    INITIAL_SOLUTION_WARM_START,
+    COARSE_GRAIN,
+    FINE_GRAIN,
+    STREAM_REBALANCE,
+    HIERARCHICAL,
+    MULTI_START_SEARCH,
+    CORE_BUDGET_SEARCH,
+    NUM_PHASES
+  };
+
+  enum class ExternalCall { OPT_IC, DAGSIM, NUM_CALLS };
+
+  enum class Counter {
+    COARSE_GRAIN_ITERATIONS,
+    COARSE_GRAIN_PAIR_EVALUATIONS,
+    FINE_GRAIN_ITERATIONS,
+    DAGSIM_SCREENING_RUNS,
+    DAGSIM_FIDELITY_ESCALATIONS,
+    SPECULATIVE_DAGSIM_LAUNCHES,
+    SPECULATIVE_DAGSIM_HITS,
+    SPECULATIVE_DAGSIM_CANCELLATIONS,
+    WORKER_JOBS,
+    WORKER_REQUEUED_JOBS,
+    RESPONSE_TABLE_HITS,
+    RESPONSE_TABLE_MISSES,
+    CORE_COUNT_INDEX_HITS,
+    CORE_COUNT_INDEX_PRUNED,
+    STREAM_EVENTS,
+    HIERARCHICAL_GROUP_SOLVES,
+    CRITICAL_PATH_FILTERED,
+    MULTI_START_SEARCH_MOVES,
+    MULTI_START_SEARCH_ACCEPTED_MOVES,
+    OPT_IC_BATCHED_QUERIES,
+    OPT_IC_BATCH_FALLBACKS,
+    NATIVE_CORE_SEARCHES,
+    NATIVE_CORE_SEARCH_SIMULATIONS,
+    APPLICATION_REGISTRY_HITS,
+    SHARED_EVALUATION_HITS,
+    CORE_BUDGET_PROBES,
+    NUM_COUNTERS
+  };
+
+  //! Number of buckets of the latency histogram. The bucket 'k' contains the
+  //! latencies in [2^(k-1), 2^k) milliseconds (the bucket 0 is [0, 1) ms)
+  static constexpr std::size_t NUM_LATENCY_BUCKETS = 24;
+
+  //! \return the process-wide instance
+  static Statistics& instance();
+
+  void add_phase_time(Phase phase, std::uint64_t wall_ns,
+                      std::uint64_t cpu_ns) noexcept;
+
+  void add_external_call(ExternalCall call, std::uint64_t latency_ns) noexcept;
+
+  void increment(Counter counter, std::uint64_t amount = 1) noexcept {
+    m_counters[static_cast<std::size_t>(counter)].fetch_add(
+        amount, std::memory_order_relaxed);
+  }
+
+  //! \return the peak resident set size of the process in KiB
+  static long get_peak_rss_kb() noexcept;
+
+  //! Print a human readable summary table
+  void print_summary(std::ostream* out) const;
+
+  //! Write the summary in JSON format into the file 'filename'
+  void write_json(const std::string& filename) const;
+
+  //! RAII timer of a phase (wall and process CPU time)
+  class ScopedPhase {
+   public:
+    explicit ScopedPhase(Phase phase) noexcept
+        : m_phase(phase),
+          m_wall_start(std::chrono::steady_clock::now()),
+          m_cpu_start(std::clock()) {}
+
+    ~ScopedPhase() {
+      const auto wall = std::chrono::steady_clock::now() - m_wall_start;
+      const auto cpu = std::clock() - m_cpu_start;
+      Statistics::instance().add_phase_time(
+          m_phase,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count(),
+          static_cast<std::uint64_t>(cpu * (1e9 / CLOCKS_PER_SEC)));
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    Phase m_phase;
+    std::chrono::steady_clock::time_point m_wall_start;
+    std::clock_t m_cpu_start;
+  };
+
+  //! RAII timer of an external call (latency only)
+  class ScopedExternalCall {
+   public:
+    explicit ScopedExternalCall(ExternalCall call) noexcept
+        : m_call(call), m_start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedExternalCall() {
+      const auto latency = std::chrono::steady_clock::now() - m_start;
+      Statistics::instance().add_external_call(
+          m_call, std::chrono::duration_cast<std::chrono::nanoseconds>(latency)
+                      .count());
+    }
+
+    ScopedExternalCall(const ScopedExternalCall&) = delete;
+    ScopedExternalCall& operator=(const ScopedExternalCall&) = delete;
+
+   private:
+    ExternalCall m_call;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+ private:
+  using AtomicCounter = std::atomic<std::uint64_t>;
+
+  struct PhaseStatistics {
+    AtomicCounter m_count{0};
+    AtomicCounter m_wall_ns{0};
+    AtomicCounter m_cpu_ns{0};
+  };
+
+  struct CallStatistics {
+    AtomicCounter m_count{0};
+    AtomicCounter m_total_ns{0};
+    AtomicCounter m_max_ns{0};
+    std::array<AtomicCounter, NUM_LATENCY_BUCKETS> m_histogram{};
+  };
+
+  static constexpr std::size_t NUM_PHASES =
+      static_cast<std::size_t>(Phase::NUM_PHASES);
+  static constexpr std::size_t NUM_CALLS =
+      static_cast<std::size_t>(ExternalCall::NUM_CALLS);
+  static constexpr std::size_t NUM_COUNTERS =
+      static_cast<std::size_t>(Counter::NUM_COUNTERS);
+
+  std::array<PhaseStatistics, NUM_PHASES> m_phases;
+  std::array<CallStatistics, NUM_CALLS> m_calls;
+  std::array<AtomicCounter, NUM_COUNTERS> m_counters{};
+
+  Statistics() = default;
+
+  static const char* phase2string(Phase phase);
+  static const char* call2string(ExternalCall call);
+  static const char* counter2string(Counter counter);
+  static std::size_t latency_bucket(std::uint64_t latency_ns) noexcept;
+};
+
+#endif  // __OPT_DEADLINE__STATISTICS__HPP
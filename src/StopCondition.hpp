@@ -0,0 +1,71 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__STOP_CONDITION__HPP
+#define __OPT_DEADLINE__STOP_CONDITION__HPP
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+
+/*! Tells the algorithms when they have to stop (anytime mode).
+  The stop can be caused by the wall-clock budget, an explicit request or a
+  SIGINT/SIGTERM signal (once the handlers have been installed). After a stop
+  the algorithms leave the process with the best allocation found so far.
+ */
+class StopCondition {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Set a wall-clock budget (starting from now)
+  void set_time_budget(double seconds) {
+    m_has_time_budget = true;
+    m_time_budget = seconds;
+    m_expiration = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(seconds));
+  }
+
+  bool has_time_budget() const noexcept { return m_has_time_budget; }
+
+  //! \return the wall-clock budget in seconds (if any)
+  double get_time_budget() const noexcept { return m_time_budget; }
+
+  void request_stop() noexcept {
+    m_stop_requested.store(true, std::memory_order_relaxed);
+  }
+
+  //! \return 'true' if the algorithms should stop as soon as possible
+  bool stop_requested() const noexcept {
+    return m_stop_requested.load(std::memory_order_relaxed) ||
+           s_signal_received != 0 ||
+           (m_has_time_budget && Clock::now() >= m_expiration);
+  }
+
+  //! Make SIGINT and SIGTERM request the stop (instead of killing the process)
+  static void install_signal_handlers();
+
+ private:
+  static volatile std::sig_atomic_t s_signal_received;
+
+  std::atomic<bool> m_stop_requested{false};
+  bool m_has_time_budget = false;
+  double m_time_budget = 0.0;
+  Clock::time_point m_expiration;
+
+  static void signal_handler(int signal_number);
+};
+
+#endif  // __OPT_DEADLINE__STOP_CONDITION__HPP
@@ -0,0 +1,184 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "StreamingOptimizer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "CoarseGrain.hpp"
+#include "PerformanceModel.hpp"
+#include "Statistics.hpp"
+#include "Tracer.hpp"
+
+void StreamingOptimizer::process(std::istream* events, Process* process,
+                                 std::ostream* log, std::ostream* result_log) {
+  *log << "StreamingOptimizer::process > Waiting for events\n";
+
+  unsigned event_index = 0;
+  std::string line;
+  while (m_options.m_stop_condition->stop_requested() == false &&
+         std::getline(*events, line)) {
+    // Skip empty lines and comments
+    if (line.empty() || line.at(0) == '#') {
+      continue;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Tracer::ScopedSpan trace_span("StreamEvent", "event");
+    trace_span.add_argument("event", event_index);
+    Statistics::instance().increment(Statistics::Counter::STREAM_EVENTS);
+    *log << "StreamingOptimizer::process > Event " << event_index << ": '"
+         << line << "'\n";
+
+    try {
+      double slack = 0.0;
+      std::vector<bool> involved;
+      apply_event(line, process, &slack, &involved, log);
+
+      CoarseGrain coarse_grain_algorithm(m_options);
+      coarse_grain_algorithm.rebalance(process, slack, std::move(involved),
+                                       log, result_log);
+    } catch (const std::exception& err) {
+      *log << "\t> Event discarded: " << err.what() << '\n';
+      ++event_index;
+      continue;
+    }
+
+    const double latency_ms =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count() /
+        1000.0;
+    *log << "\t> [Stream] Event " << event_index << "; Latency: " << latency_ms
+         << " ms; Global Objective Function: "
+         << process->compute_global_objective_function() << '\n';
+    process->dump_process(result_log,
+                          "Stream event " + std::to_string(event_index) +
+                              " ('" + line + "'); latency " +
+                              std::to_string(latency_ms) + " ms");
+    log->flush();
+    ++event_index;
+  }
+
+  *log << "StreamingOptimizer::process > End of events\n";
+}
+
+void StreamingOptimizer::apply_event(const std::string& event,
+                                     Process* process, double* slack,
+                                     std::vector<bool>* involved,
+                                     std::ostream* log) const {
+  std::istringstream iss{event};
+  std::string type;
+  iss >> type;
+
+  if (type == "add") {
+    std::string application_line;
+    std::getline(iss, application_line);
+    process->push_application_from_line(
+        application_line, m_options.m_application_registry.get());
+    const unsigned index = process->get_number_applications() - 1;
+    initialize_application(process, index);
+
+    // The deadline of the new application is taken from the others
+    const auto& application = process->get_application_from_index(index);
+    *log << "\t> Application '" << application.get_application_id()
+         << "' added with deadline " << application.get_deadline() << '\n';
+    *slack = -static_cast<double>(application.get_deadline());
+    involved->assign(process->get_number_applications(), false);
+    involved->back() = true;
+  } else if (type == "remove") {
+    std::string application_id;
+    iss >> application_id;
+    const unsigned index = process->get_application_index(application_id);
+
+    // The deadline of the removed application is given to the others
+    *slack = process->get_application_from_index(index).get_deadline();
+    process->remove_application(index);
+    *log << "\t> Application '" << application_id << "' removed\n";
+    involved->assign(process->get_number_applications(), false);
+  } else if (type == "weight") {
+    std::string application_id;
+    std::string weight_str;
+    iss >> application_id >> weight_str;
+    const unsigned index = process->get_application_index(application_id);
+    const double weight = std::stod(weight_str);
+    if (weight <= 0.0) {
+      THROW_RUNTIME_ERROR("The weight '" + weight_str +
+                          "' is not a positive number");
+    }
+
+    process->get_application_from_index_mod(index).set_weight(weight);
+    *log << "\t> Application '" << application_id << "' new weight "
+         << weight << '\n';
+    *slack = 0.0;
+    involved->assign(process->get_number_applications(), false);
+    (*involved)[index] = true;
+  } else if (type == "deadline") {
+    std::string deadline_str;
+    iss >> deadline_str;
+    const TimeInstant total_deadline = std::stoul(deadline_str);
+    if (total_deadline == 0) {
+      THROW_RUNTIME_ERROR("The total deadline must be positive");
+    }
+
+    *slack = static_cast<double>(total_deadline) -
+             static_cast<double>(process->get_total_deadline());
+    process->set_total_deadline(total_deadline);
+    *log << "\t> New total deadline " << total_deadline << '\n';
+    involved->assign(process->get_number_applications(), false);
+  } else {
+    THROW_RUNTIME_ERROR("Event '" + type + "' not recognized");
+  }
+}
+
+void StreamingOptimizer::initialize_application(Process* process,
+                                                unsigned index) {
+  // Formula is = D_tot * total_avg_ith / total_avg
+  const auto total_avg = [](const Process::Application& application) {
+    const auto& stage_avg_times = application.get_stage_avg_times();
+    return std::accumulate(stage_avg_times.cbegin(), stage_avg_times.cend(),
+                           TimeInstant(0));
+  };
+  TimeInstant total_avg_all_apps = 0;
+  for (unsigned i = 0; i < process->get_number_applications(); ++i) {
+    total_avg_all_apps += total_avg(process->get_application_from_index(i));
+  }
+
+  auto& application = process->get_application_from_index_mod(index);
+  const auto& mlm = application.get_machine_learning_model();
+  const TimeInstant share = static_cast<TimeInstant>(
+      process->get_total_deadline() * total_avg(application) /
+      static_cast<double>(total_avg_all_apps));
+
+  // The ML model cannot meet a deadline at or below chi_0: the share is at
+  // least the time with as many cores as the tasks of the application
+  const unsigned max_cores =
+      std::max(1u, application.get_max_number_of_tasks());
+  const TimeInstant min_deadline = static_cast<TimeInstant>(
+      std::ceil(DefaultPerformanceModel::execution_time(mlm, max_cores)));
+  const TimeInstant deadline = std::max(share, min_deadline);
+  application.set_deadline(deadline);
+
+  // Estimate n using D and the performance model
+  const double cores = DefaultPerformanceModel::number_of_cores(mlm, deadline);
+  application.set_number_of_core(
+      std::isfinite(cores) && cores > 1.0 ? static_cast<unsigned>(cores) : 1u);
+}
@@ -0,0 +1,70 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef __OPT_DEADLINE__STREAMING_OPTIMIZER__HPP
+#define __OPT_DEADLINE__STREAMING_OPTIMIZER__HPP
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Process.hpp"
+#include "SolverOptions.hpp"
+
+/*! Incremental re-optimization of a process which changes over time.
+  The change events are read one per line (lines starting with '#' are
+  comments):
+    add APP_CSV JOBS_CSV STAGES_CSV TASKS_CSV LUA_FILE CONFIG_INFR WEIGHT
+    remove APP_ID
+    weight APP_ID WEIGHT
+    deadline TOTAL_DEADLINE
+  After each event the allocation is rebalanced starting from the current one
+  (CoarseGrain::rebalance, no OPT_IC or dagSim invocation).
+ */
+class StreamingOptimizer {
+ public:
+  using TimeInstant = opt_common::TimeInstant;
+
+  explicit StreamingOptimizer(const SolverOptions& options)
+      : m_options(options) {}
+
+  /*! Process the events until the end of 'events' (or a stop request).
+    After each event the updated allocation is dumped into 'result_log'
+    together with the latency of the event. A bad event is logged and
+    discarded.
+   */
+  void process(std::istream* events, Process* process, std::ostream* log,
+               std::ostream* result_log);
+
+ private:
+  SolverOptions m_options;
+
+  /*! Apply the event on the process
+    \param [out] slack     The deadline to give (positive) or to take
+                           (negative) from the applications
+    \param [out] involved  The applications affected by the event
+   */
+  void apply_event(const std::string& event, Process* process, double* slack,
+                   std::vector<bool>* involved, std::ostream* log) const;
+
+  //! Set the initial deadline (its share of the total deadline, as
+  //! InitialSolution_FA, but not less than the ML time with one core per
+  //! task) and the number of cores of a new application
+  static void initialize_application(Process* process, unsigned index);
+};
+
+#endif  // __OPT_DEADLINE__STREAMING_OPTIMIZER__HPP
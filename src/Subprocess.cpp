@@ -0,0 +1,108 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Subprocess.hpp"
+#include <opt_common/helper.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <csignal>
+
+Subprocess::Subprocess(const std::string& command) : m_command(command) {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) {
+    THROW_RUNTIME_ERROR("Cannot create the pipe for the process '" + command +
+                        "'");
+  }
+
+  m_pid = fork();
+  if (m_pid < 0) {
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    THROW_RUNTIME_ERROR("Error launch process '" + command + "'");
+  }
+
+  if (m_pid == 0) {
+    // Child: new process group and standard output on the pipe
+    setpgid(0, 0);
+    dup2(pipe_fds[1], STDOUT_FILENO);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+    _exit(127);
+  }
+
+  // Set the group also from the parent (no race with 'cancel')
+  setpgid(m_pid, m_pid);
+  close(pipe_fds[1]);
+  m_output_fd = pipe_fds[0];
+}
+
+std::string Subprocess::wait() {
+  static constexpr std::size_t SIZE_BUFFER = 1024;
+
+  if (m_pid < 0) {
+    THROW_RUNTIME_ERROR("The process '" + m_command + "' is not running");
+  }
+
+  // Read the complete output
+  std::array<char, SIZE_BUFFER> buffer;
+  std::string output;
+  while (true) {
+    const ssize_t size = read(m_output_fd, buffer.data(), buffer.size());
+    if (size > 0) {
+      output.append(buffer.data(), size);
+    } else if (size == 0 || errno != EINTR) {
+      break;
+    }
+  }
+
+  reap();
+  return output;
+}
+
+std::string Subprocess::quote(const std::string& argument) {
+  // Inside single quotes only the single quote itself is special
+  std::string quoted = "'";
+  for (const char c : argument) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted.push_back(c);
+    }
+  }
+  return quoted + "'";
+}
+
+void Subprocess::cancel() noexcept {
+  if (m_pid > 0) {
+    kill(-m_pid, SIGTERM);
+    reap();
+  }
+}
+
+void Subprocess::reap() noexcept {
+  if (m_output_fd >= 0) {
+    close(m_output_fd);
+    m_output_fd = -1;
+  }
+  if (m_pid > 0) {
+    while (waitpid(m_pid, nullptr, 0) < 0 && errno == EINTR) {
+    }
+    m_pid = -1;
+  }
+}
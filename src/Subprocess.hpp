@@ -0,0 +1,64 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__SUBPROCESS__HPP
+#define __OPT_DEADLINE__SUBPROCESS__HPP
+
+#include <sys/types.h>
+#include <string>
+#include "PendingCommand.hpp"
+
+/*! A shell command running in background.
+  The command runs in its own process group, so it can be cancelled together
+  with all the processes of its pipeline. Its standard output is collected by
+  'wait'. A subprocess still running at destruction is cancelled.
+ */
+class Subprocess : public PendingCommand {
+ public:
+  //! Launch the command with '/bin/sh -c'
+  explicit Subprocess(const std::string& command);
+
+  ~Subprocess() override { cancel(); }
+
+  Subprocess(const Subprocess&) = delete;
+  Subprocess& operator=(const Subprocess&) = delete;
+
+  //! Wait the end of the command
+  //! \return the standard output of the command
+  std::string wait() override;
+
+  //! Kill the command (and its pipeline). It has no effect if the command is
+  //! already terminated
+  void cancel() noexcept override;
+
+  const std::string& get_command() const noexcept { return m_command; }
+
+  //! \return 'argument' quoted as a single word of '/bin/sh'
+  static std::string quote(const std::string& argument);
+
+  //! \return the descriptor of the standard output of the command (it can
+  //! be polled before calling 'wait')
+  int get_output_descriptor() const noexcept { return m_output_fd; }
+
+ private:
+  std::string m_command;
+  pid_t m_pid = -1;
+  int m_output_fd = -1;
+
+  void reap() noexcept;
+};
+
+#endif  // __OPT_DEADLINE__SUBPROCESS__HPP
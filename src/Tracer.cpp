@@ -0,0 +1,156 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Tracer.hpp"
+#include <opt_common/helper.hpp>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace {
+
+//! Escape a string to be a valid JSON string content
+std::string escape_json(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          // The other control characters are not valid in a JSON string
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x",
+                        static_cast<unsigned>(c));
+          escaped += code;
+        } else {
+          escaped.push_back(c);
+        }
+    }
+  }
+  return escaped;
+}
+
+}  // anonymous namespace
+
+Tracer& Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+auto Tracer::get_thread_buffer() -> ThreadBuffer* {
+  thread_local ThreadBuffer* thread_buffer = nullptr;
+  if (thread_buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+    m_buffers.emplace_back(new ThreadBuffer);
+    thread_buffer = m_buffers.back().get();
+    thread_buffer->m_thread_id = m_buffers.size();
+  }
+  return thread_buffer;
+}
+
+void Tracer::record(TraceEvent event) {
+  get_thread_buffer()->m_events.push_back(std::move(event));
+}
+
+void Tracer::write_json(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (file.fail()) {
+    THROW_RUNTIME_ERROR("Cannot open trace file '" + filename + "'");
+  }
+
+  const auto pid = getpid();
+  bool first_event = true;
+
+  std::lock_guard<std::mutex> lock(m_buffers_mutex);
+  file << "{\"traceEvents\": [";
+  for (const auto& buffer : m_buffers) {
+    for (const auto& event : buffer->m_events) {
+      file << (first_event ? "\n" : ",\n") << "{\"name\": \"" << event.m_name
+           << "\", \"cat\": \"" << event.m_category
+           << "\", \"ph\": \"X\", \"ts\": " << event.m_timestamp_us
+           << ", \"dur\": " << event.m_duration_us << ", \"pid\": " << pid
+           << ", \"tid\": " << buffer->m_thread_id << ", \"args\": {"
+           << event.m_arguments << "}}";
+      first_event = false;
+    }
+  }
+  file << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+Tracer::ScopedSpan::ScopedSpan(const char* name, const char* category)
+    : m_enabled(Tracer::instance().is_enabled()),
+      m_name(name),
+      m_category(category) {
+  if (m_enabled) {
+    m_start = std::chrono::steady_clock::now();
+  }
+}
+
+Tracer::ScopedSpan::~ScopedSpan() {
+  if (m_enabled == false) {
+    return;
+  }
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  auto& tracer = Tracer::instance();
+  const auto end = std::chrono::steady_clock::now();
+  tracer.record(
+      {m_name, m_category,
+       duration_cast<microseconds>(m_start - tracer.m_origin).count(),
+       duration_cast<microseconds>(end - m_start).count(),
+       std::move(m_arguments)});
+}
+
+void Tracer::ScopedSpan::add_argument(const char* key,
+                                      const std::string& value) {
+  if (m_enabled) {
+    m_arguments += (m_arguments.empty() ? "\"" : ", \"");
+    m_arguments += key;
+    m_arguments += "\": \"" + escape_json(value) + "\"";
+  }
+}
+
+void Tracer::ScopedSpan::add_argument(const char* key, double value) {
+  if (m_enabled) {
+    // JSON has no literals for inf and nan
+    std::ostringstream oss;
+    if (std::isfinite(value)) {
+      oss << value;
+    } else {
+      oss << "null";
+    }
+    m_arguments += (m_arguments.empty() ? "\"" : ", \"");
+    m_arguments += key;
+    m_arguments += "\": " + oss.str();
+  }
+}
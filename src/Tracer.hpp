@@ -0,0 +1,98 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__TRACER__HPP
+#define __OPT_DEADLINE__TRACER__HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*! Timeline recorder in Chrome trace-event format (chrome://tracing, Perfetto).
+  Each thread appends its spans into a private buffer, so no lock is taken on
+  the hot path. The buffers are merged when the trace is written, which must
+  happen once all the traced threads have completed their work.
+ */
+class Tracer {
+ public:
+  //! \return the process-wide instance
+  static Tracer& instance();
+
+  void enable() noexcept { m_enabled.store(true, std::memory_order_relaxed); }
+
+  bool is_enabled() const noexcept {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  //! Write all the recorded events into the file 'filename' (JSON format)
+  void write_json(const std::string& filename) const;
+
+  //! RAII span: a complete event from construction to destruction.
+  //! It does nothing if the tracer is not enabled.
+  class ScopedSpan {
+   public:
+    ScopedSpan(const char* name, const char* category);
+    ~ScopedSpan();
+
+    void add_argument(const char* key, const std::string& value);
+    void add_argument(const char* key, double value);
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+   private:
+    bool m_enabled;
+    const char* m_name;
+    const char* m_category;
+    std::chrono::steady_clock::time_point m_start;
+    std::string m_arguments;  // Already formatted as JSON members
+  };
+
+ private:
+  struct TraceEvent {
+    const char* m_name;
+    const char* m_category;
+    std::int64_t m_timestamp_us;
+    std::int64_t m_duration_us;
+    std::string m_arguments;
+  };
+
+  struct ThreadBuffer {
+    unsigned m_thread_id;
+    std::vector<TraceEvent> m_events;
+  };
+
+  std::atomic<bool> m_enabled{false};
+  const std::chrono::steady_clock::time_point m_origin =
+      std::chrono::steady_clock::now();
+
+  // Registration of buffers (only the first event of each thread locks)
+  mutable std::mutex m_buffers_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+  Tracer() = default;
+
+  //! \return the buffer of the calling thread (registered at first call)
+  ThreadBuffer* get_thread_buffer();
+
+  void record(TraceEvent event);
+};
+
+#endif  // __OPT_DEADLINE__TRACER__HPP
@@ -0,0 +1,149 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "Worker.hpp"
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "FineGrain.hpp"
+#include "Subprocess.hpp"
+
+Worker::Worker(const Configuration& configuration,
+               const std::string& config_filename)
+    : m_optIC_command(configuration.get_opt_command()),
+      m_config_filename(config_filename),
+      m_dagSim_script(configuration.get_dagsim_path() + "/" +
+                      FineGrain::DAGSIM_SH),
+      m_tmp_directory((configuration.get_tmp_directory().empty()
+                           ? DEFAULT_TMP
+                           : configuration.get_tmp_directory())) {}
+
+void Worker::serve(const std::string& address, bool allow_remote,
+                   const StopCondition& stop_condition, std::ostream* log) {
+  const int listen_fd = WorkerProtocol::listen_on(address, allow_remote);
+  *log << "Worker > Listening on '" << address << "'" << std::endl;
+
+  while (stop_condition.stop_requested() == false) {
+    pollfd listen_poll{listen_fd, POLLIN, 0};
+    if (poll(&listen_poll, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+
+    const int socket_fd = accept(listen_fd, nullptr, nullptr);
+    if (socket_fd < 0) {
+      continue;
+    }
+    handle_connection(socket_fd, log);
+    close(socket_fd);
+  }
+
+  close(listen_fd);
+  *log << "Worker > Stopped" << std::endl;
+}
+
+void Worker::handle_connection(int socket_fd, std::ostream* log) {
+  try {
+    WorkerProtocol::Job job;
+    if (WorkerProtocol::receive_job(socket_fd, &job) == false) {
+      return;
+    }
+    *log << "Worker > Job " << WorkerProtocol::JobType2String(job.m_type)
+         << " (" << job.m_payload.size() << " bytes)" << std::endl;
+
+    std::string output;
+    if (execute(socket_fd, job, &output, log)) {
+      WorkerProtocol::send_result(socket_fd, true, output);
+    }
+  } catch (const std::exception& error) {
+    *log << "Worker > Error: " << error.what() << std::endl;
+    try {
+      WorkerProtocol::send_result(socket_fd, false, error.what());
+    } catch (const std::exception&) {
+      // The client is gone: nothing to notify
+    }
+  }
+}
+
+bool Worker::execute(int socket_fd, const WorkerProtocol::Job& job,
+                     std::string* output, std::ostream* log) {
+  // The commands are built from the configuration of the worker only
+  if (job.m_argument.empty() == false) {
+    THROW_RUNTIME_ERROR("Unexpected argument of the job");
+  }
+
+  // Write the payload into a temporary file of this worker
+  const std::string extension =
+      job.m_type == WorkerProtocol::JobType::DAGSIM ? ".lua" : "";
+  const std::string input_filename =
+      m_tmp_directory + "/worker_" + std::to_string(getpid()) + "_" +
+      std::to_string(m_job_counter++) + extension;
+  {
+    std::ofstream input_file(input_filename);
+    input_file << job.m_payload;
+    if (input_file.fail()) {
+      THROW_RUNTIME_ERROR("Cannot write the temporary file '" +
+                          input_filename + "'");
+    }
+  }
+
+  const std::string cmd =
+      job.m_type == WorkerProtocol::JobType::DAGSIM
+          ? FineGrain::make_dagSim_command(m_dagSim_script, input_filename)
+          : FineGrain::make_optIC_command(m_optIC_command, input_filename,
+                                          m_config_filename);
+  Subprocess subprocess(cmd);
+
+  // Wait the command, watching if the client closes the connection
+  std::array<pollfd, 2> poll_fds{
+      {{subprocess.get_output_descriptor(), POLLIN, 0},
+       {socket_fd, POLLIN, 0}}};
+  bool cancelled = false;
+  while (true) {
+    if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      THROW_RUNTIME_ERROR("Cannot poll the job of the worker");
+    }
+    if (poll_fds[1].revents != 0) {
+      char c;
+      if (recv(socket_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) <= 0) {
+        cancelled = true;
+        break;
+      }
+      // Unexpected data: stop watching the client
+      poll_fds[1].fd = -1;
+    }
+    if (poll_fds[0].revents != 0) {
+      break;
+    }
+  }
+
+  if (cancelled) {
+    subprocess.cancel();
+    *log << "Worker > Job cancelled by the client" << std::endl;
+  } else {
+    *output = subprocess.wait();
+  }
+  std::remove(input_filename.c_str());
+
+  return cancelled == false;
+}
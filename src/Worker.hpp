@@ -0,0 +1,66 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__WORKER__HPP
+#define __OPT_DEADLINE__WORKER__HPP
+
+#include <opt_common/Application.hpp>
+#include <ostream>
+#include <string>
+#include "StopCondition.hpp"
+#include "WorkerProtocol.hpp"
+
+/*! Remote evaluation worker ('opt_deadline --worker').
+  It serves one job at a time: it runs OPT_IC or dagSim locally (with the
+  commands and the configuration file of the worker, the job provides only
+  the input file) and sends back their output. A job is cancelled when the
+  client closes the connection.
+ */
+class Worker {
+ public:
+  using Configuration = opt_common::Configuration;
+
+  /*! \param configuration    The configuration of the worker
+    \param config_filename  Its file (given to OPT_IC)
+   */
+  Worker(const Configuration& configuration,
+         const std::string& config_filename);
+
+  /*! Serve the jobs received on 'address' until a stop is requested.
+    The jobs are not authenticated: unless 'allow_remote', a TCP address
+    must be a loopback one.
+   */
+  void serve(const std::string& address, bool allow_remote,
+             const StopCondition& stop_condition, std::ostream* log);
+
+ private:
+  static constexpr const char* DEFAULT_TMP = "/tmp";
+  static constexpr int POLL_TIMEOUT_MS = 500;
+
+  std::string m_optIC_command;
+  std::string m_config_filename;
+  std::string m_dagSim_script;
+  std::string m_tmp_directory;
+  unsigned m_job_counter = 0;
+
+  void handle_connection(int socket_fd, std::ostream* log);
+
+  //! Run the job. \return 'false' if the client cancelled the job
+  bool execute(int socket_fd, const WorkerProtocol::Job& job,
+               std::string* output, std::ostream* log);
+};
+
+#endif  // __OPT_DEADLINE__WORKER__HPP
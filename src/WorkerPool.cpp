@@ -0,0 +1,271 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "WorkerPool.hpp"
+#include <opt_common/helper.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include "Statistics.hpp"
+
+namespace {
+
+std::exception_ptr make_error(const std::string& message) {
+  return std::make_exception_ptr(std::runtime_error(message));
+}
+
+}  // anonymous namespace
+
+//! A submitted job, shared by its command and by the thread serving it
+struct WorkerPool::JobState {
+  explicit JobState(WorkerProtocol::Job job) : m_job(std::move(job)) {}
+
+  //! Store the result (only the first one counts) and wake up 'wait'
+  void complete(const std::string& output, std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_done) {
+      return;
+    }
+    m_done = true;
+    m_output = output;
+    m_error = std::move(error);
+    m_completed.notify_all();
+  }
+
+  bool is_cancelled() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cancelled;
+  }
+
+  //! \return 'false' if the job has been cancelled
+  bool set_socket(int socket_fd) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_socket_fd = m_cancelled ? -1 : socket_fd;
+    return m_cancelled == false;
+  }
+
+  void clear_socket() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_socket_fd = -1;
+  }
+
+  const WorkerProtocol::Job m_job;
+  std::mutex m_mutex;
+  std::condition_variable m_completed;
+  bool m_done = false;
+  std::string m_output;
+  std::exception_ptr m_error;
+  bool m_cancelled = false;
+  int m_socket_fd = -1;
+};
+
+//! A job running on the workers
+class WorkerPool::RemoteCommand : public PendingCommand {
+ public:
+  RemoteCommand(WorkerPool* pool, std::shared_ptr<JobState> state)
+      : m_pool(pool), m_state(std::move(state)) {}
+
+  ~RemoteCommand() override { cancel(); }
+
+  std::string wait() override {
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    m_state->m_completed.wait(lock, [this]() { return m_state->m_done; });
+    if (m_state->m_error) {
+      std::rethrow_exception(m_state->m_error);
+    }
+    return m_state->m_output;
+  }
+
+  void cancel() noexcept override {
+    {
+      std::lock_guard<std::mutex> lock(m_state->m_mutex);
+      if (m_state->m_done) {
+        return;
+      }
+      m_state->m_cancelled = true;
+      if (m_state->m_socket_fd >= 0) {
+        shutdown(m_state->m_socket_fd, SHUT_RDWR);
+      }
+    }
+    // A job still in the queue is never taken by a worker
+    if (m_pool->dequeue(*m_state)) {
+      m_state->complete("", make_error("The job has been cancelled"));
+    }
+  }
+
+ private:
+  WorkerPool* m_pool;
+  std::shared_ptr<JobState> m_state;
+};
+
+WorkerPool::WorkerPool(const std::string& addresses, std::ostream* log)
+    : m_log(log) {
+  std::istringstream iss(addresses);
+  std::string address;
+  while (std::getline(iss, address, ',')) {
+    if (address.empty() == false) {
+      m_workers.push_back({address, true});
+    }
+  }
+  if (m_workers.empty()) {
+    THROW_RUNTIME_ERROR("The list of workers '" + addresses + "' is empty");
+  }
+
+  m_alive_workers = m_workers.size();
+  m_threads.reserve(m_workers.size());
+  for (std::size_t i = 0; i < m_workers.size(); ++i) {
+    m_threads.emplace_back(&WorkerPool::serve_worker, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  std::deque<std::shared_ptr<JobState>> pending_jobs;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    pending_jobs.swap(m_queue);
+    m_job_available.notify_all();
+  }
+  for (const auto& state : pending_jobs) {
+    state->complete("", make_error("The pool of workers has been stopped"));
+  }
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+std::unique_ptr<PendingCommand> WorkerPool::submit(WorkerProtocol::Job job) {
+  auto state = std::make_shared<JobState>(std::move(job));
+  bool queued = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_alive_workers > 0) {
+      m_queue.push_back(state);
+      m_job_available.notify_one();
+      queued = true;
+    }
+  }
+  if (queued == false) {
+    state->complete("", make_error("No worker is available"));
+  }
+  return std::unique_ptr<PendingCommand>(
+      new RemoteCommand(this, std::move(state)));
+}
+
+void WorkerPool::serve_worker(std::size_t index) {
+  while (true) {
+    std::shared_ptr<JobState> state;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_job_available.wait(lock, [this]() {
+        return m_stopping || m_queue.empty() == false;
+      });
+      if (m_stopping) {
+        return;
+      }
+      state = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    if (execute(index, state.get()) == false) {
+      lose_worker(index, std::move(state));
+      return;
+    }
+  }
+}
+
+bool WorkerPool::execute(std::size_t index, JobState* state) {
+  const std::string& address = m_workers[index].m_address;
+  int socket_fd = -1;
+  try {
+    if (state->is_cancelled()) {
+      THROW_RUNTIME_ERROR("The job has been cancelled");
+    }
+    socket_fd = WorkerProtocol::connect_to(address);
+    if (state->set_socket(socket_fd) == false) {
+      THROW_RUNTIME_ERROR("The job has been cancelled");
+    }
+    WorkerProtocol::send_job(socket_fd, state->m_job);
+    const std::string output = WorkerProtocol::receive_result(socket_fd);
+
+    state->clear_socket();
+    close(socket_fd);
+    Statistics::instance().increment(Statistics::Counter::WORKER_JOBS);
+    state->complete(output, nullptr);
+    return true;
+  } catch (const WorkerProtocol::JobError&) {
+    // The job failed, not the worker
+    state->clear_socket();
+    close(socket_fd);
+    state->complete("", std::current_exception());
+    return true;
+  } catch (const std::exception& error) {
+    state->clear_socket();
+    if (socket_fd >= 0) {
+      close(socket_fd);
+    }
+    if (state->is_cancelled()) {
+      state->complete("", std::current_exception());
+      return true;
+    }
+
+    // The worker is lost: the job goes back in the queue
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *m_log << "WorkerPool > Worker '" << address
+           << "' failed: " << error.what() << ". Re-queueing the "
+           << WorkerProtocol::JobType2String(state->m_job.m_type) << " job\n";
+    return false;
+  }
+}
+
+void WorkerPool::lose_worker(std::size_t index,
+                             std::shared_ptr<JobState> state) {
+  Statistics::instance().increment(Statistics::Counter::WORKER_REQUEUED_JOBS);
+  std::deque<std::shared_ptr<JobState>> failed_jobs;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_workers[index].m_alive = false;
+    --m_alive_workers;
+    if (m_alive_workers > 0) {
+      m_queue.push_front(std::move(state));
+      m_job_available.notify_one();
+      return;
+    }
+    failed_jobs.swap(m_queue);
+    failed_jobs.push_front(std::move(state));
+  }
+  for (const auto& failed_state : failed_jobs) {
+    failed_state->complete("", make_error("No worker is available"));
+  }
+}
+
+bool WorkerPool::dequeue(const JobState& state) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = std::find_if(
+      m_queue.begin(), m_queue.end(),
+      [&state](const std::shared_ptr<JobState>& queued) {
+        return queued.get() == &state;
+      });
+  if (it == m_queue.end()) {
+    return false;
+  }
+  m_queue.erase(it);
+  return true;
+}
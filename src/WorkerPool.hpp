@@ -0,0 +1,91 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__WORKER_POOL__HPP
+#define __OPT_DEADLINE__WORKER_POOL__HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PendingCommand.hpp"
+#include "WorkerProtocol.hpp"
+
+/*! Dispatcher of OPT_IC/dagSim jobs to a list of remote workers.
+  The submitted jobs wait in a queue, served by one thread for each worker:
+  each worker executes one job at a time and an idle worker takes the next
+  job. If a worker fails (connection refused or closed) it is excluded and
+  its job is re-queued on the others; a failure reported by the worker for
+  the job itself is given back to the caller. It is thread safe.
+ */
+class WorkerPool {
+ public:
+  /*! \param addresses  Comma separated list of worker addresses
+    \param log         The stream where worker failures will be written
+   */
+  WorkerPool(const std::string& addresses, std::ostream* log);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  //! Send the job to the workers (asynchronously)
+  std::unique_ptr<PendingCommand> submit(WorkerProtocol::Job job);
+
+  std::size_t get_number_of_workers() const noexcept {
+    return m_workers.size();
+  }
+
+ private:
+  class RemoteCommand;
+  struct JobState;
+
+  struct WorkerState {
+    std::string m_address;
+    bool m_alive;
+  };
+
+  std::ostream* m_log;
+  std::mutex m_mutex;
+  std::condition_variable m_job_available;
+  std::deque<std::shared_ptr<JobState>> m_queue;
+  std::vector<WorkerState> m_workers;
+  std::size_t m_alive_workers;
+  bool m_stopping = false;
+  std::vector<std::thread> m_threads;
+
+  //! Serve the queued jobs on the worker 'index' until it fails
+  void serve_worker(std::size_t index);
+
+  //! Execute the job on the worker 'index'
+  //! \return 'false' if the worker has been lost (the job is not completed)
+  bool execute(std::size_t index, JobState* state);
+
+  //! Exclude the worker 'index' and re-queue its job. When no worker is
+  //! left the queued jobs fail
+  void lose_worker(std::size_t index, std::shared_ptr<JobState> state);
+
+  //! Remove the job from the queue. \return 'false' if it is not queued
+  bool dequeue(const JobState& state);
+};
+
+#endif  // __OPT_DEADLINE__WORKER_POOL__HPP
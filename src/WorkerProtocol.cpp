@@ -0,0 +1,293 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "WorkerProtocol.hpp"
+#include <opt_common/helper.hpp>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+constexpr const char* UNIX_PREFIX = "unix:";
+constexpr int LISTEN_BACKLOG = 16;
+
+bool is_unix_address(const std::string& address) {
+  return address.compare(0, std::strlen(UNIX_PREFIX), UNIX_PREFIX) == 0;
+}
+
+sockaddr_un make_unix_address(const std::string& address) {
+  const std::string path = address.substr(std::strlen(UNIX_PREFIX));
+  sockaddr_un unix_address{};
+  if (path.empty() || path.size() >= sizeof(unix_address.sun_path)) {
+    THROW_RUNTIME_ERROR("The unix socket path '" + path + "' is not valid");
+  }
+  unix_address.sun_family = AF_UNIX;
+  std::strcpy(unix_address.sun_path, path.c_str());
+  return unix_address;
+}
+
+//! Resolve 'HOST:PORT' (a '*' host means any address, an empty one the
+//! loopback)
+addrinfo* resolve_tcp_address(const std::string& address, bool passive) {
+  const auto separator = address.rfind(':');
+  if (separator == std::string::npos) {
+    THROW_RUNTIME_ERROR("The address '" + address +
+                        "' is not in the format 'HOST:PORT' or 'unix:PATH'");
+  }
+  const std::string host = address.substr(0, separator);
+  const std::string port = address.substr(separator + 1);
+
+  const bool any_address = passive && host == "*";
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = any_address ? AI_PASSIVE : 0;
+
+  addrinfo* result = nullptr;
+  const int status =
+      getaddrinfo(any_address ? nullptr
+                              : (host.empty() ? "localhost" : host.c_str()),
+                  port.c_str(), &hints, &result);
+  if (status != 0) {
+    THROW_RUNTIME_ERROR("Cannot resolve the address '" + address +
+                        "': " + gai_strerror(status));
+  }
+  return result;
+}
+
+bool is_loopback(const sockaddr* address) {
+  if (address->sa_family == AF_INET) {
+    const auto* ipv4 = reinterpret_cast<const sockaddr_in*>(address);
+    return (ntohl(ipv4->sin_addr.s_addr) >> 24) == 127;
+  }
+  if (address->sa_family == AF_INET6) {
+    const auto* ipv6 = reinterpret_cast<const sockaddr_in6*>(address);
+    return IN6_IS_ADDR_LOOPBACK(&ipv6->sin6_addr);
+  }
+  return false;
+}
+
+}  // anonymous namespace
+
+int WorkerProtocol::connect_to(const std::string& address) {
+  if (is_unix_address(address)) {
+    const auto unix_address = make_unix_address(address);
+    const int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_fd < 0 ||
+        connect(socket_fd, reinterpret_cast<const sockaddr*>(&unix_address),
+                sizeof(unix_address)) != 0) {
+      if (socket_fd >= 0) {
+        close(socket_fd);
+      }
+      THROW_RUNTIME_ERROR("Cannot connect to the worker '" + address + "'");
+    }
+    return socket_fd;
+  }
+
+  addrinfo* addresses = resolve_tcp_address(address, false);
+  int socket_fd = -1;
+  for (addrinfo* it = addresses; it != nullptr && socket_fd < 0;
+       it = it->ai_next) {
+    socket_fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+    if (socket_fd >= 0 &&
+        connect(socket_fd, it->ai_addr, it->ai_addrlen) != 0) {
+      close(socket_fd);
+      socket_fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+
+  if (socket_fd < 0) {
+    THROW_RUNTIME_ERROR("Cannot connect to the worker '" + address + "'");
+  }
+  return socket_fd;
+}
+
+int WorkerProtocol::listen_on(const std::string& address,
+                              bool allow_remote) {
+  int socket_fd = -1;
+  if (is_unix_address(address)) {
+    const auto unix_address = make_unix_address(address);
+    unlink(unix_address.sun_path);
+    socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_fd >= 0 &&
+        bind(socket_fd, reinterpret_cast<const sockaddr*>(&unix_address),
+             sizeof(unix_address)) != 0) {
+      close(socket_fd);
+      socket_fd = -1;
+    }
+  } else {
+    addrinfo* addresses = resolve_tcp_address(address, true);
+    for (addrinfo* it = addresses; it != nullptr && socket_fd < 0;
+         it = it->ai_next) {
+      if (allow_remote == false && is_loopback(it->ai_addr) == false) {
+        freeaddrinfo(addresses);
+        THROW_RUNTIME_ERROR("The address '" + address +
+                            "' is reachable from other hosts: the jobs are "
+                            "not authenticated, use '--allow-remote' to "
+                            "listen on it anyway");
+      }
+      socket_fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+      if (socket_fd < 0) {
+        continue;
+      }
+      const int reuse = 1;
+      setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+      if (bind(socket_fd, it->ai_addr, it->ai_addrlen) != 0) {
+        close(socket_fd);
+        socket_fd = -1;
+      }
+    }
+    freeaddrinfo(addresses);
+  }
+
+  if (socket_fd < 0 || listen(socket_fd, LISTEN_BACKLOG) != 0) {
+    if (socket_fd >= 0) {
+      close(socket_fd);
+    }
+    THROW_RUNTIME_ERROR("Cannot listen on the address '" + address + "'");
+  }
+  return socket_fd;
+}
+
+void WorkerProtocol::send_job(int socket_fd, const Job& job) {
+  write_all(socket_fd, std::string(JobType2String(job.m_type)) + '\n' +
+                           job.m_argument + '\n' +
+                           std::to_string(job.m_payload.size()) + '\n' +
+                           job.m_payload);
+}
+
+bool WorkerProtocol::receive_job(int socket_fd, Job* job) {
+  std::string type;
+  if (read_line(socket_fd, &type) == false) {
+    return false;
+  }
+  if (type == JobType2String(JobType::OPT_IC)) {
+    job->m_type = JobType::OPT_IC;
+  } else if (type == JobType2String(JobType::DAGSIM)) {
+    job->m_type = JobType::DAGSIM;
+  } else {
+    THROW_RUNTIME_ERROR("Unknown job type '" + type + "'");
+  }
+
+  std::string size;
+  if (read_line(socket_fd, &job->m_argument) == false ||
+      read_line(socket_fd, &size) == false) {
+    THROW_RUNTIME_ERROR("Truncated job request");
+  }
+  read_exactly(socket_fd, std::stoul(size), &job->m_payload);
+  return true;
+}
+
+void WorkerProtocol::send_result(int socket_fd, bool success,
+                                 const std::string& output) {
+  write_all(socket_fd, std::string(success ? "OK" : "ERROR") + '\n' +
+                           std::to_string(output.size()) + '\n' + output);
+}
+
+std::string WorkerProtocol::receive_result(int socket_fd) {
+  std::string status;
+  std::string size;
+  if (read_line(socket_fd, &status) == false ||
+      read_line(socket_fd, &size) == false) {
+    THROW_RUNTIME_ERROR("The worker closed the connection");
+  }
+
+  std::string output;
+  read_exactly(socket_fd, std::stoul(size), &output);
+  if (status != "OK") {
+    throw JobError("The worker failed: " + output);
+  }
+  return output;
+}
+
+const char* WorkerProtocol::JobType2String(JobType job_type) {
+  switch (job_type) {
+    case JobType::OPT_IC:
+      return "OPT_IC";
+    case JobType::DAGSIM:
+      return "DAGSIM";
+  }
+  THROW_RUNTIME_ERROR("Job type not recognized");
+}
+
+void WorkerProtocol::write_all(int socket_fd, const std::string& data) {
+  std::size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t size = send(socket_fd, data.data() + written,
+                              data.size() - written, MSG_NOSIGNAL);
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size <= 0) {
+      THROW_RUNTIME_ERROR("Cannot send data on the socket");
+    }
+    written += size;
+  }
+}
+
+bool WorkerProtocol::read_line(int socket_fd, std::string* line) {
+  line->clear();
+  char c;
+  while (true) {
+    const ssize_t size = recv(socket_fd, &c, 1, 0);
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size < 0) {
+      THROW_RUNTIME_ERROR("Cannot receive data from the socket");
+    }
+    if (size == 0) {
+      if (line->empty()) {
+        return false;
+      }
+      THROW_RUNTIME_ERROR("Truncated message");
+    }
+    if (c == '\n') {
+      return true;
+    }
+    line->push_back(c);
+  }
+}
+
+void WorkerProtocol::read_exactly(int socket_fd, std::size_t size,
+                                  std::string* data) {
+  static constexpr std::size_t SIZE_BUFFER = 4096;
+  std::array<char, SIZE_BUFFER> buffer;
+
+  data->clear();
+  data->reserve(size);
+  while (data->size() < size) {
+    const ssize_t read_size =
+        recv(socket_fd, buffer.data(),
+             std::min(buffer.size(), size - data->size()), 0);
+    if (read_size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read_size <= 0) {
+      THROW_RUNTIME_ERROR("Truncated message");
+    }
+    data->append(buffer.data(), read_size);
+  }
+}
@@ -0,0 +1,82 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__WORKER_PROTOCOL__HPP
+#define __OPT_DEADLINE__WORKER_PROTOCOL__HPP
+
+#include <stdexcept>
+#include <string>
+
+/*! Wire protocol between OPT_Deadline and its remote evaluation workers.
+  Each connection carries exactly one job:
+    request:  "<JOB TYPE>\n<ARGUMENT>\n<PAYLOAD SIZE>\n<PAYLOAD>"
+    response: "(OK|ERROR)\n<OUTPUT SIZE>\n<OUTPUT>"
+  Addresses are either 'HOST:PORT' (TCP) or 'unix:PATH' (unix socket).
+  The worker builds the commands from its own configuration: a job carries
+  only data, never a path or a command line.
+ */
+class WorkerProtocol {
+ public:
+  enum class JobType {
+    OPT_IC,  // Argument: unused (empty); payload: OPT_IC input file
+    DAGSIM   // Argument: unused (empty); payload: LUA file
+  };
+
+  //! Failure reported by the worker for the job itself (the worker is alive)
+  class JobError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+  };
+
+  struct Job {
+    JobType m_type;
+    std::string m_argument;
+    std::string m_payload;
+  };
+
+  //! Connect to a worker. \return the socket descriptor
+  static int connect_to(const std::string& address);
+
+  /*! Create a listening socket. Unless 'allow_remote', a TCP address must
+    be a loopback one (an empty host is the loopback).
+    \return the socket descriptor
+   */
+  static int listen_on(const std::string& address, bool allow_remote);
+
+  static void send_job(int socket_fd, const Job& job);
+
+  //! \return 'false' if the peer closed the connection before the job
+  static bool receive_job(int socket_fd, Job* job);
+
+  static void send_result(int socket_fd, bool success,
+                          const std::string& output);
+
+  //! \return the output of the job. It throws JobError if the worker
+  //! reports a failure of the job, std::runtime_error on transport errors
+  static std::string receive_result(int socket_fd);
+
+  static const char* JobType2String(JobType job_type);
+
+ private:
+  static void write_all(int socket_fd, const std::string& data);
+
+  //! \return 'false' on end of stream
+  static bool read_line(int socket_fd, std::string* line);
+
+  static void read_exactly(int socket_fd, std::size_t size, std::string* data);
+};
+
+#endif  // __OPT_DEADLINE__WORKER_PROTOCOL__HPP
@@ -18,12 +18,222 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <sstream>
 #include <string>
-#include "Algorithm1.hpp"
-#include "Algorithm2.hpp"
+#include <vector>
+#include "ApplicationRegistry.hpp"
+#include "CoreBudgetSearch.hpp"
+#include "HierarchicalSolver.hpp"
+#include "OptDeadlineSolver.hpp"
 #include "Process.hpp"
+#include "ResponseTableBuilder.hpp"
+#include "SolverOptions.hpp"
+#include "Statistics.hpp"
+#include "StreamingOptimizer.hpp"
+#include "Tracer.hpp"
+#include "Worker.hpp"
+#include "WorkerPool.hpp"
 
-enum class AlgorithmSelection { ALGORITHM_1, ALGORITHM_2, ALGORITHM_12 };
+using AlgorithmSelection = OptDeadlineSolver::AlgorithmSelection;
+
+double parse_positive_number(const std::string& number_str) {
+  try {
+    const double number = std::stod(number_str);
+    if (number > 0.0) {
+      return number;
+    }
+  } catch (const std::invalid_argument&) {
+  }
+  THROW_RUNTIME_ERROR("The value '" + number_str +
+                      "' is not a positive number");
+}
+
+//! Optional command line arguments (after the positional ones)
+struct OptionalArguments {
+  std::string m_stats_json_filename;  // Empty if JSON stats are not requested
+  std::string m_trace_filename;       // Empty if the trace is not requested
+  unsigned m_precompute_points = 0;   // Zero if the precompute is disabled
+  double m_precompute_tolerance = 0.02;
+  std::string m_stream_filename;      // Empty if the stream mode is disabled
+  unsigned m_number_of_groups = 0;    // Zero if the hierarchical mode is off
+  bool m_compare_flat = false;        // Solve also without groups
+  bool m_critical_path = false;       // Analytic estimators of the DAGs
+  std::string m_record_filename;      // Empty if evaluations are not recorded
+  std::string m_replay_filename;      // Empty if evaluations are not replayed
+  bool m_replay_latency = false;      // Delay the replayed answers
+  std::string m_batch_filename;       // Empty if a single process is solved
+  double m_core_budget = 0;           // Zero if the dual mode is off
+  SolverOptions m_solver_options;
+};
+
+OptionalArguments parse_optional_arguments(int argc, char* argv[],
+                                           int first_index) {
+  OptionalArguments optional_arguments;
+  for (int i = first_index; i < argc; ++i) {
+    const std::string option = argv[i];
+    if (option == "--stats-json") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_stats_json_filename = argv[++i];
+    } else if (option == "--trace") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_trace_filename = argv[++i];
+    } else if (option == "--checkpoint") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_solver_options.m_checkpoint_filename = argv[++i];
+    } else if (option == "--warm-start") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_solver_options.m_warm_start_filename = argv[++i];
+    } else if (option == "--time-budget") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_solver_options.m_stop_condition->set_time_budget(
+          parse_positive_number(argv[++i]));
+    } else if (option == "--screening-jobs") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_solver_options.m_screening_max_jobs =
+          static_cast<unsigned>(parse_positive_number(argv[++i]));
+    } else if (option == "--speculative-dagsim") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_solver_options.m_max_speculative_dagSims =
+          static_cast<unsigned>(parse_positive_number(argv[++i]));
+    } else if (option == "--workers") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option +
+                            "' requires a list of addresses");
+      }
+      optional_arguments.m_solver_options.m_worker_pool =
+          std::make_shared<WorkerPool>(argv[++i], &std::cout);
+    } else if (option == "--precompute") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_precompute_points =
+          static_cast<unsigned>(parse_positive_number(argv[++i]));
+    } else if (option == "--precompute-tolerance") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_precompute_tolerance =
+          parse_positive_number(argv[++i]);
+    } else if (option == "--stream") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option +
+                            "' requires a filename (or '-')");
+      }
+      optional_arguments.m_stream_filename = argv[++i];
+    } else if (option == "--groups") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_number_of_groups =
+          static_cast<unsigned>(parse_positive_number(argv[++i]));
+    } else if (option == "--compare-flat") {
+      optional_arguments.m_compare_flat = true;
+    } else if (option == "--critical-path") {
+      optional_arguments.m_critical_path = true;
+    } else if (option == "--record") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_record_filename = argv[++i];
+    } else if (option == "--replay") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_replay_filename = argv[++i];
+    } else if (option == "--replay-latency") {
+      optional_arguments.m_replay_latency = true;
+    } else if (option == "--native-core-search") {
+      optional_arguments.m_solver_options.m_native_core_search = true;
+    } else if (option == "--batch-optic") {
+      optional_arguments.m_solver_options.m_batch_optIC = true;
+    } else if (option == "--search-time") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_solver_options.m_search_time_limit =
+          parse_positive_number(argv[++i]);
+    } else if (option == "--gap") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_solver_options.m_gap_threshold =
+          parse_positive_number(argv[++i]);
+    } else if (option == "--batch") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a filename");
+      }
+      optional_arguments.m_batch_filename = argv[++i];
+    } else if (option == "--core-budget") {
+      if (i + 1 >= argc) {
+        THROW_RUNTIME_ERROR("Option '" + option + "' requires a value");
+      }
+      optional_arguments.m_core_budget = parse_positive_number(argv[++i]);
+    } else if (option == "--resume") {
+      optional_arguments.m_solver_options.m_resume = true;
+    } else {
+      THROW_RUNTIME_ERROR("Option '" + option + "' not recognized");
+    }
+  }
+
+  if (optional_arguments.m_solver_options.m_resume &&
+      optional_arguments.m_solver_options.m_checkpoint_filename.empty()) {
+    THROW_RUNTIME_ERROR("Option '--resume' requires '--checkpoint FILE'");
+  }
+  if (optional_arguments.m_number_of_groups > 0 &&
+      optional_arguments.m_solver_options.m_checkpoint_filename.empty() ==
+          false) {
+    THROW_RUNTIME_ERROR("Option '--checkpoint' cannot be used with '--groups'");
+  }
+  if (optional_arguments.m_compare_flat &&
+      optional_arguments.m_number_of_groups == 0) {
+    THROW_RUNTIME_ERROR("Option '--compare-flat' requires '--groups K'");
+  }
+  if (optional_arguments.m_record_filename.empty() == false &&
+      optional_arguments.m_replay_filename.empty() == false) {
+    THROW_RUNTIME_ERROR("Options '--record' and '--replay' cannot be used "
+                        "together");
+  }
+  if (optional_arguments.m_solver_options.m_native_core_search &&
+      optional_arguments.m_solver_options.m_max_speculative_dagSims > 0) {
+    THROW_RUNTIME_ERROR("Option '--native-core-search' cannot be used with "
+                        "'--speculative-dagsim'");
+  }
+  if (optional_arguments.m_batch_filename.empty() == false &&
+      (optional_arguments.m_solver_options.m_checkpoint_filename.empty() ==
+           false ||
+       optional_arguments.m_stream_filename.empty() == false)) {
+    THROW_RUNTIME_ERROR("Option '--batch' cannot be used with '--checkpoint' "
+                        "or '--stream'");
+  }
+  if (optional_arguments.m_core_budget > 0 &&
+      (optional_arguments.m_number_of_groups > 0 ||
+       optional_arguments.m_solver_options.m_checkpoint_filename.empty() ==
+           false ||
+       optional_arguments.m_stream_filename.empty() == false)) {
+    THROW_RUNTIME_ERROR("Option '--core-budget' cannot be used with "
+                        "'--groups', '--checkpoint' or '--stream'");
+  }
+  if (optional_arguments.m_replay_latency &&
+      optional_arguments.m_replay_filename.empty()) {
+    THROW_RUNTIME_ERROR("Option '--replay-latency' requires '--replay FILE'");
+  }
+
+  return optional_arguments;
+}
 
 AlgorithmSelection parse_algorithm_selection_from_cmd_line(
     const std::string& cmd_option) {
@@ -33,6 +243,9 @@ AlgorithmSelection parse_algorithm_selection_from_cmd_line(
   if (cmd_option == "-2") {
     return AlgorithmSelection::ALGORITHM_2;
   }
+  if (cmd_option == "-3") {
+    return AlgorithmSelection::ALGORITHM_3;
+  }
   if (cmd_option == "-12") {
     return AlgorithmSelection::ALGORITHM_12;
   }
@@ -45,6 +258,10 @@ std::string AlgorithmType2String(AlgorithmSelection algorithm_type) {
       return "Algorithm1";
     case AlgorithmSelection::ALGORITHM_2:
       return "Algorithm2";
+    case AlgorithmSelection::ALGORITHM_3:
+      return "Algorithm3";
+    case AlgorithmSelection::ALGORITHM_12:
+      return "Algorithm12";
     default:
       THROW_RUNTIME_ERROR("Algorithm type not recognized");
   }
@@ -94,58 +311,297 @@ std::ofstream generate_result_file(AlgorithmSelection algorithm_type,
   return file;
 }
 
+//! A process to solve: its data input file and its total deadline
+struct ProcessToSolve {
+  std::string m_data_filename;
+  opt_common::TimeInstant m_total_deadline;
+};
+
+//! \return the processes listed in the batch file: a data input file for
+//! each line, optionally followed by its total deadline ('default_deadline'
+//! if it is missing)
+std::vector<ProcessToSolve> read_batch_file(
+    const std::string& batch_filename,
+    opt_common::TimeInstant default_deadline) {
+  std::ifstream ifs{batch_filename};
+  if (ifs.fail()) {
+    THROW_RUNTIME_ERROR("Impossible open the file '" + batch_filename + "'");
+  }
+
+  std::vector<ProcessToSolve> processes;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    // Skip empty line and if starts with dash
+    if (line.empty() || line.at(0) == '#') {
+      continue;
+    }
+    std::istringstream iss{line};
+    ProcessToSolve process_to_solve{"", default_deadline};
+    std::string deadline_str;
+    if (!(iss >> process_to_solve.m_data_filename)) {
+      continue;
+    }
+    if (iss >> deadline_str) {
+      process_to_solve.m_total_deadline =
+          parse_total_deadline_process(deadline_str);
+    }
+    processes.push_back(std::move(process_to_solve));
+  }
+  return processes;
+}
+
+//! Solve a process (and re-optimize it for the change events, if any),
+//! writing its own result file
+//! \return 'true' if the algorithms have succeeded
+bool solve_process(const ProcessToSolve& process_to_solve,
+                   const std::string& config_filename,
+                   const opt_common::Configuration& opt_deadline_conf,
+                   AlgorithmSelection algorithm_type,
+                   OptionalArguments* optional_arguments_ptr) {
+  auto& optional_arguments = *optional_arguments_ptr;
+  auto& solver_options = optional_arguments.m_solver_options;
+
+  // Create process
+  auto process = Process::create_process(
+      process_to_solve.m_data_filename, config_filename,
+      process_to_solve.m_total_deadline,
+      solver_options.m_application_registry.get());
+
+  // Precompute the response tables of the applications
+  if (optional_arguments.m_precompute_points > 0) {
+    solver_options.m_response_tables =
+        std::make_shared<const ResponseTables>(ResponseTableBuilder::build(
+            opt_deadline_conf, solver_options, process,
+            optional_arguments.m_precompute_points,
+            optional_arguments.m_precompute_tolerance, &std::cout));
+  }
+
+  // Parse the DAGs of the LUA templates
+  if (optional_arguments.m_critical_path) {
+    solver_options.m_critical_path_estimators =
+        std::make_shared<const CriticalPathEstimators>(
+            CriticalPathEstimators::build(process, &std::cout));
+  }
+
+  auto result_log = generate_result_file(
+      algorithm_type, &std::cout,
+      std::chrono::system_clock::now().time_since_epoch().count());
+
+  // Launch algorithm class in according to type
+  const auto solve = [&](Process* process_to_solve, std::ostream* log,
+                         std::ostream* algorithm_result_log) {
+    return OptDeadlineSolver::run_algorithms(
+        algorithm_type, opt_deadline_conf, solver_options, process_to_solve,
+        log, algorithm_result_log);
+  };
+  const auto solve_with_options =
+      [&](const SolverOptions& options, Process* process_to_solve,
+          std::ostream* log, std::ostream* algorithm_result_log) {
+        return OptDeadlineSolver::run_algorithms(
+            algorithm_type, opt_deadline_conf, options, process_to_solve, log,
+            algorithm_result_log);
+      };
+  bool status_algorithm = false;
+  if (optional_arguments.m_core_budget > 0) {
+    // Dual mode: shortest total deadline within the core budget
+    CoreBudgetSearch core_budget_search(solver_options,
+                                        optional_arguments.m_core_budget);
+    status_algorithm = core_budget_search.process(
+        solve_with_options, &process, &std::cout, &result_log);
+
+    std::ostringstream report;
+    if (status_algorithm == true) {
+      report << "Core budget " << optional_arguments.m_core_budget
+             << ": shortest deadline " << process.get_total_deadline()
+             << "; objective " << process.compute_global_objective_function()
+             << '\n';
+    } else {
+      report << "Core budget " << optional_arguments.m_core_budget
+             << ": no deadline found within the budget\n";
+    }
+    std::cout << report.str();
+    result_log << report.str();
+  } else if (optional_arguments.m_number_of_groups == 0) {
+    status_algorithm = solve(&process, &std::cout, &result_log);
+  } else {
+    // Hierarchical mode (and flat mode on a copy of the process to compare)
+    Process flat_process;
+    if (optional_arguments.m_compare_flat) {
+      flat_process = process;
+    }
+
+    HierarchicalSolver hierarchical_solver(
+        solver_options, optional_arguments.m_number_of_groups);
+    const auto start_time = std::chrono::steady_clock::now();
+    status_algorithm =
+        hierarchical_solver.process(solve_with_options, &process, &std::cout,
+                                    &result_log);
+    const std::chrono::duration<double> hierarchical_time =
+        std::chrono::steady_clock::now() - start_time;
+
+    std::ostringstream report;
+    report << "Hierarchical solver (" << optional_arguments.m_number_of_groups
+           << " groups): objective "
+           << process.compute_global_objective_function() << "; solve time "
+           << hierarchical_time.count() << " s\n";
+
+    if (status_algorithm == true && optional_arguments.m_compare_flat &&
+        solver_options.m_stop_condition->stop_requested() == false) {
+      // The logs (and the dagSim result file) of the flat solver are
+      // discarded
+      std::ostream discarded_log(nullptr);
+      SolverOptions flat_options = solver_options;
+      flat_options.m_dagSim_result_filename.clear();
+      const auto flat_start_time = std::chrono::steady_clock::now();
+      const bool flat_status = solve_with_options(
+          flat_options, &flat_process, &discarded_log, &discarded_log);
+      const std::chrono::duration<double> flat_time =
+          std::chrono::steady_clock::now() - flat_start_time;
+      if (flat_status == true) {
+        report << "Flat solver: objective "
+               << flat_process.compute_global_objective_function()
+               << "; solve time " << flat_time.count() << " s\n";
+      } else {
+        report << "Flat solver failed\n";
+      }
+    }
+    std::cout << report.str();
+    result_log << report.str();
+  }
+
+  // Best allocation found so far if the algorithms have been stopped
+  if (solver_options.m_stop_condition->stop_requested()) {
+    std::cout << "Algorithms stopped before completion: the solution is "
+                 "partial\n";
+    process.dump_process(&result_log,
+                         "Partial solution (time budget expired or stop "
+                         "requested)");
+  } else if (status_algorithm == true &&
+             optional_arguments.m_stream_filename.empty() == false) {
+    // Re-optimize incrementally for the change events
+    StreamingOptimizer streaming_optimizer(solver_options);
+    if (optional_arguments.m_stream_filename == "-") {
+      streaming_optimizer.process(&std::cin, &process, &std::cout,
+                                  &result_log);
+    } else {
+      std::ifstream events(optional_arguments.m_stream_filename);
+      if (events.fail()) {
+        THROW_RUNTIME_ERROR("Impossible open the file '" +
+                            optional_arguments.m_stream_filename + "'");
+      }
+      streaming_optimizer.process(&events, &process, &std::cout, &result_log);
+    }
+  }
+
+  result_log.close();
+
+  return status_algorithm;
+}
+
 int main(int argc, char* argv[]) {
+  // Remote evaluation worker
+  if ((argc == 4 || argc == 5) && std::string(argv[1]) == "--worker") {
+    bool allow_remote = false;
+    if (argc == 5) {
+      if (std::string(argv[4]) != "--allow-remote") {
+        THROW_RUNTIME_ERROR("Option '" + std::string(argv[4]) +
+                            "' not recognized");
+      }
+      allow_remote = true;
+    }
+    StopCondition::install_signal_handlers();
+    opt_common::Configuration worker_conf;
+    worker_conf.read_configuration_from_file(argv[3]);
+    Worker worker(worker_conf, argv[3]);
+    worker.serve(argv[2], allow_remote, StopCondition(), &std::cout);
+    return 0;
+  }
+
   if (argc < 5) {
     std::cerr << "Usage:\n"
-              << argv[0] << " DATAFILE CONFIGFILE DEADLINE (-1|-2|-12)\n";
+              << argv[0] << " DATAFILE CONFIGFILE DEADLINE (-1|-2|-3|-12)"
+              << " [--stats-json FILE] [--trace FILE]"
+              << " [--checkpoint FILE [--resume]] [--warm-start RESULT_FILE]"
+              << " [--time-budget SECONDS] [--screening-jobs N]"
+              << " [--speculative-dagsim N] [--workers ADDRESS[,ADDRESS...]]"
+              << " [--precompute POINTS [--precompute-tolerance ERROR]]"
+              << " [--stream EVENTS_FILE|-] [--groups K [--compare-flat]]"
+              << " [--critical-path] [--search-time SECONDS]"
+              << " [--batch-optic] [--record TRACE_FILE]"
+              << " [--replay TRACE_FILE [--replay-latency]]"
+              << " [--native-core-search] [--gap THRESHOLD]"
+              << " [--batch PROCESSES_FILE] [--core-budget BUDGET]\n"
+              << argv[0] << " --worker ADDRESS CONFIGFILE [--allow-remote]\n";
     return -1;
   }
 
+  // Parse optional arguments
+  auto optional_arguments = parse_optional_arguments(argc, argv, 5);
+  auto& solver_options = optional_arguments.m_solver_options;
+  StopCondition::install_signal_handlers();
+  if (optional_arguments.m_trace_filename.empty() == false) {
+    Tracer::instance().enable();
+  }
+
+  // Record (or replay) the OPT_IC and dagSim evaluations
+  if (optional_arguments.m_record_filename.empty() == false) {
+    solver_options.m_evaluation_trace = std::make_shared<EvaluationTrace>(
+        optional_arguments.m_record_filename, EvaluationTrace::Mode::RECORD);
+  } else if (optional_arguments.m_replay_filename.empty() == false) {
+    solver_options.m_evaluation_trace = std::make_shared<EvaluationTrace>(
+        optional_arguments.m_replay_filename, EvaluationTrace::Mode::REPLAY,
+        optional_arguments.m_replay_latency, &std::cout);
+  }
+
   // Create configuration
   opt_common::Configuration opt_deadline_conf;
   opt_deadline_conf.read_configuration_from_file(argv[2]);
 
-  // Create process
-  const auto total_deadline = parse_total_deadline_process(argv[3]);
-  auto process = Process::create_process(argv[1], argv[2], total_deadline);
-
   // Parse algorithm type
   const auto algorithm_type = parse_algorithm_selection_from_cmd_line(argv[4]);
 
   std::cout << "Algorithm selected: " << AlgorithmType2String(algorithm_type)
             << "\n";
 
-  auto result_log = generate_result_file(
-      algorithm_type, &std::cout,
-      std::chrono::system_clock::now().time_since_epoch().count());
+  // The processes of the run share the applications and the evaluations
+  solver_options.m_application_registry =
+      std::make_shared<ApplicationRegistry>();
+  std::vector<ProcessToSolve> processes = {
+      {argv[1], parse_total_deadline_process(argv[3])}};
+  if (optional_arguments.m_batch_filename.empty() == false) {
+    const auto batch_processes =
+        read_batch_file(optional_arguments.m_batch_filename,
+                        processes.front().m_total_deadline);
+    processes.insert(processes.end(), batch_processes.cbegin(),
+                     batch_processes.cend());
+  }
 
-  // Launch algorithm class in according to type
-  bool status_algorithm = false;
-  switch (algorithm_type) {
-    case AlgorithmSelection::ALGORITHM_1:
-      Algorithm1 algorithm1;
-      status_algorithm = algorithm1.process(opt_deadline_conf, &process,
-                                            &std::cout, &result_log);
-      break;
-    case AlgorithmSelection::ALGORITHM_2:
-      Algorithm2 algorithm2;
-      status_algorithm = algorithm2.process(opt_deadline_conf, &process,
-                                            &std::cout, &result_log);
-      break;
-    case AlgorithmSelection::ALGORITHM_12:
-      Algorithm1 algorithm1_2;
-      Algorithm2 algorithm2_2;
-      status_algorithm = algorithm1_2.process(opt_deadline_conf, &process,
-                                              &std::cout, &result_log);
-      if (status_algorithm == true) {
-        status_algorithm = algorithm2_2.process(opt_deadline_conf, &process,
-                                                &std::cout, &result_log);
-      }
-      break;
-    default:
-      std::cerr << "Algorithm type not recognized\n";
+  bool status_algorithm = true;
+  for (std::size_t k = 0; k < processes.size(); ++k) {
+    if (processes.size() > 1) {
+      if (solver_options.m_stop_condition->stop_requested()) {
+        std::cout << "Batch stopped: " << processes.size() - k
+                  << " processes not solved\n";
+        break;
+      }
+      std::cout << "Batch process " << k + 1 << "/" << processes.size()
+                << ": '" << processes[k].m_data_filename << "' (deadline "
+                << processes[k].m_total_deadline << ")\n";
+    }
+    const bool status_process =
+        solve_process(processes[k], argv[2], opt_deadline_conf,
+                      algorithm_type, &optional_arguments);
+    status_algorithm = status_algorithm && status_process;
+  }
+
+  // Print run statistics
+  Statistics::instance().print_summary(&std::cout);
+  if (optional_arguments.m_stats_json_filename.empty() == false) {
+    Statistics::instance().write_json(optional_arguments.m_stats_json_filename);
+  }
+  if (optional_arguments.m_trace_filename.empty() == false) {
+    Tracer::instance().write_json(optional_arguments.m_trace_filename);
   }
 
-  result_log.close();
   return status_algorithm == true ? 0 : -1;
 }
@@ -0,0 +1,86 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __OPT_DEADLINE__TEST_HELPER__HPP
+#define __OPT_DEADLINE__TEST_HELPER__HPP
+
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+//! Minimal checks of the tests (they are enabled also with NDEBUG): the test
+//! stops at the first failed check with a non-zero exit status
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::cerr << __FILE__ << ':' << __LINE__                             \
+                << ": CHECK failed: " #condition "\n";                     \
+      std::exit(EXIT_FAILURE);                                             \
+    }                                                                      \
+  } while (false)
+
+//! Check that 'statement' throws an exception whose message contains
+//! 'message'
+#define CHECK_THROWS(statement, message)                                   \
+  do {                                                                     \
+    bool thrown = false;                                                   \
+    try {                                                                  \
+      statement;                                                           \
+    } catch (const std::exception& error) {                                \
+      thrown = std::string(error.what()).find(message) != std::string::npos; \
+      if (thrown == false) {                                               \
+        std::cerr << "Unexpected exception: " << error.what() << '\n';     \
+      }                                                                    \
+    }                                                                      \
+    if (thrown == false) {                                                 \
+      std::cerr << __FILE__ << ':' << __LINE__                             \
+                << ": CHECK_THROWS failed: " #statement "\n";              \
+      std::exit(EXIT_FAILURE);                                             \
+    }                                                                      \
+  } while (false)
+
+//! \return the name of a new temporary file (or directory, with 'directory')
+inline std::string make_temporary_name(const std::string& name,
+                                       bool directory = false) {
+  std::string pattern = "/tmp/opt_deadline_" + name + "_XXXXXX";
+  const bool created = directory ? mkdtemp(&pattern[0]) != nullptr
+                                 : close(mkstemp(&pattern[0])) == 0;
+  if (created == false) {
+    throw std::runtime_error("Cannot create '" + pattern + "'");
+  }
+  return pattern;
+}
+
+/*! Write a configuration file which runs the stubs of OPT_IC and dagSim
+  (test/stubs) on the applications of test/app_files
+  \param test_directory The directory 'test' of the repository
+  \return the name of the file
+ */
+inline std::string make_test_configuration(const std::string& test_directory) {
+  const std::string filename = make_temporary_name("config");
+  std::ofstream file(filename);
+  file << test_directory << "/app_files\n"
+       << test_directory << "/stubs/dagsim\n"
+       << test_directory << "/app_files\n"
+       << test_directory << "/stubs/opt_ic\n"
+       << "/tmp\n";
+  return filename;
+}
+
+#endif  // __OPT_DEADLINE__TEST_HELPER__HPP
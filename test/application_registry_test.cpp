@@ -0,0 +1,223 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Application registry: profiles shared by identical applications and
+// parsed again when their files change; evaluations resolved once.
+// Usage: application_registry_test TEST_DIRECTORY
+
+#include <unistd.h>
+#include <utime.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ApplicationRegistry.hpp"
+#include "Process.hpp"
+#include "TestHelper.hpp"
+
+namespace {
+
+using FileResources = ApplicationRegistry::FileResources;
+
+const FileResources P8_RESOURCES = {"app_P8.csv",   "jobs_P8.csv",
+                                    "stages_P8.csv", "tasks_P8.csv",
+                                    "test_P8.lua",  "ConfigApp_P8.txt"};
+
+void copy_file(const std::string& from, const std::string& to) {
+  std::ifstream input(from, std::ios::binary);
+  std::ofstream output(to, std::ios::binary);
+  output << input.rdbuf();
+  CHECK(input.good() && output.good());
+}
+
+const std::vector<std::string> P8_FILES = {
+    P8_RESOURCES.m_Application_File, P8_RESOURCES.m_Jobs_File,
+    P8_RESOURCES.m_Stages_File,      P8_RESOURCES.m_Tasks_File,
+    P8_RESOURCES.m_Lua_File,         P8_RESOURCES.m_Infrastructure_File};
+
+//! Copy the files of app_P8 into a new directory, which becomes the working
+//! directory (the registry identifies the files found from there), with the
+//! configuration file 'config.txt'
+//! \return the directory
+std::string make_application_directory(const std::string& test_directory) {
+  const std::string directory = make_temporary_name("registry", true);
+  for (const auto& name : P8_FILES) {
+    copy_file(test_directory + "/app_files/" + name, directory + '/' + name);
+  }
+  std::ofstream(directory + "/config.txt")
+      << directory << '\n'
+      << test_directory << "/stubs/dagsim\n"
+      << directory << '\n'
+      << test_directory << "/stubs/opt_ic\n/tmp\n";
+  CHECK(chdir(directory.c_str()) == 0);
+  return directory;
+}
+
+//! Move the modification time of the file one minute back
+void touch_in_the_past(const std::string& filename) {
+  struct utimbuf times;
+  times.actime = times.modtime = time(nullptr) - 60;
+  CHECK(utime(filename.c_str(), &times) == 0);
+}
+
+void test_profiles(const std::string& test_directory) {
+  const std::string directory = make_application_directory(test_directory);
+  const std::string config = directory + "/config.txt";
+  ApplicationRegistry registry;
+
+  // The same files (whatever the name of the configuration file) share the
+  // profile
+  const auto profile = registry.get_profile(P8_RESOURCES, config);
+  CHECK(profile->get_application_id() == "app_P8.csv");
+  CHECK(registry.get_profile(P8_RESOURCES, config) == profile);
+  CHECK(registry.get_profile(P8_RESOURCES, "./config.txt") == profile);
+
+  // Another configuration file is another application
+  copy_file(config, "config_copy.txt");
+  const auto other_config_profile =
+      registry.get_profile(P8_RESOURCES, "config_copy.txt");
+  CHECK(other_config_profile != profile);
+
+  // A file changed on disk (size or modification time) is parsed again
+  touch_in_the_past(P8_RESOURCES.m_Lua_File);
+  const auto touched_profile = registry.get_profile(P8_RESOURCES, config);
+  CHECK(touched_profile != profile);
+  CHECK(registry.get_profile(P8_RESOURCES, config) == touched_profile);
+
+  std::ofstream(P8_RESOURCES.m_Stages_File, std::ios::app) << '\n';
+  const auto grown_profile = registry.get_profile(P8_RESOURCES, config);
+  CHECK(grown_profile != touched_profile);
+  CHECK(registry.get_profile(P8_RESOURCES, config) == grown_profile);
+
+  std::ofstream(config, std::ios::app) << '\n';
+  CHECK(registry.get_profile(P8_RESOURCES, config) != grown_profile);
+
+  for (const auto& name : P8_FILES) {
+    std::remove(name.c_str());
+  }
+  std::remove("config_copy.txt");
+  std::remove(config.c_str());
+  CHECK(chdir("/") == 0 && rmdir(directory.c_str()) == 0);
+}
+
+void test_processes(const std::string& test_directory) {
+  const std::string config = make_test_configuration(test_directory);
+  const std::string process_file = make_temporary_name("process");
+  {
+    std::ifstream input(test_directory + "/4apps/process.txt");
+    std::ofstream output(process_file);
+    output << input.rdbuf();
+    // The first application again, with another weight
+    output << "app_P8.csv jobs_P8.csv stages_P8.csv tasks_P8.csv "
+              "test_P8.lua ConfigApp_P8.txt 1.5\n";
+  }
+
+  // An application listed twice is parsed once, also without a registry
+  const Process alone = Process::create_process(process_file, config, 4000000);
+  CHECK(alone.get_number_applications() == 5);
+  CHECK(alone.get_application_from_index(0).get_shared_profile() ==
+        alone.get_application_from_index(4).get_shared_profile());
+  CHECK(alone.get_application_from_index(4).get_weight() == 1.5);
+
+  // The processes of a registry share the profiles
+  ApplicationRegistry registry;
+  const Process first =
+      Process::create_process(process_file, config, 4000000, &registry);
+  const Process second =
+      Process::create_process(process_file, config, 3000000, &registry);
+  for (unsigned i = 0; i < first.get_number_applications(); ++i) {
+    CHECK(first.get_application_from_index(i).get_shared_profile() ==
+          second.get_application_from_index(i).get_shared_profile());
+  }
+  CHECK(first.get_application_from_index(0).get_shared_profile() !=
+        alone.get_application_from_index(0).get_shared_profile());
+  std::remove(process_file.c_str());
+  std::remove(config.c_str());
+}
+
+//! A command which counts its waits
+class CountedCommand : public PendingCommand {
+ public:
+  CountedCommand(std::string output, unsigned* waits)
+      : m_output(std::move(output)), m_waits(waits) {}
+  std::string wait() override {
+    ++*m_waits;
+    return m_output;
+  }
+  void cancel() noexcept override {}
+
+ private:
+  std::string m_output;
+  unsigned* m_waits;
+};
+
+void test_evaluations() {
+  ApplicationRegistry registry;
+  const ApplicationRegistry::Request request = {
+      WorkerProtocol::JobType::DAGSIM, "app_P8.csv", 1334,
+      EvaluationTrace::hash_input("-- LUA with 1334 cores")};
+  ApplicationRegistry::Request other_request = request;
+  other_request.m_input_hash = EvaluationTrace::hash_input("-- another LUA");
+
+  std::string output;
+  CHECK(registry.find_evaluation(request, &output) == false);
+
+  // Identical evaluations launched together share the command
+  unsigned launches = 0;
+  unsigned waits = 0;
+  const auto launch = [&]() {
+    ++launches;
+    return std::unique_ptr<PendingCommand>(
+        new CountedCommand("1499250 1484257 1514242\n", &waits));
+  };
+  auto first = registry.launch(request, launch);
+  auto second = registry.launch(request, launch);
+  CHECK(launches == 1);
+  CHECK(first->wait() == "1499250 1484257 1514242\n");
+  CHECK(second->wait() == "1499250 1484257 1514242\n");
+  CHECK(waits == 1);
+
+  // Then they are resolved
+  CHECK(registry.find_evaluation(request, &output));
+  CHECK(output == "1499250 1484257 1514242\n");
+  unsigned runs = 0;
+  const auto run = [&runs]() {
+    ++runs;
+    return std::string("2500000 2475000 2525000\n");
+  };
+  CHECK(registry.evaluate(request, run) == "1499250 1484257 1514242\n");
+  CHECK(runs == 0);
+
+  // Another input (or type) is another evaluation
+  CHECK(registry.evaluate(other_request, run) == "2500000 2475000 2525000\n");
+  CHECK(runs == 1);
+  other_request.m_type = WorkerProtocol::JobType::OPT_IC;
+  other_request.m_input_hash = request.m_input_hash;
+  CHECK(registry.find_evaluation(other_request, &output) == false);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " TEST_DIRECTORY\n";
+    return EXIT_FAILURE;
+  }
+  test_evaluations();
+  test_processes(argv[1]);
+  test_profiles(argv[1]);
+  return EXIT_SUCCESS;
+}
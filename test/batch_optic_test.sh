@@ -0,0 +1,51 @@
+#!/bin/bash
+# Batched OPT_IC queries (--batch-optic): each answer of a batch is matched
+# to its query by its application, also when OPT_IC reorders the answers;
+# when an answer is missing every query of the batch is evaluated by its own
+# invocation. The result is always the one of the run without batches.
+# OPT_IC and dagSim are replaced by the stubs of test/stubs.
+#
+# Usage: batch_optic_test.sh OPT_DEADLINE_BINARY
+
+source "$(dirname "$0")/test_common.sh" "$@"
+
+# The counter $2 in the run statistics of the log file $1
+counter_of() {
+  grep -a "^$2 " "$1" | awk '{print $2}'
+}
+
+# Reference result, without batches
+"$OPT_DEADLINE" "$PROCESS_FILE" config.txt 4000000 -2 > single.log 2>&1 ||
+  { cat single.log; fail "run without batches"; }
+expected=$(objective_of single.log)
+[ -n "$expected" ] || fail "no objective function in the run without batches"
+single_calls=$(external_calls_of single.log OPT_IC)
+
+for answers in ordered reversed missing; do
+  OPT_IC_ANSWERS=$answers "$OPT_DEADLINE" "$PROCESS_FILE" config.txt \
+    4000000 -2 --batch-optic > "$answers.log" 2>&1 ||
+    { cat "$answers.log"; fail "batched run ($answers answers)"; }
+
+  actual=$(objective_of "$answers.log")
+  [ "$actual" = "$expected" ] ||
+    fail "objective function $actual with $answers answers, $expected without"
+
+  batched=$(counter_of "$answers.log" OptICBatchedQueries)
+  [ "${batched:-0}" -gt 0 ] ||
+    fail "OptICBatchedQueries is '$batched' with $answers answers"
+  fallbacks=$(counter_of "$answers.log" OptICBatchFallbacks)
+  calls=$(external_calls_of "$answers.log" OPT_IC)
+  if [ "$answers" = missing ]; then
+    [ "${fallbacks:-0}" -gt 0 ] ||
+      fail "no fallback when an answer of the batch is missing"
+    [ "$calls" -gt "$single_calls" ] ||
+      fail "$calls OPT_IC calls with fallbacks, $single_calls without batches"
+  else
+    [ "${fallbacks:-0}" -eq 0 ] ||
+      fail "$fallbacks fallback(s) with $answers answers"
+    [ "$calls" -lt "$single_calls" ] ||
+      fail "$calls OPT_IC calls with $answers answers, $single_calls without"
+  fi
+  echo "$answers answers: $batched batched queries, $fallbacks fallback(s)," \
+    "$calls OPT_IC calls ($single_calls without batches)"
+done
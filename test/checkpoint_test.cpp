@@ -0,0 +1,155 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checkpoint of FineGrain: round trip of the state, atomic replacement,
+// bad-formed files and allocation of the process.
+// Usage: checkpoint_test TEST_DIRECTORY
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "Checkpoint.hpp"
+#include "Process.hpp"
+#include "TestHelper.hpp"
+
+namespace {
+
+FineGrainState make_state() {
+  FineGrainState state;
+  state.m_algorithm = "Algorithm2";
+  state.m_total_deadline = 4000000;
+  state.m_application_ids = {"app_P8.csv", "app_D.csv"};
+  state.m_deadlines = {1500000, 2500000};
+  state.m_cores = {1334, 800};
+  state.m_coresFromOptIC_perApp = {1334, 801};
+  state.m_residualTime_perApp = {750, -3};
+  state.m_total_residual_time = 747;
+  state.m_apps_to_remove = {1};
+  state.m_iteration_index = 4;
+  state.m_initialization_completed = true;
+  state.m_next_app_index = 1;
+  state.m_pending_num_cores = 12;
+  state.m_best = -3.14;
+  state.m_best_new_n_cores = 1333;
+  state.m_best_index = 0;
+  state.m_candidate_indexes = {0};
+  state.m_candidate_new_n_cores = {1333};
+  return state;
+}
+
+bool file_exists(const std::string& filename) {
+  return std::ifstream(filename).good();
+}
+
+void test_round_trip() {
+  const std::string filename = make_temporary_name("checkpoint");
+  const FineGrainState state = make_state();
+  Checkpoint::save(filename, state);
+  CHECK(file_exists(filename + ".tmp") == false);
+
+  const FineGrainState loaded = Checkpoint::load(filename);
+  CHECK(loaded.m_algorithm == state.m_algorithm);
+  CHECK(loaded.m_total_deadline == state.m_total_deadline);
+  CHECK(loaded.m_application_ids == state.m_application_ids);
+  CHECK(loaded.m_deadlines == state.m_deadlines);
+  CHECK(loaded.m_cores == state.m_cores);
+  CHECK(loaded.m_coresFromOptIC_perApp == state.m_coresFromOptIC_perApp);
+  CHECK(loaded.m_residualTime_perApp == state.m_residualTime_perApp);
+  CHECK(loaded.m_total_residual_time == state.m_total_residual_time);
+  CHECK(loaded.m_apps_to_remove == state.m_apps_to_remove);
+  CHECK(loaded.m_iteration_index == state.m_iteration_index);
+  CHECK(loaded.m_initialization_completed);
+  CHECK(loaded.m_next_app_index == state.m_next_app_index);
+  CHECK(loaded.m_pending_num_cores == state.m_pending_num_cores);
+  CHECK(loaded.m_best == state.m_best);
+  CHECK(loaded.m_best_new_n_cores == state.m_best_new_n_cores);
+  CHECK(loaded.m_best_index == state.m_best_index);
+  CHECK(loaded.m_candidate_indexes == state.m_candidate_indexes);
+  CHECK(loaded.m_candidate_new_n_cores == state.m_candidate_new_n_cores);
+
+  // A new state replaces the previous one
+  FineGrainState next_state = state;
+  next_state.m_iteration_index = 5;
+  next_state.m_algorithm.clear();
+  Checkpoint::save(filename, next_state);
+  const FineGrainState reloaded = Checkpoint::load(filename);
+  CHECK(reloaded.m_iteration_index == 5);
+  CHECK(reloaded.m_algorithm.empty());
+  std::remove(filename.c_str());
+}
+
+void test_bad_files() {
+  const std::string filename = make_temporary_name("checkpoint");
+  std::remove(filename.c_str());
+  CHECK_THROWS(Checkpoint::load(filename), "Cannot open checkpoint file");
+
+  std::ofstream(filename) << "OPT_DEADLINE_FINEGRAIN_CHECKPOINT 2\n";
+  CHECK_THROWS(Checkpoint::load(filename), "is not a valid");
+
+  // A checkpoint cut in the middle
+  Checkpoint::save(filename, make_state());
+  std::string content;
+  {
+    std::ifstream file(filename);
+    content.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+  }
+  std::ofstream(filename) << content.substr(0, content.size() / 2);
+  CHECK_THROWS(Checkpoint::load(filename), "");
+  std::remove(filename.c_str());
+}
+
+void test_allocation(const std::string& test_directory) {
+  const std::string config = make_test_configuration(test_directory);
+  const std::string process_file = test_directory + "/4apps/process.txt";
+  Process process = Process::create_process(process_file, config, 4000000);
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    auto& application = process.get_application_from_index_mod(i);
+    application.set_deadline(1000000 + i);
+    application.set_number_of_core(100 + i);
+  }
+  FineGrainState state;
+  state.store_allocation(process);
+
+  Process restored = Process::create_process(process_file, config, 4000000);
+  state.restore_allocation(&restored);
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    const auto& application = restored.get_application_from_index(i);
+    CHECK(application.get_deadline() == 1000000 + i);
+    CHECK(application.get_number_of_core() == 100 + i);
+  }
+
+  // The state of another process is rejected
+  state.m_application_ids.front() = "another_application.csv";
+  CHECK_THROWS(state.restore_allocation(&restored), "does not match");
+  state.m_application_ids.pop_back();
+  CHECK_THROWS(state.restore_allocation(&restored), "number of applications");
+  std::remove(config.c_str());
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " TEST_DIRECTORY\n";
+    return EXIT_FAILURE;
+  }
+  test_round_trip();
+  test_bad_files();
+  test_allocation(argv[1]);
+  return EXIT_SUCCESS;
+}
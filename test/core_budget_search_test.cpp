@@ -0,0 +1,166 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Dual mode: bisection of the total deadline of CoreBudgetSearch, with a
+// fake solver whose cost is within the budget from a threshold deadline.
+// Usage: core_budget_search_test TEST_DIRECTORY
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CoreBudgetSearch.hpp"
+#include "TestHelper.hpp"
+
+namespace {
+
+using TimeInstant = opt_common::TimeInstant;
+
+//! Cores of each application within the budget
+constexpr unsigned BUDGET_CORES = 10;
+
+//! Solver which allocates BUDGET_CORES to each application from the
+//! deadline 'threshold', and one more core below it; it records the probed
+//! deadlines and the deadlines of their warm starts
+struct FakeSolver {
+  TimeInstant m_threshold = 0;
+  std::vector<TimeInstant> m_deadlines;
+  std::vector<TimeInstant> m_warm_start_deadlines;
+
+  bool operator()(const SolverOptions& options, Process* process,
+                  std::ostream*, std::ostream*) {
+    const TimeInstant deadline = process->get_total_deadline();
+    m_deadlines.push_back(deadline);
+    m_warm_start_deadlines.push_back(options.m_warm_start_total_deadline);
+    Allocation allocation = process->get_allocation();
+    for (auto& application_allocation : allocation) {
+      application_allocation.m_number_of_core =
+          deadline >= m_threshold ? BUDGET_CORES : BUDGET_CORES + 1;
+    }
+    process->set_allocation(allocation);
+    return true;
+  }
+};
+
+double sum_weights(const Process& process) {
+  double sum = 0.0;
+  for (unsigned i = 0; i < process.get_number_applications(); ++i) {
+    sum += process.get_application_from_index(i).get_weight();
+  }
+  return sum;
+}
+
+//! Search with the threshold 'threshold' and check the shortest deadline
+//! \return the probed deadlines
+std::vector<TimeInstant> search(const Process& process,
+                                const CoreBudgetSearch& core_budget_search,
+                                TimeInstant threshold) {
+  FakeSolver solver;
+  solver.m_threshold = threshold;
+  Process solved_process = process;
+  std::ostringstream log;
+  std::ostringstream result_log;
+  CHECK(core_budget_search.process(std::ref(solver), &solved_process, &log,
+                                   &result_log));
+
+  // The shortest deadline is feasible and it is the threshold, within the
+  // tolerance of the bisection
+  const TimeInstant deadline = solved_process.get_total_deadline();
+  CHECK(deadline >= threshold);
+  CHECK(deadline - threshold <= 1 + deadline / 200);
+  CHECK(solved_process.compute_global_objective_function() <=
+        BUDGET_CORES * sum_weights(process));
+
+  // Every probe is counted, and each probe after the first feasible one is
+  // warm started from the shortest feasible deadline found before it
+  CHECK(log.str().find("Probes: " + std::to_string(solver.m_deadlines.size())
+                       + '\n') != std::string::npos);
+  TimeInstant shortest_feasible = 0;
+  for (std::size_t i = 0; i < solver.m_deadlines.size(); ++i) {
+    if (shortest_feasible != 0) {
+      CHECK(solver.m_warm_start_deadlines[i] == shortest_feasible);
+    }
+    if (solver.m_deadlines[i] >= threshold &&
+        (shortest_feasible == 0 || solver.m_deadlines[i] < shortest_feasible)) {
+      shortest_feasible = solver.m_deadlines[i];
+    }
+  }
+  CHECK(shortest_feasible == deadline);
+  return solver.m_deadlines;
+}
+
+void test_search(const std::string& test_directory) {
+  const std::string config = make_test_configuration(test_directory);
+  const Process process = Process::create_process(
+      test_directory + "/4apps/process.txt", config, 4000000);
+  Process shortest_process = process;
+  const TimeInstant shortest_deadline = shortest_process.compute_min_deadline();
+  const CoreBudgetSearch core_budget_search(
+      SolverOptions(), BUDGET_CORES * sum_weights(process));
+
+  // The first probe is the estimate of the ML models: when it is feasible,
+  // the shorter deadlines are bisected
+  const TimeInstant estimated_deadline =
+      search(process, core_budget_search, shortest_deadline + 1).front();
+  CHECK(estimated_deadline > shortest_deadline);
+  const TimeInstant below_estimate =
+      shortest_deadline + (estimated_deadline - shortest_deadline) / 2 + 1;
+  const auto bisected = search(process, core_budget_search, below_estimate);
+  CHECK(bisected.front() == estimated_deadline);
+  CHECK(bisected.size() > 2);
+  for (std::size_t i = 1; i < bisected.size(); ++i) {
+    CHECK(bisected[i] > shortest_deadline && bisected[i] < estimated_deadline);
+  }
+
+  // Otherwise the total deadline of the process (or twice the estimate) is
+  // probed, and doubled until it is feasible, before the bisection
+  const TimeInstant expansion_deadline =
+      std::max(process.get_total_deadline(), 2 * estimated_deadline);
+  const TimeInstant above_expansion = 2 * expansion_deadline + 1;
+  const auto expanded = search(process, core_budget_search, above_expansion);
+  CHECK(expanded.size() > 4);
+  CHECK(expanded[0] == estimated_deadline);
+  CHECK(expanded[1] == expansion_deadline);
+  CHECK(expanded[2] == 2 * expansion_deadline);
+  CHECK(expanded[3] == 4 * expansion_deadline);
+  for (std::size_t i = 4; i < expanded.size(); ++i) {
+    CHECK(expanded[i] > 2 * expansion_deadline &&
+          expanded[i] < 4 * expansion_deadline);
+  }
+
+  // A failure of the algorithms is an error
+  Process failed_process = process;
+  std::ostringstream log;
+  CHECK_THROWS(core_budget_search.process(
+                   [](const SolverOptions&, Process*, std::ostream*,
+                      std::ostream*) { return false; },
+                   &failed_process, &log, &log),
+               "the algorithms have failed on probe 0");
+  std::remove(config.c_str());
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " TEST_DIRECTORY\n";
+    return EXIT_FAILURE;
+  }
+  test_search(argv[1]);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Core count index: bounds of the number of cores implied by the known
+// OPT_IC answers, which never increase with the deadline.
+// Usage: core_count_index_test TEST_DIRECTORY
+
+#include <string>
+#include "CoreCountIndex.hpp"
+#include "TestHelper.hpp"
+
+namespace {
+
+bool has_bounds(const CoreCountIndex& index, const std::string& application,
+                CoreCountIndex::TimeInstant deadline, int lower, int upper) {
+  const auto bounds = index.get_bounds(application, deadline);
+  return bounds.m_lower == lower && bounds.m_upper == upper;
+}
+
+void test_bounds() {
+  CoreCountIndex index;
+  int num_cores = -1;
+
+  // Nothing is known
+  CHECK(has_bounds(index, "app_P8.csv", 1000, 0, -1));
+  CHECK(index.lookup("app_P8.csv", 1000, &num_cores) == false);
+
+  index.add("app_P8.csv", 1000, 40);
+  index.add("app_P8.csv", 2000, 20);
+  index.add("app_P8.csv", 3000, 20);
+  index.add("app_P8.csv", 4000, 10);
+
+  // A known deadline
+  CHECK(has_bounds(index, "app_P8.csv", 2000, 20, 20));
+  CHECK(index.lookup("app_P8.csv", 2000, &num_cores) && num_cores == 20);
+
+  // Between two deadlines with the same answer (bracketed query)
+  num_cores = -1;
+  CHECK(has_bounds(index, "app_P8.csv", 2500, 20, 20));
+  CHECK(index.lookup("app_P8.csv", 2500, &num_cores) && num_cores == 20);
+
+  // Between two deadlines with different answers
+  CHECK(has_bounds(index, "app_P8.csv", 1500, 20, 40));
+  CHECK(has_bounds(index, "app_P8.csv", 3999, 10, 20));
+  CHECK(index.lookup("app_P8.csv", 1500, &num_cores) == false);
+  CHECK(index.lookup("app_P8.csv", 3999, &num_cores) == false);
+
+  // Before the first deadline there is no upper bound, after the last one
+  // there is no lower bound
+  CHECK(has_bounds(index, "app_P8.csv", 999, 40, -1));
+  CHECK(has_bounds(index, "app_P8.csv", 4001, 0, 10));
+  CHECK(index.lookup("app_P8.csv", 999, &num_cores) == false);
+  CHECK(index.lookup("app_P8.csv", 4001, &num_cores) == false);
+
+  // The answers of an application do not bound the others
+  CHECK(has_bounds(index, "app_D.csv", 2500, 0, -1));
+  CHECK(index.lookup("app_D.csv", 2000, &num_cores) == false);
+
+  // A new answer for a known deadline replaces the old one
+  index.add("app_P8.csv", 3000, 15);
+  CHECK(has_bounds(index, "app_P8.csv", 2500, 15, 20));
+  CHECK(index.lookup("app_P8.csv", 2500, &num_cores) == false);
+  CHECK(index.lookup("app_P8.csv", 3000, &num_cores) && num_cores == 15);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " TEST_DIRECTORY\n";
+    return EXIT_FAILURE;
+  }
+  test_bounds();
+  return EXIT_SUCCESS;
+}
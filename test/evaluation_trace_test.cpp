@@ -0,0 +1,171 @@
+/*
+Copyright 2017 Biagio Festa <info@biagiofesta.it>
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Evaluation trace: record and replay of the answers, partial last record
+// and corrupted files.
+// Usage: evaluation_trace_test TEST_DIRECTORY
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include "EvaluationTrace.hpp"
+#include "TestHelper.hpp"
+
+namespace {
+
+using JobType = EvaluationTrace::JobType;
+using Mode = EvaluationTrace::Mode;
+
+const EvaluationTrace::Request OPT_IC_REQUEST = {
+    JobType::OPT_IC, "app_P8.csv", 1500000,
+    EvaluationTrace::hash_input("app_P8.csv ... 1500000")};
+const EvaluationTrace::Request DAGSIM_REQUEST = {
+    JobType::DAGSIM, "app_P8.csv", 1334,
+    EvaluationTrace::hash_input("-- LUA with 1334 cores")};
+const EvaluationTrace::Request LAST_REQUEST = {
+    JobType::DAGSIM, "app_D.csv", 800,
+    EvaluationTrace::hash_input("-- LUA with 800 cores")};
+
+std::string read_file(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& filename, const std::string& content) {
+  std::ofstream(filename, std::ios::binary | std::ios::trunc) << content;
+}
+
+//! Record a trace: OPT_IC_REQUEST twice, then DAGSIM_REQUEST and LAST_REQUEST
+void record_trace(const std::string& filename) {
+  EvaluationTrace trace(filename, Mode::RECORD);
+  CHECK(trace.is_replaying() == false);
+  unsigned runs = 0;
+  CHECK(trace.evaluate(OPT_IC_REQUEST, [&runs] {
+    ++runs;
+    return std::string("N YARN containers (VMs): 1334\n");
+  }) == "N YARN containers (VMs): 1334\n");
+  CHECK(runs == 1);
+  trace.record(OPT_IC_REQUEST, "N YARN containers (VMs): 1335\n", 1000);
+  trace.record(DAGSIM_REQUEST, "1499250 1484257 1514242\n", 2000);
+  trace.record(LAST_REQUEST, "2500000 2475000 2525000\n", 3000);
+}
+
+void test_hash() {
+  // FNV-1a 64 bit
+  CHECK(EvaluationTrace::hash_input("") == 14695981039346656037ULL);
+  CHECK(EvaluationTrace::hash_input("a") == 0xaf63dc4c8601ec8cULL);
+  CHECK(EvaluationTrace::hash_input("ab") != EvaluationTrace::hash_input("ba"));
+}
+
+void test_record_replay() {
+  const std::string filename = make_temporary_name("trace");
+  record_trace(filename);
+
+  EvaluationTrace trace(filename, Mode::REPLAY);
+  CHECK(trace.is_replaying());
+  const auto never_run = []() -> std::string {
+    CHECK(false);
+    return "";
+  };
+
+  // The same request is answered in the order of the record, then the last
+  // answer is repeated
+  CHECK(trace.evaluate(OPT_IC_REQUEST, never_run) ==
+        "N YARN containers (VMs): 1334\n");
+  CHECK(trace.evaluate(OPT_IC_REQUEST, never_run) ==
+        "N YARN containers (VMs): 1335\n");
+  CHECK(trace.evaluate(OPT_IC_REQUEST, never_run) ==
+        "N YARN containers (VMs): 1335\n");
+
+  // The launched evaluations are answered when they are waited
+  const auto command = trace.launch(
+      DAGSIM_REQUEST, []() -> std::unique_ptr<PendingCommand> {
+        CHECK(false);
+        return nullptr;
+      });
+  CHECK(command->wait() == "1499250 1484257 1514242\n");
+  CHECK(trace.replay(LAST_REQUEST).second == 3000);
+
+  // The request is identified by the type and the input hash
+  EvaluationTrace::Request unknown = DAGSIM_REQUEST;
+  unknown.m_type = JobType::OPT_IC;
+  CHECK_THROWS(trace.replay(unknown), "request not in the trace");
+  unknown = DAGSIM_REQUEST;
+  unknown.m_input_hash = EvaluationTrace::hash_input("another LUA");
+  CHECK_THROWS(trace.replay(unknown), "request not in the trace");
+  std::remove(filename.c_str());
+}
+
+void test_partial_last_record() {
+  const std::string filename = make_temporary_name("trace");
+  record_trace(filename);
+  const std::string content = read_file(filename);
+
+  // Killed while writing the output of the last record, or its header
+  for (const std::size_t cut : {std::size_t(5), std::size_t(30)}) {
+    write_file(filename, content.substr(0, content.size() - cut));
+    std::ostringstream log;
+    EvaluationTrace trace(filename, Mode::REPLAY, false, &log);
+    CHECK(log.str().find("ends with a partial record") != std::string::npos);
+    CHECK(trace.replay(DAGSIM_REQUEST).first == "1499250 1484257 1514242\n");
+    CHECK_THROWS(trace.replay(LAST_REQUEST), "request not in the trace");
+  }
+
+  // A complete trace loads without warnings
+  write_file(filename, content);
+  std::ostringstream log;
+  EvaluationTrace trace(filename, Mode::REPLAY, false, &log);
+  CHECK(log.str().empty());
+  CHECK(trace.replay(LAST_REQUEST).first == "2500000 2475000 2525000\n");
+  std::remove(filename.c_str());
+}
+
+void test_corrupted_files() {
+  const std::string filename = make_temporary_name("trace");
+  CHECK_THROWS(EvaluationTrace(filename + ".missing", Mode::REPLAY),
+               "Impossible open the file");
+
+  write_file(filename, "OPT_DEADLINE_FINEGRAIN_CHECKPOINT 3\n");
+  CHECK_THROWS(EvaluationTrace(filename, Mode::REPLAY),
+               "is not an evaluation trace");
+
+  // A bad type of a record which is not the last one
+  record_trace(filename);
+  std::string content = read_file(filename);
+  const std::size_t first_record = std::string("OPTDTRC1").size();
+  content[first_record] = 0x7f;
+  write_file(filename, content);
+  CHECK_THROWS(EvaluationTrace(filename, Mode::REPLAY),
+               "is corrupted at byte " + std::to_string(first_record));
+  std::remove(filename.c_str());
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " TEST_DIRECTORY\n";
+    return EXIT_FAILURE;
+  }
+  test_hash();
+  test_record_replay();
+  test_partial_last_record();
+  test_corrupted_files();
+  return EXIT_SUCCESS;
+}
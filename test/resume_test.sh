@@ -0,0 +1,78 @@
+#!/bin/bash
+# Checkpoints and --resume: -12 writes a checkpoint for each algorithm; a
+# resumed run repeats no OPT_IC/dagSim evaluation of the saved states; a run
+# interrupted (SIGINT) in the middle of FineGrain is completed by --resume with
+# the result of an uninterrupted run; the checkpoint of another deadline is
+# rejected.
+# OPT_IC and dagSim are replaced by the stubs of test/stubs.
+#
+# Usage: resume_test.sh OPT_DEADLINE_BINARY
+
+source "$(dirname "$0")/test_common.sh" "$@"
+
+run() {
+  local log=$1
+  shift
+  "$OPT_DEADLINE" "$PROCESS_FILE" config.txt "$@" > "$log" 2>&1
+}
+
+# Complete run, with a checkpoint for each algorithm
+run complete.log 4000000 -12 --checkpoint ck ||
+  { cat complete.log; fail "complete run"; }
+for algorithm in Algorithm1 Algorithm2; do
+  [ -f "ck.$algorithm" ] || fail "no checkpoint 'ck.$algorithm'"
+  grep -q "^algorithm $algorithm$" "ck.$algorithm" ||
+    fail "'ck.$algorithm' is not stamped with its algorithm"
+done
+
+# Resumed from the final states: nothing is evaluated again
+run resumed.log 4000000 -12 --checkpoint ck --resume ||
+  { cat resumed.log; fail "resumed run"; }
+[ "$(external_calls_of resumed.log OPT_IC)" = 0 ] ||
+  fail "OPT_IC invoked by the resumed run"
+[ "$(external_calls_of resumed.log dagSim)" = 0 ] ||
+  fail "dagSim invoked by the resumed run"
+[ "$(grep -c "Resuming from checkpoint" resumed.log)" = 2 ] ||
+  fail "the algorithms have not resumed their checkpoints"
+
+# Another total deadline cannot resume the checkpoints
+run mismatch.log 5000000 -12 --checkpoint ck --resume &&
+  fail "checkpoint of another deadline resumed"
+grep -q "cannot be resumed" mismatch.log ||
+  fail "no error for the checkpoint of another deadline"
+
+# Interrupted by SIGINT during the simulations of FineGrain
+rm -f ck.*
+export STUB_CALLS="$WORK_DIR/calls.txt" DAGSIM_SLEEP=0.2
+"$OPT_DEADLINE" "$PROCESS_FILE" config.txt 4000000 -1 --checkpoint ck \
+  > interrupted.log 2>&1 &
+run_pid=$!
+BACKGROUND_PIDS+=($run_pid)
+for attempt in $(seq 600); do
+  [ "$(grep -c dagsim "$STUB_CALLS" 2> /dev/null)" -ge 3 ] && break
+  sleep 0.05
+done
+kill -INT "$run_pid"
+wait "$run_pid"
+[ -f ck.Algorithm1 ] || fail "no checkpoint of the interrupted run"
+interrupted_calls=$(grep -c . "$STUB_CALLS")
+
+run completed.log 4000000 -1 --checkpoint ck --resume ||
+  { cat completed.log; fail "run resumed after the interruption"; }
+resumed_calls=$(($(grep -c . "$STUB_CALLS") - interrupted_calls))
+
+# The reference of -1 alone
+unset STUB_CALLS DAGSIM_SLEEP
+run reference.log 4000000 -1 || fail "reference run of -1"
+[ "$(objective_of completed.log)" = "$(objective_of reference.log)" ] ||
+  fail "objective function $(objective_of completed.log) after the" \
+    "interruption, $(objective_of reference.log) without"
+reference_calls=$(($(external_calls_of reference.log OPT_IC) +
+                   $(external_calls_of reference.log dagSim)))
+# Each evaluation has been done once, before or after the interruption
+[ $((interrupted_calls + resumed_calls)) -eq "$reference_calls" ] ||
+  fail "$interrupted_calls evaluations before the interruption and" \
+    "$resumed_calls after it, $reference_calls without interruptions"
+
+echo "Resumed after $interrupted_calls evaluations with $resumed_calls of" \
+  "$reference_calls; objective function $(objective_of completed.log)"
@@ -0,0 +1,9 @@
+#!/bin/bash
+# dagSim stub for the tests: execution time 2e9 / cores (with its confidence
+# interval). It takes DAGSIM_SLEEP seconds; each call appends a line to
+# $STUB_CALLS, if set.
+[ -n "$STUB_CALLS" ] && echo "dagsim" >> "$STUB_CALLS"
+nodes=$(grep -o 'Nodes = [0-9]*' "$1" | awk '{print $3}')
+sleep "${DAGSIM_SLEEP:-0}"
+awk -v n="$nodes" 'BEGIN {
+  t = 2e9 / n; printf "0 1000 %.3f %.3f %.3f\n", t, t * 0.99, t * 1.01 }'
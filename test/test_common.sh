@@ -0,0 +1,52 @@
+# Common part of the test scripts (sourced): a temporary working directory
+# with the configuration file 'config.txt' which runs the stubs of OPT_IC and
+# dagSim (test/stubs) on the applications of test/app_files.
+#
+# Usage: source test_common.sh OPT_DEADLINE_BINARY
+
+if [ $# -ne 1 ]; then
+  echo "Usage: $0 OPT_DEADLINE_BINARY" >&2
+  exit 2
+fi
+
+OPT_DEADLINE=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+TEST_DIR=$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)
+WORK_DIR=$(mktemp -d)
+PROCESS_FILE="$TEST_DIR/4apps/process.txt"
+BACKGROUND_PIDS=()
+
+cleanup() {
+  for pid in "${BACKGROUND_PIDS[@]}"; do
+    kill "$pid" 2> /dev/null
+  done
+  wait 2> /dev/null
+  [ -n "$KEEP_WORK_DIR" ] || rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "FAILED: $1" >&2
+  exit 1
+}
+
+# The objective function of the last solution in the log file $1
+objective_of() {
+  grep -a "Global Objective Function" "$1" | tail -1 |
+    sed 's/.*Global Objective Function: \([^;]*\);.*/\1/'
+}
+
+# The number of invocations of the external call $2 (OPT_IC or dagSim) in
+# the run statistics of the log file $1
+external_calls_of() {
+  grep -a "^$2 " "$1" | awk '{print $2}'
+}
+
+mkdir -p "$WORK_DIR/tmp"
+cat > "$WORK_DIR/config.txt" << CONFIG
+$TEST_DIR/app_files
+$TEST_DIR/stubs/dagsim
+$TEST_DIR/app_files
+$TEST_DIR/stubs/opt_ic
+$WORK_DIR/tmp
+CONFIG
+cd "$WORK_DIR" || fail "cannot enter '$WORK_DIR'"
@@ -0,0 +1,74 @@
+#!/bin/bash
+# Remote workers: the jobs of a run are spread across three workers on
+# localhost; one of them is killed while it runs a dagSim job, which must be
+# re-queued on the others without changing the result.
+# OPT_IC and dagSim are replaced by the stubs of test/stubs.
+#
+# Usage: workers_test.sh OPT_DEADLINE_BINARY
+
+source "$(dirname "$0")/test_common.sh" "$@"
+
+# Reference result, without workers
+"$OPT_DEADLINE" "$PROCESS_FILE" config.txt 4000000 -2 > local.log 2>&1 ||
+  { cat local.log; fail "local run"; }
+expected=$(objective_of local.log)
+[ -n "$expected" ] || fail "no objective function in the local run"
+
+# Three workers
+export OPT_IC_SLEEP=0.2 DAGSIM_SLEEP=1
+WORKERS=""
+for k in 1 2 3; do
+  "$OPT_DEADLINE" --worker "unix:$WORK_DIR/worker$k.sock" config.txt \
+    > "worker$k.log" 2>&1 &
+  BACKGROUND_PIDS+=($!)
+  WORKERS="$WORKERS${WORKERS:+,}unix:$WORK_DIR/worker$k.sock"
+done
+for k in 1 2 3; do
+  for attempt in $(seq 100); do
+    grep -q "Listening" "worker$k.log" && break
+    sleep 0.05
+  done
+  grep -q "Listening" "worker$k.log" || fail "worker $k did not start"
+done
+
+"$OPT_DEADLINE" "$PROCESS_FILE" config.txt 4000000 -2 --workers "$WORKERS" \
+  > workers.log 2>&1 &
+run_pid=$!
+
+# Kill the first worker which receives a dagSim job, while it runs it
+killed=""
+for attempt in $(seq 600); do
+  for k in 1 2 3; do
+    if grep -q "Job DAGSIM" "worker$k.log"; then
+      kill -9 "${BACKGROUND_PIDS[$((k - 1))]}"
+      wait "${BACKGROUND_PIDS[$((k - 1))]}" 2> /dev/null
+      killed=$k
+      break 2
+    fi
+  done
+  sleep 0.05
+done
+[ -n "$killed" ] || fail "no dagSim job reached the workers"
+
+wait "$run_pid" || { cat workers.log; fail "run with workers"; }
+
+# The jobs have been spread across the workers
+busy_workers=0
+for k in 1 2 3; do
+  grep -q "Worker > Job" "worker$k.log" && busy_workers=$((busy_workers + 1))
+done
+[ "$busy_workers" -ge 2 ] || fail "the jobs ran on $busy_workers worker(s)"
+
+# The job of the killed worker has been re-queued
+grep -q "Re-queueing the DAGSIM job" workers.log ||
+  fail "the job of the killed worker $killed has not been re-queued"
+requeued=$(grep -a "WorkerRequeuedJobs" workers.log | awk '{print $NF}')
+[ "${requeued:-0}" -ge 1 ] ||
+  fail "WorkerRequeuedJobs is '${requeued}' in the statistics"
+
+actual=$(objective_of workers.log)
+[ "$actual" = "$expected" ] ||
+  fail "objective function $actual with the workers, $expected without"
+
+echo "Worker $killed killed; $requeued job(s) re-queued; objective function" \
+  "$actual on $busy_workers workers"